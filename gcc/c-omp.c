@@ -81,6 +81,21 @@ c_finish_omp_barrier (void)
 }
 
 
+/* APPLE LOCAL begin libgomp tasks */
+/* Complete a #pragma omp taskwait construct.  */
+
+void
+c_finish_omp_taskwait (void)
+{
+  tree x;
+
+  x = built_in_decls[BUILT_IN_GOMP_TASKWAIT];
+  x = build_function_call_expr (x, NULL);
+  add_stmt (x);
+}
+/* APPLE LOCAL end libgomp tasks */
+
+
 /* Complete a #pragma omp atomic construct.  The expression to be 
    implemented atomically is LHS code= RHS.  The value returned is
    either error_mark_node (if the construct was erroneous) or an
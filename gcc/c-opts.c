@@ -863,6 +863,18 @@ c_common_handle_option (size_t scode, const char *arg, int value)
       cpp_opts->input_charset = arg;
       break;
 
+      /* APPLE LOCAL begin header cache */
+    case OPT_fheader_cache_:
+      cpp_opts->header_cache = arg;
+      break;
+      /* APPLE LOCAL end header cache */
+
+      /* APPLE LOCAL begin include guard identity */
+    case OPT_fcpp_stats:
+      cpp_opts->print_include_stats = value;
+      break;
+      /* APPLE LOCAL end include guard identity */
+
     case OPT_ftemplate_depth_:
       max_tinst_depth = value;
       break;
@@ -67,7 +67,7 @@ struct c_pch_validity
 {
   unsigned char debug_info_type;
   signed char match[MATCH_SIZE];
-  void (*pch_init) (void);
+  /* APPLE LOCAL relocatable PCH */
   size_t target_data_length;
 };
 
@@ -145,7 +145,6 @@ pch_init (void)
 	gcc_assert (v.match[i] == *pch_matching[i].flag_var);
       }
   }
-  v.pch_init = &pch_init;
   target_validity = targetm.get_pch_validity (&v.target_data_length);
 
   if (fwrite (partial_pch, IDENT_LENGTH, 1, f) != 1
@@ -312,19 +311,11 @@ c_common_valid_pch (cpp_reader *pfile, const char *name, int fd)
 	}
   }
 
-  /* If the text segment was not loaded at the same address as it was
-     when the PCH file was created, function pointers loaded from the
-     PCH will not be valid.  We could in theory remap all the function
-     pointers, but no support for that exists at present.
-     Since we have the same executable, it should only be necessary to
-     check one function.  */
-  if (v.pch_init != &pch_init)
-    {
-      if (cpp_get_options (pfile)->warn_invalid_pch)
-	cpp_error (pfile, CPP_DL_WARNING,
-		   "%s: had text segment at different address", name);
-      return 2;
-    }
+  /* APPLE LOCAL begin relocatable PCH */
+  /* It doesn't matter if the text segment was not loaded at the same
+     address as it was when the PCH file was created; gt_pch_restore
+     adjusts the function pointers in the PCH.  */
+  /* APPLE LOCAL end relocatable PCH */
 
   /* Check the target-specific validity data.  */
   {
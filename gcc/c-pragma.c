@@ -802,6 +802,10 @@ init_pragma (void)
 	{ "section", PRAGMA_OMP_SECTION },
 	{ "sections", PRAGMA_OMP_SECTIONS },
 	{ "single", PRAGMA_OMP_SINGLE },
+	/* APPLE LOCAL begin libgomp tasks */
+	{ "task", PRAGMA_OMP_TASK },
+	{ "taskwait", PRAGMA_OMP_TASKWAIT },
+	/* APPLE LOCAL end libgomp tasks */
 	{ "threadprivate", PRAGMA_OMP_THREADPRIVATE }
       };
 
@@ -42,6 +42,10 @@ typedef enum pragma_kind {
   PRAGMA_OMP_SECTION,
   PRAGMA_OMP_SECTIONS,
   PRAGMA_OMP_SINGLE,
+  /* APPLE LOCAL begin libgomp tasks */
+  PRAGMA_OMP_TASK,
+  PRAGMA_OMP_TASKWAIT,
+  /* APPLE LOCAL end libgomp tasks */
   PRAGMA_OMP_THREADPRIVATE,
 
   PRAGMA_GCC_PCH_PREPROCESS,
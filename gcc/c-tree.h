@@ -610,6 +610,10 @@ extern void c_end_vm_scope (unsigned int);
 extern tree c_expr_to_decl (tree, bool *, bool *, bool *);
 extern tree c_begin_omp_parallel (void);
 extern tree c_finish_omp_parallel (tree, tree);
+/* APPLE LOCAL begin libgomp tasks */
+extern tree c_begin_omp_task (void);
+extern tree c_finish_omp_task (tree, tree);
+/* APPLE LOCAL end libgomp tasks */
 extern tree c_finish_omp_clauses (tree);
 
 /* APPLE LOCAL begin CW asm blocks */
@@ -4239,6 +4239,10 @@ extern tree template_for_substitution		(tree);
 extern tree build_non_dependent_expr		(tree);
 extern tree build_non_dependent_args		(tree);
 extern bool reregister_specialization		(tree, tree, tree);
+/* APPLE LOCAL begin specialization hash */
+extern void reindex_specializations		(tree, tree, tree);
+extern void print_template_statistics		(void);
+/* APPLE LOCAL end specialization hash */
 extern tree fold_non_dependent_expr		(tree);
 extern bool explicit_class_specialization_p     (tree);
 /* APPLE LOCAL mainline radar 6194879 */
@@ -4437,6 +4441,11 @@ extern tree begin_omp_structured_block		(void);
 extern tree finish_omp_structured_block		(tree);
 extern tree begin_omp_parallel			(void);
 extern tree finish_omp_parallel			(tree, tree);
+/* APPLE LOCAL begin libgomp tasks */
+extern tree begin_omp_task			(void);
+extern tree finish_omp_task			(tree, tree);
+extern void finish_omp_taskwait			(void);
+/* APPLE LOCAL end libgomp tasks */
 extern tree finish_omp_for			(location_t, tree, tree,
 						 tree, tree, tree, tree);
 extern void finish_omp_atomic			(enum tree_code, tree, tree);
@@ -1642,6 +1642,9 @@ duplicate_decls (tree newdecl, tree olddecl, bool newdecl_is_friend)
       old_result = DECL_TEMPLATE_RESULT (olddecl);
       new_result = DECL_TEMPLATE_RESULT (newdecl);
       TREE_TYPE (olddecl) = TREE_TYPE (old_result);
+      /* APPLE LOCAL specialization hash */
+      reindex_specializations (newdecl, olddecl,
+			       DECL_TEMPLATE_SPECIALIZATIONS (newdecl));
       DECL_TEMPLATE_SPECIALIZATIONS (olddecl)
 	= chainon (DECL_TEMPLATE_SPECIALIZATIONS (olddecl),
 		   DECL_TEMPLATE_SPECIALIZATIONS (newdecl));
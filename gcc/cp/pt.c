@@ -80,6 +80,33 @@ static tree cur_stmt_expr;
    local variables.  */
 static htab_t local_specializations;
 
+/* APPLE LOCAL begin specialization hash */
+/* An entry in one of the specialization hash tables.  SPEC is the
+   TREE_LIST node recording the specialization on one of TMPL's
+   specialization lists; ARGS is its TREE_PURPOSE.  Pointing at the
+   list node rather than at the specialization itself means that
+   reregister_specialization need not touch the tables.  */
+
+struct spec_entry GTY(())
+{
+  unsigned int hash;
+  tree tmpl;
+  tree args;
+  tree spec;
+};
+
+/* Indexes of the DECL_TEMPLATE_SPECIALIZATIONS lists of function and
+   variable templates, and of the DECL_TEMPLATE_INSTANTIATIONS lists of
+   class templates, keyed on the template and its arguments.  The lists
+   themselves are still maintained; these tables just save
+   retrieve_specialization from walking them.  The
+   DECL_TEMPLATE_SPECIALIZATIONS lists of class templates hold only
+   the partial specializations and are not indexed.  */
+
+static GTY ((param_is (struct spec_entry))) htab_t decl_specializations;
+static GTY ((param_is (struct spec_entry))) htab_t type_specializations;
+/* APPLE LOCAL end specialization hash */
+
 #define UNIFY_ALLOW_NONE 0
 #define UNIFY_ALLOW_MORE_CV_QUAL 1
 #define UNIFY_ALLOW_LESS_CV_QUAL 2
@@ -157,6 +184,14 @@ static tree copy_default_args_to_explicit_spec_1 (tree, tree);
 static void copy_default_args_to_explicit_spec (tree);
 static int invalid_nontype_parm_type_p (tree, tsubst_flags_t);
 static int eq_local_specializations (const void *, const void *);
+/* APPLE LOCAL begin specialization hash */
+static hashval_t iterative_hash_template_arg (tree, hashval_t, bool *);
+static hashval_t hash_specialization_args (tree, tree);
+static hashval_t hash_specialization (const void *);
+static int eq_specializations (const void *, const void *);
+static htab_t *specialization_table (tree, bool);
+static void index_specialization (tree, tree, bool);
+/* APPLE LOCAL end specialization hash */
 static bool dependent_type_p_r (tree);
 static tree tsubst (tree, tree, tsubst_flags_t, tree);
 static tree tsubst_expr	(tree, tree, tsubst_flags_t, tree, bool);
@@ -821,6 +856,241 @@ optimize_specialization_lookup_p (tree tmpl)
 	  && !DECL_FRIEND_P (DECL_TEMPLATE_RESULT (tmpl)));
 }
 
+/* APPLE LOCAL begin specialization hash */
+/* Combine into VAL a hash of the template argument ARG, which may be a
+   type, an expression, or a TREE_VEC of arguments.  Arguments that
+   template_args_equal considers equal must hash equally, so only
+   properties that comptypes and cp_tree_equal respect are used, and
+   everything is keyed on UIDs rather than addresses.  Set
+   *DEPENDENT_P if ARG involves template parameters.  */
+
+static hashval_t
+iterative_hash_template_arg (tree arg, hashval_t val, bool *dependent_p)
+{
+  enum tree_code code;
+
+  if (arg == NULL_TREE)
+    return val;
+
+  if (TREE_CODE (arg) == TREE_VEC)
+    {
+      int i;
+
+      for (i = 0; i < TREE_VEC_LENGTH (arg); ++i)
+	val = iterative_hash_template_arg (TREE_VEC_ELT (arg, i), val,
+					   dependent_p);
+      return val;
+    }
+
+  if (TYPE_P (arg))
+    {
+      /* Apply the same canonicalizations as comptypes.  */
+      if (TREE_CODE (arg) == INTEGER_TYPE && TYPE_IS_SIZETYPE (arg)
+	  && TYPE_ORIG_SIZE_TYPE (arg))
+	arg = TYPE_ORIG_SIZE_TYPE (arg);
+      if (TYPE_PTRMEMFUNC_P (arg))
+	arg = TYPE_PTRMEMFUNC_FN_TYPE (arg);
+
+      code = TREE_CODE (arg);
+      val = iterative_hash_object (code, val);
+      if (code != ARRAY_TYPE)
+	{
+	  int quals = TYPE_QUALS (arg);
+	  val = iterative_hash_object (quals, val);
+	}
+
+      switch (code)
+	{
+	case TEMPLATE_TYPE_PARM:
+	case TEMPLATE_TEMPLATE_PARM:
+	case BOUND_TEMPLATE_TEMPLATE_PARM:
+	case TYPENAME_TYPE:
+	case UNBOUND_CLASS_TEMPLATE:
+	case TYPEOF_TYPE:
+	  *dependent_p = true;
+	  return val;
+
+	case RECORD_TYPE:
+	case UNION_TYPE:
+	  /* Distinct nodes for the same class template specialization
+	     compare equal, so use the template and its arguments.  */
+	  if (TYPE_TEMPLATE_INFO (arg))
+	    {
+	      val = iterative_hash_object (DECL_UID (TYPE_TI_TEMPLATE (arg)),
+					   val);
+	      return iterative_hash_template_arg (TYPE_TI_ARGS (arg), val,
+						  dependent_p);
+	    }
+	  break;
+
+	case POINTER_TYPE:
+	case REFERENCE_TYPE:
+	case OFFSET_TYPE:
+	case ARRAY_TYPE:
+	case FUNCTION_TYPE:
+	case METHOD_TYPE:
+	case COMPLEX_TYPE:
+	case VECTOR_TYPE:
+	  return iterative_hash_template_arg (TREE_TYPE (arg), val,
+					      dependent_p);
+
+	case BLOCK_POINTER_TYPE:
+	  /* comptypes ignores qualifiers on the return type here.  */
+	  return val;
+
+	default:
+	  break;
+	}
+
+      /* Otherwise only the main variant compares equal.  */
+      return iterative_hash_object (TYPE_UID (TYPE_MAIN_VARIANT (arg)), val);
+    }
+
+  /* A non-type argument.  Strip conversions as cp_tree_equal does.  */
+  while (TREE_CODE (arg) == NOP_EXPR
+	 || TREE_CODE (arg) == CONVERT_EXPR
+	 || TREE_CODE (arg) == NON_LVALUE_EXPR)
+    arg = TREE_OPERAND (arg, 0);
+
+  code = TREE_CODE (arg);
+  val = iterative_hash_object (code, val);
+  switch (code)
+    {
+    case INTEGER_CST:
+      val = iterative_hash_object (TREE_INT_CST_LOW (arg), val);
+      return iterative_hash_object (TREE_INT_CST_HIGH (arg), val);
+
+    case VAR_DECL:
+    case PARM_DECL:
+    case CONST_DECL:
+    case FUNCTION_DECL:
+    case TEMPLATE_DECL:
+      return iterative_hash_object (DECL_UID (arg), val);
+
+    case PTRMEM_CST:
+      return iterative_hash_object (DECL_UID (PTRMEM_CST_MEMBER (arg)), val);
+
+    case TEMPLATE_PARM_INDEX:
+      *dependent_p = true;
+      return val;
+
+    default:
+      return val;
+    }
+}
+
+/* Return the hash value for the specialization of TMPL with ARGS.
+   A TYPENAME_TYPE can compare equal to the type it names, which may
+   be of an entirely different form, so when ARGS are dependent only
+   the template contributes to the hash.  */
+
+static hashval_t
+hash_specialization_args (tree tmpl, tree args)
+{
+  hashval_t val = DECL_UID (tmpl);
+  bool dependent_p = false;
+  hashval_t args_val;
+
+  args_val = iterative_hash_template_arg (args, val, &dependent_p);
+  return dependent_p ? val : args_val;
+}
+
+/* Hash P, a struct spec_entry.  */
+
+static hashval_t
+hash_specialization (const void *p)
+{
+  return ((const struct spec_entry *) p)->hash;
+}
+
+/* Return nonzero if the spec_entry P1 and the lookup key P2 name the
+   same specialization.  */
+
+static int
+eq_specializations (const void *p1, const void *p2)
+{
+  const struct spec_entry *e1 = (const struct spec_entry *) p1;
+  const struct spec_entry *e2 = (const struct spec_entry *) p2;
+
+  return (e1->tmpl == e2->tmpl
+	  && comp_template_args (e1->args, e2->args));
+}
+
+/* Return the hash table indexing TMPL's DECL_TEMPLATE_INSTANTIATIONS
+   list, if INSTANTIATIONS_P, or its DECL_TEMPLATE_SPECIALIZATIONS list
+   otherwise.  Returns NULL if that list is not indexed.  The table
+   itself is created on first use.  */
+
+static htab_t *
+specialization_table (tree tmpl, bool instantiations_p)
+{
+  bool class_p = TREE_CODE (DECL_TEMPLATE_RESULT (tmpl)) == TYPE_DECL;
+
+  if (class_p != instantiations_p)
+    return NULL;
+  return class_p ? &type_specializations : &decl_specializations;
+}
+
+/* SPEC, a TREE_LIST node, has just been added to one of TMPL's
+   specialization lists, as indicated by INSTANTIATIONS_P.  Enter it in
+   the corresponding hash table, unless an equal specialization is
+   already there; the list walk would have found that one first.  */
+
+static void
+index_specialization (tree tmpl, tree spec, bool instantiations_p)
+{
+  htab_t *table = specialization_table (tmpl, instantiations_p);
+  struct spec_entry elt;
+  void **slot;
+
+  if (!table)
+    return;
+  if (!*table)
+    *table = htab_create_ggc (37, hash_specialization, eq_specializations,
+			      NULL);
+
+  elt.tmpl = tmpl;
+  elt.args = TREE_PURPOSE (spec);
+  elt.spec = spec;
+  elt.hash = hash_specialization_args (tmpl, elt.args);
+  slot = htab_find_slot_with_hash (*table, &elt, elt.hash, INSERT);
+  if (!*slot)
+    {
+      struct spec_entry *entry = GGC_NEW (struct spec_entry);
+      *entry = elt;
+      *slot = entry;
+    }
+}
+
+/* The DECL_TEMPLATE_SPECIALIZATIONS of FROM, starting with LIST, have
+   just been spliced onto the DECL_TEMPLATE_SPECIALIZATIONS of TO.
+   Move their hash table entries accordingly.  */
+
+void
+reindex_specializations (tree from, tree to, tree list)
+{
+  htab_t *table = specialization_table (from, false);
+
+  if (!table || !*table)
+    return;
+
+  for (; list; list = TREE_CHAIN (list))
+    {
+      struct spec_entry elt;
+      void **slot;
+
+      elt.tmpl = from;
+      elt.args = TREE_PURPOSE (list);
+      elt.spec = list;
+      elt.hash = hash_specialization_args (from, elt.args);
+      slot = htab_find_slot_with_hash (*table, &elt, elt.hash, NO_INSERT);
+      if (slot && ((struct spec_entry *) *slot)->spec == list)
+	htab_clear_slot (*table, slot);
+      index_specialization (to, list, false);
+    }
+}
+/* APPLE LOCAL end specialization hash */
+
 /* Retrieve the specialization (in the sense of [temp.spec] - a
    specialization is either an instantiation or an explicit
    specialization) of TMPL for the given template ARGS.  If there is
@@ -883,15 +1153,42 @@ retrieve_specialization (tree tmpl, tree args,
     {
       tree *sp;
       tree *head;
+      /* APPLE LOCAL begin specialization hash */
+      bool instantiations_p;
+      htab_t *table;
 
       /* Class templates store their instantiations on the
 	 DECL_TEMPLATE_INSTANTIATIONS list; other templates use the
 	 DECL_TEMPLATE_SPECIALIZATIONS list.  */
-      if (!class_specializations_p
-	  && TREE_CODE (DECL_TEMPLATE_RESULT (tmpl)) == TYPE_DECL)
+      instantiations_p
+	= (!class_specializations_p
+	   && TREE_CODE (DECL_TEMPLATE_RESULT (tmpl)) == TYPE_DECL);
+
+      /* Both of those lists are indexed by a hash table, except for
+	 the list of partial specializations of a class template.  */
+      table = specialization_table (tmpl, instantiations_p);
+      if (table)
+	{
+	  struct spec_entry elt;
+	  struct spec_entry *found;
+
+	  if (!*table)
+	    return NULL_TREE;
+
+	  elt.tmpl = tmpl;
+	  elt.args = args;
+	  elt.spec = NULL_TREE;
+	  elt.hash = hash_specialization_args (tmpl, args);
+	  found = (struct spec_entry *) htab_find_with_hash (*table, &elt,
+							     elt.hash);
+	  return found ? TREE_VALUE (found->spec) : NULL_TREE;
+	}
+
+      if (instantiations_p)
 	sp = &DECL_TEMPLATE_INSTANTIATIONS (tmpl);
       else
 	sp = &DECL_TEMPLATE_SPECIALIZATIONS (tmpl);
+      /* APPLE LOCAL end specialization hash */
       head = sp;
       /* Iterate through the list until we find a matching template.  */
       while (*sp != NULL_TREE)
@@ -1255,8 +1552,12 @@ register_specialization (tree spec, tree tmpl, tree args, bool is_friend)
     DECL_CONTEXT (spec) = FROB_CONTEXT (decl_namespace_context (tmpl));
 
   if (!optimize_specialization_lookup_p (tmpl))
-    DECL_TEMPLATE_SPECIALIZATIONS (tmpl)
-      = tree_cons (args, spec, DECL_TEMPLATE_SPECIALIZATIONS (tmpl));
+    {
+      DECL_TEMPLATE_SPECIALIZATIONS (tmpl)
+	= tree_cons (args, spec, DECL_TEMPLATE_SPECIALIZATIONS (tmpl));
+      /* APPLE LOCAL specialization hash */
+      index_specialization (tmpl, DECL_TEMPLATE_SPECIALIZATIONS (tmpl), false);
+    }
 
   return spec;
 }
@@ -1276,7 +1577,40 @@ reregister_specialization (tree spec, tree tmpl, tree new_spec)
     if (TREE_VALUE (*s) == spec)
       {
 	if (!new_spec)
-	  *s = TREE_CHAIN (*s);
+	  {
+	    /* APPLE LOCAL begin specialization hash */
+	    tree old = *s;
+	    htab_t *table = specialization_table (tmpl, false);
+
+	    *s = TREE_CHAIN (*s);
+	    if (table && *table)
+	      {
+		struct spec_entry elt;
+		void **slot;
+		tree t;
+
+		/* If the hash table pointed at the node we just removed,
+		   make it point at the next equal one, if any.  */
+		elt.tmpl = tmpl;
+		elt.args = TREE_PURPOSE (old);
+		elt.spec = old;
+		elt.hash = hash_specialization_args (tmpl, elt.args);
+		slot = htab_find_slot_with_hash (*table, &elt, elt.hash,
+						 NO_INSERT);
+		if (slot && ((struct spec_entry *) *slot)->spec == old)
+		  {
+		    htab_clear_slot (*table, slot);
+		    for (t = DECL_TEMPLATE_SPECIALIZATIONS (tmpl); t;
+			 t = TREE_CHAIN (t))
+		      if (comp_template_args (TREE_PURPOSE (t), elt.args))
+			{
+			  index_specialization (tmpl, t, false);
+			  break;
+			}
+		  }
+	      }
+	    /* APPLE LOCAL end specialization hash */
+	  }
 	else
 	  TREE_VALUE (*s) = new_spec;
 	return 1;
@@ -4905,6 +5239,9 @@ lookup_template_class (tree d1,
       DECL_TEMPLATE_INSTANTIATIONS (template)
 	= tree_cons (arglist, t,
 		     DECL_TEMPLATE_INSTANTIATIONS (template));
+      /* APPLE LOCAL specialization hash */
+      index_specialization (template, DECL_TEMPLATE_INSTANTIATIONS (template),
+			    true);
 
       if (TREE_CODE (t) == ENUMERAL_TYPE
 	  && !is_partial_instantiation)
@@ -5501,6 +5838,10 @@ tsubst_friend_function (tree decl, tree args)
 		  t = most_general_template (old_decl);
 		  if (t != old_decl)
 		    {
+		      /* APPLE LOCAL begin specialization hash */
+		      reindex_specializations
+			(old_decl, t, DECL_TEMPLATE_SPECIALIZATIONS (old_decl));
+		      /* APPLE LOCAL end specialization hash */
 		      DECL_TEMPLATE_SPECIALIZATIONS (t)
 			= chainon (DECL_TEMPLATE_SPECIALIZATIONS (t),
 				   DECL_TEMPLATE_SPECIALIZATIONS (old_decl));
@@ -8448,6 +8789,8 @@ tsubst_omp_clauses (tree clauses, tree args, tsubst_flags_t complain,
 	case OMP_CLAUSE_NOWAIT:
 	case OMP_CLAUSE_ORDERED:
 	case OMP_CLAUSE_DEFAULT:
+	/* APPLE LOCAL libgomp tasks */
+	case OMP_CLAUSE_UNTIED:
 	  break;
 	default:
 	  gcc_unreachable ();
@@ -8816,6 +9159,16 @@ tsubst_expr (tree t, tree args, tsubst_flags_t complain, tree in_decl,
 	= OMP_PARALLEL_COMBINED (t);
       break;
 
+      /* APPLE LOCAL begin libgomp tasks */
+    case OMP_TASK:
+      tmp = tsubst_omp_clauses (OMP_TASK_CLAUSES (t),
+				args, complain, in_decl);
+      stmt = begin_omp_task ();
+      RECUR (OMP_TASK_BODY (t));
+      finish_omp_task (tmp, stmt);
+      break;
+      /* APPLE LOCAL end libgomp tasks */
+
     case OMP_FOR:
       {
 	tree clauses, decl, init, cond, incr, body, pre_body;
@@ -13456,4 +13809,30 @@ build_non_dependent_args (tree args)
   return nreverse (new_args);
 }
 
+/* APPLE LOCAL begin specialization hash */
+/* Print out the statistics for the specialization hash tables,
+   including how many times each was searched.  Lookups are counted
+   rather than timed, since timing each one would cost more than the
+   lookup itself.  */
+
+void
+print_template_statistics (void)
+{
+  if (decl_specializations)
+    fprintf (stderr, "decl_specializations: size %ld, %ld elements, "
+	     "%ld searches, %f collisions\n",
+	     (long) htab_size (decl_specializations),
+	     (long) htab_elements (decl_specializations),
+	     (long) decl_specializations->searches,
+	     htab_collisions (decl_specializations));
+  if (type_specializations)
+    fprintf (stderr, "type_specializations: size %ld, %ld elements, "
+	     "%ld searches, %f collisions\n",
+	     (long) htab_size (type_specializations),
+	     (long) htab_elements (type_specializations),
+	     (long) type_specializations->searches,
+	     htab_collisions (type_specializations));
+}
+/* APPLE LOCAL end specialization hash */
+
 #include "gt-cp-pt.h"
@@ -3605,6 +3605,8 @@ finish_omp_clauses (tree clauses)
 	case OMP_CLAUSE_NOWAIT:
 	case OMP_CLAUSE_ORDERED:
 	case OMP_CLAUSE_DEFAULT:
+	/* APPLE LOCAL libgomp tasks */
+	case OMP_CLAUSE_UNTIED:
 	  break;
 
 	default:
@@ -3934,6 +3936,30 @@ finish_omp_parallel (tree clauses, tree body)
   return add_stmt (stmt);
 }
 
+/* APPLE LOCAL begin libgomp tasks */
+tree
+begin_omp_task (void)
+{
+  keep_next_level (true);
+  return begin_omp_structured_block ();
+}
+
+tree
+finish_omp_task (tree clauses, tree body)
+{
+  tree stmt;
+
+  body = finish_omp_structured_block (body);
+
+  stmt = make_node (OMP_TASK);
+  TREE_TYPE (stmt) = void_type_node;
+  OMP_TASK_CLAUSES (stmt) = clauses;
+  OMP_TASK_BODY (stmt) = body;
+
+  return add_stmt (stmt);
+}
+/* APPLE LOCAL end libgomp tasks */
+
 /* Build and validate an OMP_FOR statement.  CLAUSES, BODY, COND, INCR
    are directly for their associated operands in the statement.  DECL
    and INIT are a combo; if DECL is NULL then INIT ought to be a
@@ -4074,6 +4100,16 @@ finish_omp_barrier (void)
   finish_expr_stmt (stmt);
 }
 
+/* APPLE LOCAL begin libgomp tasks */
+void
+finish_omp_taskwait (void)
+{
+  tree fn = built_in_decls[BUILT_IN_GOMP_TASKWAIT];
+  tree stmt = finish_call_expr (fn, NULL, false, false);
+  finish_expr_stmt (stmt);
+}
+/* APPLE LOCAL end libgomp tasks */
+
 void
 finish_omp_flush (void)
 {
@@ -1148,6 +1148,8 @@ cxx_print_statistics (void)
 {
   print_search_statistics ();
   print_class_statistics ();
+  /* APPLE LOCAL specialization hash */
+  print_template_statistics ();
 #ifdef GATHER_STATISTICS
   fprintf (stderr, "maximum template instantiation depth reached: %d\n",
 	   depth_reached);
@@ -41,6 +41,113 @@ Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA
 #endif
 
 
+/* APPLE LOCAL begin compact dwarf */
+/* Under -fcompact-dwarf, the constant data output between
+   dw2_asm_begin_block and dw2_asm_end_block is collected here in target
+   byte order, and written as .ascii directives; the assembler then
+   reads a few long lines instead of a directive for every value.
+   Anything that needs a relocation writes out the block first.  */
+
+static bool block_active;
+static unsigned char *block_buf;
+static size_t block_len;
+static size_t block_alloc;
+
+/* The number of bytes of the block written per .ascii directive.  */
+#define BLOCK_LINE_BYTES 64
+
+/* Add LEN bytes at P to the block.  */
+
+static void
+block_append (const void *p, size_t len)
+{
+  if (block_len + len > block_alloc)
+    {
+      block_alloc = MAX (block_len + len, 2 * block_alloc + 256);
+      block_buf = xrealloc (block_buf, block_alloc);
+    }
+  memcpy (block_buf + block_len, p, len);
+  block_len += len;
+}
+
+/* Add VALUE to the block as a SIZE-byte integer.  */
+
+static void
+block_append_int (int size, unsigned HOST_WIDE_INT value)
+{
+  unsigned char bytes[2 * HOST_BITS_PER_WIDE_INT / 8];
+  int i;
+
+  gcc_assert ((size_t) size <= sizeof (bytes));
+  for (i = 0; i < size; i++)
+    {
+      unsigned char byte = 0;
+
+      if (i < HOST_BITS_PER_WIDE_INT / 8)
+	byte = (value >> (i * 8)) & 0xff;
+      bytes[BYTES_BIG_ENDIAN ? size - 1 - i : i] = byte;
+    }
+  block_append (bytes, size);
+}
+
+/* Start collecting constant data into a block, if -fcompact-dwarf asks
+   for it.  Comments for -dA need a directive per value.  */
+
+void
+dw2_asm_begin_block (void)
+{
+  gcc_assert (!block_active);
+  block_active = (flag_compact_dwarf && !flag_debug_asm
+		  && BITS_PER_UNIT == 8
+		  && BYTES_BIG_ENDIAN == WORDS_BIG_ENDIAN);
+}
+
+/* Write out the data collected so far.  Call this before writing
+   anything else to asm_out_file inside a block.  */
+
+void
+dw2_asm_flush_block (void)
+{
+  size_t i;
+
+  for (i = 0; i < block_len; i++)
+    {
+      int c = block_buf[i];
+
+      if (i % BLOCK_LINE_BYTES == 0)
+	fputs ("\t.ascii \"", asm_out_file);
+      if (c == '\"' || c == '\\')
+	{
+	  fputc ('\\', asm_out_file);
+	  fputc (c, asm_out_file);
+	}
+      else if (ISPRINT (c))
+	fputc (c, asm_out_file);
+      else
+	{
+	  /* Always three digits, so a digit after it is not taken as
+	     part of the escape.  */
+	  fputc ('\\', asm_out_file);
+	  fputc ('0' + ((c >> 6) & 7), asm_out_file);
+	  fputc ('0' + ((c >> 3) & 7), asm_out_file);
+	  fputc ('0' + (c & 7), asm_out_file);
+	}
+      if (i % BLOCK_LINE_BYTES == BLOCK_LINE_BYTES - 1 || i == block_len - 1)
+	fputs ("\"\n", asm_out_file);
+    }
+  block_len = 0;
+}
+
+/* Write out the block and stop collecting data.  */
+
+void
+dw2_asm_end_block (void)
+{
+  dw2_asm_flush_block ();
+  block_active = false;
+}
+/* APPLE LOCAL end compact dwarf */
+
 /* Output an unaligned integer with the given value and size.  Prefer not
    to print a newline, since the caller may want to add a comment.  */
 
@@ -49,11 +156,15 @@ dw2_assemble_integer (int size, rtx x)
 {
   const char *op = integer_asm_op (size, FALSE);
 
+  /* APPLE LOCAL compact dwarf */
+  dw2_asm_flush_block ();
+
   if (op)
     {
       fputs (op, asm_out_file);
       if (GET_CODE (x) == CONST_INT)
-	fprintf (asm_out_file, HOST_WIDE_INT_PRINT_HEX, INTVAL (x));
+	/* APPLE LOCAL asm output */
+	fprint_whex (asm_out_file, INTVAL (x));
       else
 	output_addr_const (asm_out_file, x);
     }
@@ -76,8 +187,22 @@ dw2_asm_output_data (int size, unsigned HOST_WIDE_INT value,
   if (size * 8 < HOST_BITS_PER_WIDE_INT)
     value &= ~(~(unsigned HOST_WIDE_INT) 0 << (size * 8));
 
+  /* APPLE LOCAL begin compact dwarf */
+  if (block_active)
+    {
+      block_append_int (size, value);
+      va_end (ap);
+      return;
+    }
+  /* APPLE LOCAL end compact dwarf */
+
   if (op)
-    fprintf (asm_out_file, "%s" HOST_WIDE_INT_PRINT_HEX, op, value);
+    /* APPLE LOCAL begin asm output */
+    {
+      fputs (op, asm_out_file);
+      fprint_whex (asm_out_file, value);
+    }
+    /* APPLE LOCAL end asm output */
   else
     assemble_integer (GEN_INT (value), size, BITS_PER_UNIT, 1);
 
@@ -105,6 +230,9 @@ dw2_asm_output_delta (int size, const char *lab1, const char *lab2,
 
   va_start (ap, comment);
 
+  /* APPLE LOCAL compact dwarf */
+  dw2_asm_flush_block ();
+
 #ifdef ASM_OUTPUT_DWARF_DELTA
   ASM_OUTPUT_DWARF_DELTA (asm_out_file, size, lab1, lab2);
 #else
@@ -139,6 +267,9 @@ dw2_asm_output_offset (int size, const char *label,
 
   va_start (ap, comment);
 
+  /* APPLE LOCAL compact dwarf */
+  dw2_asm_flush_block ();
+
 #ifdef ASM_OUTPUT_DWARF_OFFSET
   ASM_OUTPUT_DWARF_OFFSET (asm_out_file, size, label, base);
 #else
@@ -254,6 +385,16 @@ dw2_asm_output_nstring (const char *str, size_t orig_len,
   if (len == (size_t) -1)
     len = strlen (str);
 
+  /* APPLE LOCAL begin compact dwarf */
+  if (block_active)
+    {
+      block_append (str, len);
+      block_append ("", 1);
+      va_end (ap);
+      return;
+    }
+  /* APPLE LOCAL end compact dwarf */
+
   if (flag_debug_asm && comment)
     {
       fputs ("\t.ascii \"", asm_out_file);
@@ -515,8 +656,29 @@ dw2_asm_output_data_uleb128 (unsigned HOST_WIDE_INT value,
 
   va_start (ap, comment);
 
+  /* APPLE LOCAL begin compact dwarf */
+  if (block_active)
+    {
+      do
+	{
+	  unsigned char byte = value & 0x7f;
+
+	  value >>= 7;
+	  if (value != 0)
+	    byte |= 0x80;
+	  block_append (&byte, 1);
+	}
+      while (value != 0);
+      va_end (ap);
+      return;
+    }
+  /* APPLE LOCAL end compact dwarf */
+
 #ifdef HAVE_AS_LEB128
-  fprintf (asm_out_file, "\t.uleb128 " HOST_WIDE_INT_PRINT_HEX , value);
+  /* APPLE LOCAL begin asm output */
+  fputs ("\t.uleb128 ", asm_out_file);
+  fprint_whex (asm_out_file, value);
+  /* APPLE LOCAL end asm output */
 
   if (flag_debug_asm && comment)
     {
@@ -576,8 +738,33 @@ dw2_asm_output_data_sleb128 (HOST_WIDE_INT value,
 
   va_start (ap, comment);
 
+  /* APPLE LOCAL begin compact dwarf */
+  if (block_active)
+    {
+      int more;
+
+      do
+	{
+	  unsigned char byte = value & 0x7f;
+
+	  value >>= 7;
+	  more = !((value == 0 && (byte & 0x40) == 0)
+		   || (value == -1 && (byte & 0x40) != 0));
+	  if (more)
+	    byte |= 0x80;
+	  block_append (&byte, 1);
+	}
+      while (more);
+      va_end (ap);
+      return;
+    }
+  /* APPLE LOCAL end compact dwarf */
+
 #ifdef HAVE_AS_LEB128
-  fprintf (asm_out_file, "\t.sleb128 " HOST_WIDE_INT_PRINT_DEC, value);
+  /* APPLE LOCAL begin asm output */
+  fputs ("\t.sleb128 ", asm_out_file);
+  fprint_w (asm_out_file, value);
+  /* APPLE LOCAL end asm output */
 
   if (flag_debug_asm && comment)
     {
@@ -639,6 +826,9 @@ dw2_asm_output_delta_uleb128 (const char *lab1 ATTRIBUTE_UNUSED,
 
   va_start (ap, comment);
 
+  /* APPLE LOCAL compact dwarf */
+  dw2_asm_flush_block ();
+
 #ifdef HAVE_AS_LEB128
   fputs ("\t.uleb128 ", asm_out_file);
   assemble_name (asm_out_file, lab1);
@@ -810,6 +1000,9 @@ dw2_asm_output_encoded_addr_rtx (int encoding, rtx addr, bool public,
 
   va_start (ap, comment);
 
+  /* APPLE LOCAL compact dwarf */
+  dw2_asm_flush_block ();
+
   size = size_of_encoded_value (encoding);
 
   if (encoding == DW_EH_PE_aligned)
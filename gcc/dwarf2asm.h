@@ -66,6 +66,12 @@ extern const char *eh_data_format_name (int);
 
 extern void dw2_output_indirect_constants (void);
 
+/* APPLE LOCAL begin compact dwarf */
+extern void dw2_asm_begin_block (void);
+extern void dw2_asm_flush_block (void);
+extern void dw2_asm_end_block (void);
+/* APPLE LOCAL end compact dwarf */
+
 /* These are currently unused.  */
 
 #if 0
@@ -69,6 +69,8 @@ Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA
 #include "hashtab.h"
 #include "cgraph.h"
 #include "input.h"
+/* APPLE LOCAL merge dwarf2 types */
+#include "pointer-set.h"
 
 #ifdef DWARF2_DEBUGGING_INFO
 static void dwarf2out_source_line (unsigned int, const char *);
@@ -3435,6 +3437,8 @@ output_loc_operands (dw_loc_descr_ref loc)
     case INTERNAL_DW_OP_tls_addr:
       if (targetm.asm_out.output_dwarf_dtprel)
 	{
+	  /* APPLE LOCAL compact dwarf */
+	  dw2_asm_flush_block ();
 	  targetm.asm_out.output_dwarf_dtprel (asm_out_file,
 					       DWARF2_ADDR_SIZE,
 					       val1->v.val_addr);
@@ -3816,6 +3820,8 @@ DEF_VEC_ALLOC_O(pubname_entry, gc);
 /* APPLE LOCAL begin radar 6275985 debug inlined section  */
 DEF_VEC_O(dw_die_ref);
 DEF_VEC_ALLOC_O(dw_die_ref, gc);
+/* APPLE LOCAL merge dwarf2 types */
+DEF_VEC_ALLOC_O(dw_die_ref, heap);
 
 typedef struct inlined_entry_struct GTY (())
 {
@@ -7186,6 +7192,9 @@ output_abbrev_section (void)
 {
   unsigned long abbrev_id;
 
+  /* APPLE LOCAL compact dwarf */
+  dw2_asm_begin_block ();
+
   for (abbrev_id = 1; abbrev_id < abbrev_die_table_in_use; ++abbrev_id)
     {
       dw_die_ref abbrev = abbrev_die_table[abbrev_id];
@@ -7215,6 +7224,9 @@ output_abbrev_section (void)
 
   /* Terminate the table.  */
   dw2_asm_output_data (1, 0, NULL);
+
+  /* APPLE LOCAL compact dwarf */
+  dw2_asm_end_block ();
 }
 
 /* Output a symbol we can use to refer to this DIE from another CU.  */
@@ -7227,6 +7239,9 @@ output_die_symbol (dw_die_ref die)
   if (sym == 0)
     return;
 
+  /* APPLE LOCAL compact dwarf */
+  dw2_asm_flush_block ();
+
   if (strncmp (sym, DIE_LABEL_PREFIX, sizeof (DIE_LABEL_PREFIX) - 1) == 0)
     /* We make these global, not weak; if the target doesn't support
        .linkonce, it doesn't support combining the sections, so debugging
@@ -7605,8 +7620,12 @@ output_comp_unit (dw_die_ref die, int output_if_empty)
     switch_to_section (debug_info_section);
 
   /* Output debugging information.  */
+  /* APPLE LOCAL begin compact dwarf */
+  dw2_asm_begin_block ();
   output_compilation_unit_header ();
   output_die (die);
+  dw2_asm_end_block ();
+  /* APPLE LOCAL end compact dwarf */
 
   /* Leave the marks on the main CU, so we can check them in
      output_pubnames.  */
@@ -7820,6 +7839,8 @@ output_pubnames (VEC (pubname_entry, gc) * names)
   pubname_ref pub;
 /* APPLE LOCAL end pubtypes, approved for 4.3 4535968  */
 
+  /* APPLE LOCAL compact dwarf */
+  dw2_asm_begin_block ();
   if (DWARF_INITIAL_LENGTH_SIZE - DWARF_OFFSET_SIZE == 4)
     dw2_asm_output_data (4, 0xffffffff,
       "Initial length escape value indicating 64-bit DWARF extension");
@@ -7858,6 +7879,8 @@ output_pubnames (VEC (pubname_entry, gc) * names)
   /* APPLE LOCAL end pubtypes, approved for 4.3 4535968  */
 
   dw2_asm_output_data (DWARF_OFFSET_SIZE, 0, NULL);
+  /* APPLE LOCAL compact dwarf */
+  dw2_asm_end_block ();
 }
 
 /* Add a new entry to .debug_aranges if appropriate.  */
@@ -14892,6 +14915,8 @@ maybe_emit_file (struct dwarf_file_data * fd)
       
       if (DWARF2_ASM_LINE_DEBUG_INFO)
 	{
+	  /* APPLE LOCAL compact dwarf */
+	  dw2_asm_flush_block ();
 	  fprintf (asm_out_file, "\t.file %u ", fd->emitted_number);
 	  output_quoted_string (asm_out_file, fd->filename);
 	  fputc ('\n', asm_out_file);
@@ -15646,6 +15671,413 @@ prune_unused_types (void)
     prune_unmark_dies (node->die);
 }
 
+/* APPLE LOCAL begin merge dwarf2 types */
+/* Pointer, qualified, base, array and function type DIEs mean the same
+   thing wherever they are in the tree, but one is made for each tree
+   type, so identical copies pile up across namespaces and template
+   instances.  merge_duplicate_type_dies hashes the subtrees of these
+   DIEs, keeps one copy of each and points every reference at it.  */
+
+/* Map from a duplicate DIE to the DIE that replaces it.  */
+static struct pointer_map_t *merged_type_dies;
+
+/* The DIEs removed from the tree by merge_duplicate_type_dies.  */
+static VEC (dw_die_ref, heap) *removed_type_dies;
+
+/* The number of DIEs, including children, in removed_type_dies.  */
+static unsigned long removed_type_die_count;
+
+/* Return nonzero if DIE may be replaced by an identical DIE elsewhere
+   in the tree.  */
+
+static int
+mergeable_type_die_p (dw_die_ref die)
+{
+  switch (die->die_tag)
+    {
+    case DW_TAG_base_type:
+    case DW_TAG_pointer_type:
+    case DW_TAG_reference_type:
+    case DW_TAG_ptr_to_member_type:
+    case DW_TAG_const_type:
+    case DW_TAG_volatile_type:
+    case DW_TAG_restrict_type:
+    case DW_TAG_packed_type:
+    case DW_TAG_array_type:
+    case DW_TAG_subroutine_type:
+      return die->die_symbol == NULL;
+    default:
+      return 0;
+    }
+}
+
+/* Return the DIE that replaces DIE.  */
+
+static dw_die_ref
+merged_type_die (dw_die_ref die)
+{
+  void **slot;
+
+  while ((slot = pointer_map_contains (merged_type_dies, die)) != NULL)
+    die = (dw_die_ref) *slot;
+  return die;
+}
+
+/* Add DIE and its children to the hash value HASH.  A reference to
+   another DIE adds the identity of the DIE that replaces it.  */
+
+static hashval_t
+type_die_hash_1 (dw_die_ref die, hashval_t hash)
+{
+  dw_attr_ref a;
+  dw_die_ref c;
+  unsigned ix;
+
+  hash = iterative_hash_object (die->die_tag, hash);
+  for (ix = 0; VEC_iterate (dw_attr_node, die->die_attr, ix, a); ix++)
+    {
+      hash = iterative_hash_object (a->dw_attr, hash);
+      switch (AT_class (a))
+	{
+	case dw_val_class_const:
+	  hash = iterative_hash_object (a->dw_attr_val.v.val_int, hash);
+	  break;
+	case dw_val_class_unsigned_const:
+	  hash = iterative_hash_object (a->dw_attr_val.v.val_unsigned, hash);
+	  break;
+	case dw_val_class_flag:
+	  hash = iterative_hash_object (a->dw_attr_val.v.val_flag, hash);
+	  break;
+	case dw_val_class_str:
+	  hash = iterative_hash (AT_string (a), strlen (AT_string (a)), hash);
+	  break;
+	case dw_val_class_die_ref:
+	  c = merged_type_die (AT_ref (a));
+	  hash = iterative_hash_object (c, hash);
+	  break;
+	default:
+	  break;
+	}
+    }
+
+  FOR_EACH_CHILD (die, c, hash = type_die_hash_1 (c, hash));
+  return hash;
+}
+
+static hashval_t
+type_die_hash (const void *x)
+{
+  return type_die_hash_1 ((dw_die_ref) x, 0);
+}
+
+/* Return nonzero if DIE1 and DIE2 have the same tag, attributes and
+   children.  References must be to the same DIE once merged DIEs are
+   replaced.  */
+
+static int
+same_type_die_p (dw_die_ref die1, dw_die_ref die2)
+{
+  dw_die_ref c1, c2;
+  dw_attr_ref a1, a2;
+  unsigned ix;
+  int mark = 0;
+
+  if (die1->die_tag != die2->die_tag
+      || (VEC_length (dw_attr_node, die1->die_attr)
+	  != VEC_length (dw_attr_node, die2->die_attr)))
+    return 0;
+
+  for (ix = 0; VEC_iterate (dw_attr_node, die1->die_attr, ix, a1); ix++)
+    {
+      a2 = VEC_index (dw_attr_node, die2->die_attr, ix);
+      if (a1->dw_attr != a2->dw_attr)
+	return 0;
+
+      switch (AT_class (a1))
+	{
+	case dw_val_class_die_ref:
+	  if (AT_class (a2) != dw_val_class_die_ref
+	      || merged_type_die (AT_ref (a1)) != merged_type_die (AT_ref (a2)))
+	    return 0;
+	  break;
+
+	case dw_val_class_const:
+	case dw_val_class_unsigned_const:
+	case dw_val_class_long_long:
+	case dw_val_class_vec:
+	case dw_val_class_flag:
+	case dw_val_class_str:
+	case dw_val_class_file:
+	  if (!same_dw_val_p (&a1->dw_attr_val, &a2->dw_attr_val, &mark))
+	    return 0;
+	  break;
+
+	default:
+	  /* Locations and labels, such as the bounds of a variable
+	     length array, depend on where the DIE is.  */
+	  return 0;
+	}
+    }
+
+  c1 = die1->die_child;
+  c2 = die2->die_child;
+  if (!c1 || !c2)
+    return c1 == c2;
+  do
+    {
+      c1 = c1->die_sib;
+      c2 = c2->die_sib;
+      if (!same_type_die_p (c1, c2))
+	return 0;
+    }
+  while (c1 != die1->die_child && c2 != die2->die_child);
+
+  return c1 == die1->die_child && c2 == die2->die_child;
+}
+
+static int
+type_die_eq (const void *x1, const void *x2)
+{
+  return same_type_die_p ((dw_die_ref) x1, (dw_die_ref) x2);
+}
+
+/* Push DIE and the DIEs below it that mergeable_type_die_p accepts
+   onto DIES.  */
+
+static void
+collect_mergeable_type_dies (dw_die_ref die, VEC (dw_die_ref, heap) **dies)
+{
+  dw_die_ref c;
+
+  if (mergeable_type_die_p (die))
+    VEC_safe_push (dw_die_ref, heap, *dies, &die);
+
+  FOR_EACH_CHILD (die, c, collect_mergeable_type_dies (c, dies));
+}
+
+/* Record that DUP, and each of its children, is replaced by DIE.  */
+
+static void
+merge_type_die (dw_die_ref dup, dw_die_ref die)
+{
+  dw_die_ref c1, c2;
+
+  *pointer_map_insert (merged_type_dies, dup) = die;
+
+  c1 = dup->die_child;
+  c2 = die->die_child;
+  if (c1)
+    do
+      {
+	c1 = c1->die_sib;
+	c2 = c2->die_sib;
+	merge_type_die (c1, c2);
+      }
+    while (c1 != dup->die_child);
+}
+
+/* Drop the string references of DIE and its children, which have been
+   taken out of the tree, and return how many DIEs there are.  */
+
+static unsigned long
+release_type_die (dw_die_ref die)
+{
+  unsigned long count = 1;
+  dw_attr_ref a;
+  dw_die_ref c;
+  unsigned ix;
+
+  for (ix = 0; VEC_iterate (dw_attr_node, die->die_attr, ix, a); ix++)
+    if (AT_class (a) == dw_val_class_str)
+      a->dw_attr_val.v.val_str->refcount--;
+
+  FOR_EACH_CHILD (die, c, count += release_type_die (c));
+  return count;
+}
+
+/* Point the references in DIE and below at the DIEs that replace
+   them, and take the merged DIEs out of the tree.  */
+
+static void
+remove_merged_type_dies (dw_die_ref die)
+{
+  dw_die_ref c, prev, last;
+  dw_attr_ref a;
+  unsigned ix;
+  bool last_p;
+
+  for (ix = 0; VEC_iterate (dw_attr_node, die->die_attr, ix, a); ix++)
+    if (AT_class (a) == dw_val_class_die_ref)
+      a->dw_attr_val.v.val_die_ref.die = merged_type_die (AT_ref (a));
+
+  if (! die->die_child)
+    return;
+
+  last = prev = die->die_child;
+  do
+    {
+      c = prev->die_sib;
+      last_p = c == last;
+      if (pointer_map_contains (merged_type_dies, c))
+	{
+	  remove_child_with_prev (c, prev);
+	  removed_type_die_count += release_type_die (c);
+	  VEC_safe_push (dw_die_ref, heap, removed_type_dies, &c);
+	}
+      else
+	{
+	  remove_merged_type_dies (c);
+	  prev = c;
+	}
+    }
+  while (!last_p);
+}
+
+/* Replace the .debug_pubtypes entries for merged DIEs with entries for
+   the DIEs that replace them, unless those are already listed.  */
+
+static void
+merge_pubtypes (void)
+{
+  struct pointer_set_t *listed = pointer_set_create ();
+  pubname_ref pub;
+  unsigned i, j;
+
+  for (i = 0; VEC_iterate (pubname_entry, pubtype_table, i, pub); i++)
+    if (!pointer_map_contains (merged_type_dies, pub->die))
+      pointer_set_insert (listed, pub->die);
+
+  for (i = j = 0; VEC_iterate (pubname_entry, pubtype_table, i, pub); i++)
+    {
+      if (pointer_map_contains (merged_type_dies, pub->die))
+	{
+	  pub->die = merged_type_die (pub->die);
+	  if (pointer_set_insert (listed, pub->die))
+	    continue;
+	}
+      VEC_replace (pubname_entry, pubtype_table, j++, pub);
+    }
+  VEC_truncate (pubname_entry, pubtype_table, j);
+
+  pointer_set_destroy (listed);
+}
+
+/* Keep one copy of each group of identical type DIEs in the main
+   compilation unit.  */
+
+static void
+merge_duplicate_type_dies (void)
+{
+  VEC (dw_die_ref, heap) *dies = NULL;
+  dw_die_ref *p;
+  htab_t table;
+  unsigned ix;
+  bool changed, merged = false;
+
+  collect_mergeable_type_dies (comp_unit_die, &dies);
+  if (VEC_length (dw_die_ref, dies) < 2)
+    {
+      VEC_free (dw_die_ref, heap, dies);
+      return;
+    }
+
+  merged_type_dies = pointer_map_create ();
+  table = htab_create (VEC_length (dw_die_ref, dies),
+		       type_die_hash, type_die_eq, NULL);
+
+  /* Merging DIEs can make the DIEs that refer to them identical, so go
+     round until nothing changes.  */
+  do
+    {
+      changed = false;
+      htab_empty (table);
+      for (ix = 0; VEC_iterate (dw_die_ref, dies, ix, p); ix++)
+	{
+	  dw_die_ref die = *p, other;
+	  void **slot;
+
+	  if (pointer_map_contains (merged_type_dies, die))
+	    continue;
+
+	  slot = htab_find_slot (table, die, INSERT);
+	  other = (dw_die_ref) *slot;
+	  if (other == NULL)
+	    *slot = die;
+	  /* Keep a copy at the outermost level if there is one.  */
+	  else if (die->die_parent == comp_unit_die
+		   && other->die_parent != comp_unit_die)
+	    {
+	      *slot = die;
+	      merge_type_die (other, die);
+	      changed = true;
+	    }
+	  else
+	    {
+	      merge_type_die (die, other);
+	      changed = true;
+	    }
+	}
+      merged |= changed;
+    }
+  while (changed);
+
+  if (merged)
+    {
+      remove_merged_type_dies (comp_unit_die);
+      merge_pubtypes ();
+    }
+
+  htab_delete (table);
+  VEC_free (dw_die_ref, heap, dies);
+  pointer_map_destroy (merged_type_dies);
+  merged_type_dies = NULL;
+}
+
+/* Return the size DIE and its children would have taken up in
+   .debug_info.  */
+
+static unsigned long
+size_of_removed_type_die (dw_die_ref die)
+{
+  unsigned long size = size_of_die (die);
+  dw_die_ref c;
+
+  if (die->die_child)
+    {
+      FOR_EACH_CHILD (die, c, size += size_of_removed_type_die (c));
+      /* The null entry that ends the children.  */
+      size += 1;
+    }
+  return size;
+}
+
+/* Report what merge_duplicate_type_dies saved, and forget the removed
+   DIEs.  */
+
+static void
+report_merged_type_dies (void)
+{
+  unsigned long size = 0;
+  dw_die_ref *p;
+  unsigned ix;
+
+  if (removed_type_dies == NULL)
+    return;
+
+  if (flag_detailed_statistics)
+    {
+      for (ix = 0; VEC_iterate (dw_die_ref, removed_type_dies, ix, p); ix++)
+	size += size_of_removed_type_die (*p);
+      fprintf (stderr, "%lu duplicate type DIEs merged, "
+	       "about %lu bytes of .debug_info saved\n",
+	       removed_type_die_count, size);
+    }
+
+  VEC_free (dw_die_ref, heap, removed_type_dies);
+  removed_type_die_count = 0;
+}
+/* APPLE LOCAL end merge dwarf2 types */
+
 /* Set the parameter to true if there are any relative pathnames in
    the file table.  */
 static int
@@ -15772,6 +16204,13 @@ dwarf2out_finish (const char *filename)
   if (flag_eliminate_unused_debug_types)
     prune_unused_types ();
 
+  /* APPLE LOCAL begin merge dwarf2 types */
+  /* Duplicate elimination moves DIEs into other CUs, which can only
+     refer to DIEs that have symbols.  */
+  if (flag_merge_dwarf2_types && !flag_eliminate_dwarf2_dups)
+    merge_duplicate_type_dies ();
+  /* APPLE LOCAL end merge dwarf2 types */
+
   /* Generate separate CUs for each of the include files we've seen.
      They will go into limbo_die_list.  */
   if (flag_eliminate_dwarf2_dups)
@@ -15829,6 +16268,8 @@ dwarf2out_finish (const char *filename)
     output_comp_unit (node->die, 0);
 
   output_comp_unit (comp_unit_die, 0);
+  /* APPLE LOCAL merge dwarf2 types */
+  report_merged_type_dies ();
 
   /* Output the abbreviation table.  */
   switch_to_section (debug_abbrev_section);
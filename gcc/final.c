@@ -3305,7 +3305,8 @@ output_addr_const (FILE *file, rtx x)
       break;
 
     case CONST_INT:
-      fprintf (file, HOST_WIDE_INT_PRINT_DEC, INTVAL (x));
+      /* APPLE LOCAL asm output */
+      fprint_w (file, INTVAL (x));
       break;
 
     case CONST:
@@ -3389,6 +3390,50 @@ output_addr_const (FILE *file, rtx x)
     }
 }
 
+/* APPLE LOCAL begin asm output */
+/* Print VALUE to F as HOST_WIDE_INT_PRINT_HEX would.  Integers are a
+   large part of the assembly output, so avoid fprintf for them.  */
+
+void
+fprint_whex (FILE *f, unsigned HOST_WIDE_INT value)
+{
+  char buf[2 + HOST_BITS_PER_WIDE_INT / 4];
+  char *p = buf + sizeof (buf);
+
+  do
+    {
+      *--p = "0123456789abcdef"[value & 0xf];
+      value >>= 4;
+    }
+  while (value != 0);
+  *--p = 'x';
+  *--p = '0';
+  fwrite (p, 1, buf + sizeof (buf) - p, f);
+}
+
+/* Print VALUE to F as HOST_WIDE_INT_PRINT_DEC would.  */
+
+void
+fprint_w (FILE *f, HOST_WIDE_INT value)
+{
+  char buf[2 + HOST_BITS_PER_WIDE_INT / 3];
+  char *p = buf + sizeof (buf);
+  unsigned HOST_WIDE_INT u = value;
+
+  if (value < 0)
+    u = -u;
+  do
+    {
+      *--p = '0' + u % 10;
+      u /= 10;
+    }
+  while (u != 0);
+  if (value < 0)
+    *--p = '-';
+  fwrite (p, 1, buf + sizeof (buf) - p, f);
+}
+/* APPLE LOCAL end asm output */
+
 /* A poor man's fprintf, with the added features of %I, %R, %L, and %U.
    %R prints the value of REGISTER_PREFIX.
    %L prints the value of LOCAL_LABEL_PREFIX.
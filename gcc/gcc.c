@@ -223,6 +223,12 @@ static int combine_flag = 0;
 
 static int use_pipes;
 
+/* APPLE LOCAL begin -j */
+/* The number of input files to compile at once, from -j.  */
+
+static int n_jobs = 1;
+/* APPLE LOCAL end -j */
+
 /* The compiler version.  */
 
 static const char *compiler_version;
@@ -351,6 +357,12 @@ static int execute (void);
 static void alloc_args (void);
 static void clear_args (void);
 static void fatal_error (int);
+/* APPLE LOCAL begin -j */
+#ifdef HAVE_FORK
+static void start_compile_job (int);
+static void finish_compile_jobs (void);
+#endif
+/* APPLE LOCAL end -j */
 #if defined(ENABLE_SHARED_LIBGCC) && !defined(REAL_LIBGCC_SPEC)
 static void init_gcc_specs (struct obstack *, const char *, const char *,
 			    const char *);
@@ -3293,6 +3305,8 @@ display_help (void)
   fputs (_("  -save-temps              Do not delete intermediate files\n"), stdout);
   fputs (_("  -pipe                    Use pipes rather than intermediate files\n"), stdout);
   fputs (_("  -time                    Time the execution of each subprocess\n"), stdout);
+  /* APPLE LOCAL -j */
+  fputs (_("  -j <number>              Compile up to <number> input files at once\n"), stdout);
   fputs (_("  -specs=<file>            Override built-in specs with the contents of <file>\n"), stdout);
   fputs (_("  -std=<standard>          Assume that the input sources are for <standard>\n"), stdout);
   fputs (_("\
@@ -3877,6 +3891,26 @@ warranty; not even for MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.\n\n"
 	}
       else if (strcmp (argv[i], "-time") == 0)
 	report_times = 1;
+      /* APPLE LOCAL begin -j */
+      else if (argv[i][0] == '-' && argv[i][1] == 'j'
+	       && (argv[i][2] == 0 || ISDIGIT (argv[i][2])))
+	{
+	  const char *arg = argv[i] + 2;
+	  const char *p;
+
+	  if (*arg == 0)
+	    {
+	      if (i + 1 == argc)
+		fatal ("argument to '-j' is missing");
+	      arg = argv[++i];
+	    }
+	  for (p = arg; ISDIGIT (*p); p++)
+	    ;
+	  if (*p != 0 || p == arg || atoi (arg) < 1)
+	    fatal ("invalid argument to '-j': %s", arg);
+	  n_jobs = atoi (arg);
+	}
+      /* APPLE LOCAL end -j */
       else if (strcmp (argv[i], "-pipe") == 0)
 	{
 	  /* -pipe has to go into the switches array as well as
@@ -4334,6 +4368,14 @@ warranty; not even for MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.\n\n"
       /* APPLE LOCAL end -ObjC 2001-08-03 --sts */
       else if (strcmp (argv[i], "-time") == 0)
 	;
+      /* APPLE LOCAL begin -j */
+      else if (argv[i][0] == '-' && argv[i][1] == 'j'
+	       && (argv[i][2] == 0 || ISDIGIT (argv[i][2])))
+	{
+	  if (argv[i][2] == 0)
+	    i++;
+	}
+      /* APPLE LOCAL end -j */
       else if (strcmp (argv[i], "-###") == 0)
 	;
       /* APPLE LOCAL begin frameworks */
@@ -6423,6 +6465,213 @@ fatal_error (int signum)
   kill (getpid (), signum);
 }
 
+/* APPLE LOCAL begin -j */
+#ifdef HAVE_FORK
+/* Under -j, each input file is compiled by a copy of the driver made
+   with fork, which runs the file's spec as usual.  Its standard output
+   and standard error go to temporary files that are copied out in the
+   order of the input files, so diagnostics come out as they would
+   without -j; what the driver needs to know afterwards is written to a
+   third file.  */
+
+struct compile_job
+{
+  /* The index of the input file in INFILES.  */
+  int input;
+  pid_t pid;
+  char *out_name;
+  char *err_name;
+  char *report_name;
+};
+
+/* The jobs that have been started and not yet finished, oldest first,
+   as a ring of N_JOBS entries.  */
+
+static struct compile_job *compile_jobs;
+static int first_compile_job;
+static int n_compile_jobs;
+
+/* Send the standard output or error of a compile job, in the file NAME,
+   to STREAM.  */
+
+static void
+copy_job_output (const char *name, FILE *stream)
+{
+  char buf[4096];
+  size_t len;
+  FILE *f;
+
+  f = fopen (name, "r");
+  if (f == NULL)
+    return;
+  while ((len = fread (buf, 1, sizeof (buf), f)) > 0)
+    fwrite (buf, 1, len, stream);
+  fclose (f);
+  fflush (stream);
+  delete_if_ordinary (name);
+}
+
+/* Point the file descriptor FD at the file NAME.  */
+
+static void
+redirect_job_output (int fd, const char *name)
+{
+  int desc = open (name, O_WRONLY | O_TRUNC, 0);
+
+  if (desc < 0 || dup2 (desc, fd) < 0)
+    pfatal_with_name (name);
+  close (desc);
+}
+
+/* Compile the input file of JOB; this runs in the child.  */
+
+static void
+run_compile_job (struct compile_job *job)
+{
+  int saved_execution_count = execution_count;
+  int saved_signal_count = signal_count;
+  struct temp_file *temp;
+  FILE *report;
+  int value;
+
+  /* The temporary files the driver has made so far are its business.  */
+  always_delete_queue = 0;
+  failure_delete_queue = 0;
+
+  redirect_job_output (1, job->out_name);
+  redirect_job_output (2, job->err_name);
+
+  value = do_spec (input_file_compiler->spec);
+  if (value < 0)
+    delete_failure_queue ();
+
+  /* Tell the driver how it went, where the output is, and which
+     temporary files are left for it to delete.  */
+  report = fopen (job->report_name, "w");
+  if (report == NULL)
+    pfatal_with_name (job->report_name);
+  fprintf (report, "%d %d %d %d\n", value < 0, greatest_status,
+	   signal_count - saved_signal_count,
+	   execution_count - saved_execution_count);
+  if (outfiles[job->input])
+    fprintf (report, "o%s\n", outfiles[job->input]);
+  for (temp = always_delete_queue; temp; temp = temp->next)
+    fprintf (report, "d%s\n", temp->name);
+  if (fclose (report) != 0)
+    pfatal_with_name (job->report_name);
+
+  exit (0);
+}
+
+/* Wait for the oldest job to finish, pass on its output, and take over
+   what it left for the driver.  */
+
+static void
+finish_compile_job (void)
+{
+  struct compile_job *job = &compile_jobs[first_compile_job];
+  int failed, status, signals, executions;
+  struct stat st;
+  char *report, *line, *end;
+  int desc, len;
+
+  while (waitpid (job->pid, &status, 0) < 0)
+    if (errno != EINTR)
+      pfatal_with_name ("waitpid");
+  first_compile_job = (first_compile_job + 1) % n_jobs;
+  n_compile_jobs--;
+
+  copy_job_output (job->out_name, stdout);
+  copy_job_output (job->err_name, stderr);
+
+  /* A job that did not finish normally has already said why, and
+     deleted its own temporary files.  */
+  if (WIFSIGNALED (status))
+    signal_count++;
+  if (! WIFEXITED (status) || WEXITSTATUS (status) != 0)
+    {
+      error_count++;
+      return;
+    }
+
+  desc = open (job->report_name, O_RDONLY, 0);
+  if (desc < 0 || fstat (desc, &st) < 0)
+    pfatal_with_name (job->report_name);
+  report = XNEWVEC (char, st.st_size + 1);
+  len = read (desc, report, st.st_size);
+  if (len < 0)
+    pfatal_with_name (job->report_name);
+  report[len] = 0;
+  close (desc);
+
+  if (sscanf (report, "%d %d %d %d", &failed, &status, &signals,
+	      &executions) != 4)
+    fatal ("%s: malformed job report", job->report_name);
+  if (failed)
+    error_count++;
+  if (status > greatest_status)
+    greatest_status = status;
+  signal_count += signals;
+  execution_count += executions;
+
+  outfiles[job->input] = NULL;
+  for (line = strchr (report, '\n') + 1;
+       (end = strchr (line, '\n')) != NULL;
+       line = end + 1)
+    {
+      *end = 0;
+      if (line[0] == 'o')
+	outfiles[job->input] = xstrdup (line + 1);
+      else if (line[0] == 'd')
+	record_temp_file (line + 1, 1, 0);
+    }
+  free (report);
+}
+
+/* Wait for all the compile jobs to finish.  */
+
+static void
+finish_compile_jobs (void)
+{
+  while (n_compile_jobs > 0)
+    finish_compile_job ();
+}
+
+/* Start compiling input file I in the background, first waiting for a
+   job to finish if N_JOBS are running.  */
+
+static void
+start_compile_job (int i)
+{
+  struct compile_job *job;
+
+  if (compile_jobs == NULL)
+    compile_jobs = XNEWVEC (struct compile_job, n_jobs);
+  if (n_compile_jobs == n_jobs)
+    finish_compile_job ();
+
+  job = &compile_jobs[(first_compile_job + n_compile_jobs) % n_jobs];
+  job->input = i;
+  job->out_name = make_temp_file (".out");
+  job->err_name = make_temp_file (".err");
+  job->report_name = make_temp_file (".job");
+  record_temp_file (job->out_name, 1, 0);
+  record_temp_file (job->err_name, 1, 0);
+  record_temp_file (job->report_name, 1, 0);
+
+  fflush (stdout);
+  fflush (stderr);
+  job->pid = fork ();
+  if (job->pid < 0)
+    pfatal_with_name ("fork");
+  if (job->pid == 0)
+    run_compile_job (job);
+
+  n_compile_jobs++;
+}
+#endif
+/* APPLE LOCAL end -j */
+
 extern int main (int, char **);
 
 int
@@ -7030,6 +7279,11 @@ main (int argc, char **argv)
 
 	  if (input_file_compiler->spec[0] == '#')
 	    {
+	      /* APPLE LOCAL begin -j */
+#ifdef HAVE_FORK
+	      finish_compile_jobs ();
+#endif
+	      /* APPLE LOCAL end -j */
 	      error ("%s: %s compiler not installed on this system",
 		     input_filename, &input_file_compiler->spec[1]);
 	      this_file_error = 1;
@@ -7044,6 +7298,17 @@ main (int argc, char **argv)
 	  else if (!capital_e_flag || !combine_inputs)
 	  /* APPLE LOCAL end IMA */
 	    {
+	      /* APPLE LOCAL begin -j */
+#ifdef HAVE_FORK
+	      if (n_jobs > 1 && ! combine_inputs)
+		{
+		  /* The job takes care of this file's failure queue.  */
+		  start_compile_job (i);
+		  infiles[i].compiled = true;
+		  continue;
+		}
+#endif
+	      /* APPLE LOCAL end -j */
 	      value = do_spec (input_file_compiler->spec);
 	      infiles[i].compiled = true;
 	      if (value < 0)
@@ -7069,6 +7334,12 @@ main (int argc, char **argv)
       clear_failure_queue ();
     }
 
+  /* APPLE LOCAL begin -j */
+#ifdef HAVE_FORK
+  finish_compile_jobs ();
+#endif
+  /* APPLE LOCAL end -j */
+
   /* Reset the input file name to the first compile/object file name, for use
      with %b in LINK_SPEC. We use the first input file that we can find
      a compiler to compile it instead of using infiles.language since for
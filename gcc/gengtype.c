@@ -83,6 +83,14 @@ struct type string_type = {
   TYPE_STRING, NULL, NULL, GC_USED, {0}
 };
 
+/* APPLE LOCAL begin relocatable PCH */
+/* The one and only TYPE_CALLBACK.  */
+
+struct type callback_type = {
+  TYPE_CALLBACK, NULL, NULL, GC_USED, {0}
+};
+/* APPLE LOCAL end relocatable PCH */
+
 /* Lists of various things.  */
 
 static pair_p typedefs;
@@ -1533,6 +1541,8 @@ walk_type (type_p t, struct walk_type_data *d)
   int use_params_p = 0;
   options_p oo;
   const struct nested_ptr_data *nested_ptr_d = NULL;
+  /* APPLE LOCAL relocatable PCH */
+  int callback_p = 0;
 
   d->needs_cast_p = false;
   for (oo = d->opt; oo; oo = oo->next)
@@ -1573,12 +1583,26 @@ walk_type (type_p t, struct walk_type_data *d)
       ;
     else if (strcmp (oo->name, "reorder") == 0)
       ;
+    /* APPLE LOCAL begin relocatable PCH */
+    else if (strcmp (oo->name, "callback") == 0)
+      callback_p = 1;
+    /* APPLE LOCAL end relocatable PCH */
     else
       error_at_line (d->line, "unknown option `%s'\n", oo->name);
 
   if (d->used_length)
     length = NULL;
 
+  /* APPLE LOCAL begin relocatable PCH */
+  /* Whatever its declared type, a 'callback' field is only of interest
+     to PCH, which needs to know where it is.  */
+  if (callback_p)
+    {
+      d->process_field (&callback_type, d);
+      return;
+    }
+  /* APPLE LOCAL end relocatable PCH */
+
   if (use_params_p)
     {
       int pointer_p = t->kind == TYPE_POINTER;
@@ -1681,12 +1705,23 @@ walk_type (type_p t, struct walk_type_data *d)
 
 		if (d->fn_wants_lvalue)
 		  {
+		    /* APPLE LOCAL relocatable PCH */
+		    const char *field = d->prev_val[2];
+
 		    oprintf (d->of, "%*s%s = ", d->indent, "",
 			     d->prev_val[2]);
 		    d->prev_val[2] = d->val;
 		    output_escaped_param (d, nested_ptr_d->convert_to,
 					  "nested_ptr");
 		    oprintf (d->of, ";\n");
+		    /* APPLE LOCAL begin relocatable PCH */
+		    /* The pointer was relocated through a copy; tell PCH
+		       where it really is.  */
+		    oprintf (d->of, "%*sif ((void *)(%s) == this_obj)\n",
+			     d->indent, "", d->prev_val[3]);
+		    oprintf (d->of, "%*s  gt_pch_note_relocation (&(%s), cookie);\n",
+			     d->indent, "", field);
+		    /* APPLE LOCAL end relocatable PCH */
 		  }
 
 		d->indent -= 2;
@@ -1995,6 +2030,8 @@ write_types_process_field (type_p f, const struct walk_type_data *d)
       break;
 
     case TYPE_SCALAR:
+    /* APPLE LOCAL relocatable PCH */
+    case TYPE_CALLBACK:
       break;
 
     default:
@@ -2140,6 +2177,10 @@ write_func_for_structure (type_p orig_s, type_p s, type_p *param,
       oprintf (d.of, "  while (x != xlimit)\n");
     }
   oprintf (d.of, "    {\n");
+  /* APPLE LOCAL begin relocatable PCH */
+  if (wtd->param_prefix != NULL && s == find_structure ("htab", 0))
+    oprintf (d.of, "      gt_pch_note_htab (x);\n");
+  /* APPLE LOCAL end relocatable PCH */
 
   d.prev_val[2] = "*x";
   d.indent = 6;
@@ -2286,6 +2327,15 @@ write_types_local_process_field (type_p f, const struct walk_type_data *d)
       oprintf (d->of, "%*s  op (&(%s), cookie);\n", d->indent, "", d->val);
       break;
 
+    /* APPLE LOCAL begin relocatable PCH */
+    case TYPE_CALLBACK:
+      oprintf (d->of, "%*sif ((void *)(%s) == this_obj)\n", d->indent, "",
+	       d->prev_val[3]);
+      oprintf (d->of, "%*s  gt_pch_note_callback (&(%s), cookie);\n",
+	       d->indent, "", d->val);
+      break;
+    /* APPLE LOCAL end relocatable PCH */
+
     case TYPE_SCALAR:
       break;
 
@@ -2705,10 +2755,26 @@ write_root (outf_p f, pair_p v, type_p type, const char *name, int has_length,
 
     case TYPE_STRING:
       {
+	/* APPLE LOCAL begin relocatable PCH */
+	type_p ap;
+
+	/* A string in an array of structures is in every element, not
+	   just the first.  Otherwise PCH doesn't copy the rest, and
+	   keeps pointers into the executable that wrote it.  */
 	oprintf (f, "  {\n");
 	oprintf (f, "    &%s,\n", name);
-	oprintf (f, "    1, \n");
-	oprintf (f, "    sizeof (%s),\n", v->name);
+	oprintf (f, "    1");
+	for (ap = v->type; ap->kind == TYPE_ARRAY; ap = ap->u.a.p)
+	  if (ap->u.a.len[0])
+	    oprintf (f, " * (%s)", ap->u.a.len);
+	  else if (ap == v->type)
+	    oprintf (f, " * ARRAY_SIZE (%s)", v->name);
+	oprintf (f, ",\n");
+	oprintf (f, "    sizeof (%s", v->name);
+	for (ap = v->type; ap->kind == TYPE_ARRAY; ap = ap->u.a.p)
+	  oprintf (f, "[0]");
+	oprintf (f, "),\n");
+	/* APPLE LOCAL end relocatable PCH */
 	oprintf (f, "    &gt_ggc_m_S,\n");
 	oprintf (f, "    (gt_pointer_walker) &gt_pch_n_S\n");
 	oprintf (f, "  },\n");
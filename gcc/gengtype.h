@@ -34,7 +34,12 @@ enum typekind {
   TYPE_POINTER,
   TYPE_ARRAY,
   TYPE_LANG_STRUCT,
-  TYPE_PARAM_STRUCT
+  TYPE_PARAM_STRUCT,
+  /* APPLE LOCAL begin relocatable PCH */
+  /* A field marked 'callback': a pointer into the compiler executable,
+     which PCH must adjust if the executable moves.  */
+  TYPE_CALLBACK
+  /* APPLE LOCAL end relocatable PCH */
 };
 
 typedef struct pair *pair_p;
@@ -114,6 +119,8 @@ struct type {
 
 /* The one and only TYPE_STRING.  */
 extern struct type string_type;
+/* APPLE LOCAL relocatable PCH */
+extern struct type callback_type;
 
 /* Variables used to communicate between the lexer and the parser.  */
 extern int lexer_toplevel_done;
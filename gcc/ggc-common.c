@@ -78,6 +78,11 @@ static int compare_ptr_data (const void *, const void *);
 static void relocate_ptrs (void *, void *);
 static void write_pch_globals (const struct ggc_root_tab * const *tab,
 			       struct traversal_state *state);
+/* APPLE LOCAL begin relocatable PCH */
+static size_t pch_slot_offset (struct traversal_state *, void *);
+static void relocate_pch_globals (const struct ggc_root_tab * const *,
+				  ptrdiff_t);
+/* APPLE LOCAL end relocatable PCH */
 static double ggc_rlimit_bound (double);
 
 /* Maintain global roots that are preserved during GC.  */
@@ -245,6 +250,10 @@ struct ptr_data
   size_t size;
   void *new_addr;
   enum gt_types_enum type;
+  /* APPLE LOCAL begin relocatable PCH */
+  /* True if the object is a hash table.  */
+  bool htab_p;
+  /* APPLE LOCAL end relocatable PCH */
 };
 
 #define POINTER_HASH(x) (hashval_t)((long)x >> 3)
@@ -323,6 +332,19 @@ struct traversal_state
   size_t count;
   struct ptr_data **ptrs;
   size_t ptrs_i;
+  /* APPLE LOCAL begin relocatable PCH */
+  /* The base of the image, and the object being written out.  */
+  char *base;
+  struct ptr_data *this_object;
+  /* One bit for each pointer-sized word of the image, set if that word
+     points into the image.  */
+  unsigned long *ptr_map;
+  /* The offsets in the image of the words that point into the
+     executable.  */
+  size_t *callbacks;
+  size_t n_callbacks;
+  size_t callbacks_alloc;
+  /* APPLE LOCAL end relocatable PCH */
 };
 
 /* Callbacks for htab_traverse.  */
@@ -370,8 +392,8 @@ static void
 relocate_ptrs (void *ptr_p, void *state_p)
 {
   void **ptr = (void **)ptr_p;
-  struct traversal_state *state ATTRIBUTE_UNUSED
-    = (struct traversal_state *)state_p;
+  /* APPLE LOCAL relocatable PCH */
+  struct traversal_state *state = (struct traversal_state *)state_p;
   struct ptr_data *result;
 
   if (*ptr == NULL || *ptr == (void *)1)
@@ -380,8 +402,107 @@ relocate_ptrs (void *ptr_p, void *state_p)
   result = htab_find_with_hash (saving_htab, *ptr, POINTER_HASH (*ptr));
   gcc_assert (result);
   *ptr = result->new_addr;
+
+  /* APPLE LOCAL begin relocatable PCH */
+  /* A pointer that isn't in the object is a copy, made to convert it
+     to the type of the object it points to; gt_pch_note_relocation
+     will be told where the real pointer is.  */
+  if ((size_t) ((char *) ptr_p - (char *) state->this_object->obj)
+      < state->this_object->size)
+    gt_pch_note_relocation (ptr_p, state);
+  /* APPLE LOCAL end relocatable PCH */
+}
+
+/* APPLE LOCAL begin relocatable PCH */
+/* Return where PTR_P, a pointer in the object being written out, will
+   be in the image.  */
+
+static size_t
+pch_slot_offset (struct traversal_state *state, void *ptr_p)
+{
+  size_t off = (char *) ptr_p - (char *) state->this_object->obj;
+
+  gcc_assert (off < state->this_object->size
+	      && off % sizeof (void *) == 0);
+  return (char *) state->this_object->new_addr - state->base + off;
+}
+
+/* Callback for the gt_pch_p_* routines.  PTR_P points to a pointer to
+   a function or to static data, which the image can't be relocated
+   over if the executable is loaded at a different address; remember
+   where it is so that it can be adjusted instead.  */
+
+void
+gt_pch_note_callback (void *ptr_p, void *state_p)
+{
+  struct traversal_state *state = (struct traversal_state *)state_p;
+
+  if (*(void **)ptr_p == NULL)
+    return;
+
+  if (state->n_callbacks == state->callbacks_alloc)
+    {
+      state->callbacks_alloc = state->callbacks_alloc * 2 + 64;
+      state->callbacks = XRESIZEVEC (size_t, state->callbacks,
+				     state->callbacks_alloc);
+    }
+  state->callbacks[state->n_callbacks++] = pch_slot_offset (state, ptr_p);
+}
+
+/* Callback for the gt_pch_p_* routines, and relocate_ptrs.  PTR_P
+   points to a pointer into the image; remember where it is, in case
+   the image has to be used somewhere else.  */
+
+void
+gt_pch_note_relocation (void *ptr_p, void *state_p)
+{
+  struct traversal_state *state = (struct traversal_state *)state_p;
+  size_t word;
+
+  if (*(void **)ptr_p == NULL)
+    return;
+
+  word = pch_slot_offset (state, ptr_p) / sizeof (void *);
+  state->ptr_map[word / HOST_BITS_PER_LONG]
+    |= 1UL << (word % HOST_BITS_PER_LONG);
 }
 
+/* Callback for the gt_pch_n_* routines.  OBJ, already registered, is
+   a hash table.  Where its entries are may depend on the addresses of
+   the objects in it, which change when they are written out, so
+   remember to rehash it when the image is read back.  */
+
+void
+gt_pch_note_htab (void *obj)
+{
+  struct ptr_data *data;
+
+  data = htab_find_with_hash (saving_htab, obj, POINTER_HASH (obj));
+  gcc_assert (data);
+  data->htab_p = true;
+}
+
+/* Add BIAS to the global pointers in TAB, just read from a PCH image
+   loaded BIAS bytes away from where it was meant to be.  */
+
+static void
+relocate_pch_globals (const struct ggc_root_tab * const *tab, ptrdiff_t bias)
+{
+  const struct ggc_root_tab *const *rt;
+  const struct ggc_root_tab *rti;
+  size_t i;
+
+  for (rt = tab; *rt; rt++)
+    for (rti = *rt; rti->base != NULL; rti++)
+      for (i = 0; i < rti->nelt; i++)
+	{
+	  char **ptr = (char **)((char *)rti->base + rti->stride * i);
+	  if (*ptr != NULL && *ptr != (char *)1)
+	    *ptr += bias;
+	}
+}
+/* APPLE LOCAL end relocatable PCH */
+
 /* Write out, after relocation, the pointers in TAB.  */
 static void
 write_pch_globals (const struct ggc_root_tab * const *tab,
@@ -423,6 +544,26 @@ struct mmap_info
   void *preferred_base;
 };
 
+/* APPLE LOCAL begin relocatable PCH */
+/* What follows the image: this, then a bitmap of the words in the
+   image that point into it, then the offsets in the image of the
+   N_CALLBACKS words that point into the executable, and last the
+   offsets of the N_HTABS hash tables in the image.  With these the
+   image can be used at any address, and by the same executable loaded
+   at any address.  */
+
+struct pch_reloc_info
+{
+  void (*exec_addr) (FILE *);
+  size_t n_callbacks;
+  size_t n_htabs;
+};
+
+/* The number of longs in the bitmap for an image of SIZE bytes.  */
+#define PCH_PTR_MAP_LONGS(SIZE) \
+  (((SIZE) / sizeof (void *) + HOST_BITS_PER_LONG - 1) / HOST_BITS_PER_LONG)
+/* APPLE LOCAL end relocatable PCH */
+
 /* Write out the state of the compiler to F.  */
 
 void
@@ -436,6 +577,10 @@ gt_pch_save (FILE *f)
   size_t this_object_size = 0;
   struct mmap_info mmi;
   const size_t mmap_offset_alignment = host_hooks.gt_pch_alloc_granularity();
+  /* APPLE LOCAL begin relocatable PCH */
+  struct pch_reloc_info reloc;
+  size_t *htabs;
+  /* APPLE LOCAL end relocatable PCH */
 
   gt_pch_save_stringpool ();
 
@@ -468,6 +613,13 @@ gt_pch_save (FILE *f)
       
   ggc_pch_this_base (state.d, mmi.preferred_base);
 
+  /* APPLE LOCAL begin relocatable PCH */
+  state.base = mmi.preferred_base;
+  state.ptr_map = XCNEWVEC (unsigned long, PCH_PTR_MAP_LONGS (mmi.size));
+  state.callbacks = NULL;
+  state.n_callbacks = state.callbacks_alloc = 0;
+  /* APPLE LOCAL end relocatable PCH */
+
   state.ptrs = XNEWVEC (struct ptr_data *, state.count);
   state.ptrs_i = 0;
   htab_traverse (saving_htab, call_alloc, &state);
@@ -512,6 +664,8 @@ gt_pch_save (FILE *f)
 	  this_object = xrealloc (this_object, this_object_size);
 	}
       memcpy (this_object, state.ptrs[i]->obj, state.ptrs[i]->size);
+      /* APPLE LOCAL relocatable PCH */
+      state.this_object = state.ptrs[i];
       if (state.ptrs[i]->reorder_fn != NULL)
 	state.ptrs[i]->reorder_fn (state.ptrs[i]->obj,
 				   state.ptrs[i]->note_ptr_cookie,
@@ -526,6 +680,29 @@ gt_pch_save (FILE *f)
 	memcpy (state.ptrs[i]->obj, this_object, state.ptrs[i]->size);
     }
   ggc_pch_finish (state.d, state.f);
+
+  /* APPLE LOCAL begin relocatable PCH */
+  htabs = XNEWVEC (size_t, state.count);
+  reloc.exec_addr = gt_pch_save;
+  reloc.n_callbacks = state.n_callbacks;
+  reloc.n_htabs = 0;
+  for (i = 0; i < state.count; i++)
+    if (state.ptrs[i]->htab_p)
+      htabs[reloc.n_htabs++] = (char *) state.ptrs[i]->new_addr - state.base;
+  if (fwrite (&reloc, sizeof (reloc), 1, state.f) != 1
+      || fwrite (state.ptr_map, sizeof (unsigned long),
+		 PCH_PTR_MAP_LONGS (mmi.size), state.f)
+	 != PCH_PTR_MAP_LONGS (mmi.size)
+      || fwrite (state.callbacks, sizeof (size_t), state.n_callbacks,
+		 state.f) != state.n_callbacks
+      || fwrite (htabs, sizeof (size_t), reloc.n_htabs, state.f)
+	 != reloc.n_htabs)
+    fatal_error ("can't write PCH file: %m");
+  free (state.ptr_map);
+  free (state.callbacks);
+  free (htabs);
+  /* APPLE LOCAL end relocatable PCH */
+
   gt_pch_fixup_stringpool ();
 
   free (state.ptrs);
@@ -542,6 +719,12 @@ gt_pch_restore (FILE *f)
   size_t i;
   struct mmap_info mmi;
   int result;
+  /* APPLE LOCAL begin relocatable PCH */
+  struct pch_reloc_info reloc;
+  char *base;
+  ptrdiff_t bias;
+  size_t *htabs;
+  /* APPLE LOCAL end relocatable PCH */
 
   /* Delete any deletable objects.  This makes ggc_pch_read much
      faster, as it can be sure that no GCable objects remain other
@@ -574,22 +757,96 @@ gt_pch_restore (FILE *f)
   if (fread (&mmi, sizeof (mmi), 1, f) != 1)
     fatal_error ("can't read PCH file: %m");
 
-  result = host_hooks.gt_pch_use_address (mmi.preferred_base, mmi.size,
+  /* APPLE LOCAL begin relocatable PCH */
+  base = mmi.preferred_base;
+  result = host_hooks.gt_pch_use_address (base, mmi.size,
 					  fileno (f), mmi.offset);
+  /* If something else is there now, put the image wherever there is
+     room, and relocate it.  */
+  if (result < 0)
+    {
+      base = host_hooks.gt_pch_get_address (mmi.size, fileno (f));
+      if (base != NULL)
+	result = host_hooks.gt_pch_use_address (base, mmi.size,
+						fileno (f), mmi.offset);
+    }
   if (result < 0)
     fatal_error ("had to relocate PCH");
   if (result == 0)
     {
       if (fseek (f, mmi.offset, SEEK_SET) != 0
-	  || fread (mmi.preferred_base, mmi.size, 1, f) != 1)
+	  || fread (base, mmi.size, 1, f) != 1)
 	fatal_error ("can't read PCH file: %m");
     }
   else if (fseek (f, mmi.offset + mmi.size, SEEK_SET) != 0)
     fatal_error ("can't read PCH file: %m");
 
-  ggc_pch_read (f, mmi.preferred_base);
+  ggc_pch_read (f, base);
+
+  if (fread (&reloc, sizeof (reloc), 1, f) != 1)
+    fatal_error ("can't read PCH file: %m");
+
+  /* Adjust the pointers into the image, all at once, if it isn't
+     where it was meant to be.  */
+  bias = base - (char *) mmi.preferred_base;
+  if (bias != 0)
+    {
+      size_t n = PCH_PTR_MAP_LONGS (mmi.size);
+      unsigned long *map = XNEWVEC (unsigned long, n);
+
+      if (fread (map, sizeof (unsigned long), n, f) != n)
+	fatal_error ("can't read PCH file: %m");
+      for (i = 0; i < n; i++)
+	{
+	  unsigned long bits = map[i];
+	  char **word = (char **) base + i * HOST_BITS_PER_LONG;
+
+	  for (; bits != 0; bits >>= 1, word++)
+	    if (bits & 1)
+	      *word += bias;
+	}
+      free (map);
+
+      relocate_pch_globals (gt_ggc_rtab, bias);
+      relocate_pch_globals (gt_pch_cache_rtab, bias);
+    }
+  else if (fseek (f, PCH_PTR_MAP_LONGS (mmi.size) * sizeof (unsigned long),
+		  SEEK_CUR) != 0)
+    fatal_error ("can't read PCH file: %m");
+
+  /* Likewise the pointers into the executable, if it has moved.  */
+  bias = (char *) (size_t) gt_pch_save - (char *) (size_t) reloc.exec_addr;
+  if (bias != 0)
+    {
+      size_t *callbacks = XNEWVEC (size_t, reloc.n_callbacks);
+
+      if (fread (callbacks, sizeof (size_t), reloc.n_callbacks, f)
+	  != reloc.n_callbacks)
+	fatal_error ("can't read PCH file: %m");
+      for (i = 0; i < reloc.n_callbacks; i++)
+	*(char **) (base + callbacks[i]) += bias;
+      free (callbacks);
+    }
+  else if (fseek (f, reloc.n_callbacks * sizeof (size_t), SEEK_CUR) != 0)
+    fatal_error ("can't read PCH file: %m");
+
+  htabs = XNEWVEC (size_t, reloc.n_htabs);
+  if (fread (htabs, sizeof (size_t), reloc.n_htabs, f) != reloc.n_htabs)
+    fatal_error ("can't read PCH file: %m");
+  /* APPLE LOCAL end relocatable PCH */
 
   gt_pch_restore_stringpool ();
+
+  /* APPLE LOCAL begin relocatable PCH */
+  /* Many hash tables hash the addresses of the objects in them, which
+     are not where they were when the image was written, wherever it is
+     used.  Their hash functions may look at identifiers, so wait until
+     those are back.  */
+  for (i = 0; i < reloc.n_htabs; i++)
+    if (!htab_rehash ((htab_t) (base + htabs[i])))
+      fatal_error ("can't rehash hash table in PCH file");
+  free (htabs);
+  /* APPLE LOCAL end relocatable PCH */
 }
 
 /* Default version of HOST_HOOKS_GT_PCH_GET_ADDRESS when mmap is not present.
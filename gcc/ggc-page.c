@@ -75,6 +75,17 @@ Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA
 #define USING_MALLOC_PAGE_GROUPS
 #endif
 
+/* APPLE LOCAL begin generational ggc */
+/* The old generation is write-protected, which needs mmap'd pages and
+   the address of a faulting access.  */
+#ifdef USING_MMAP
+# include <signal.h>
+# ifdef SA_SIGINFO
+#  define GGC_GENERATIONAL
+# endif
+#endif
+/* APPLE LOCAL end generational ggc */
+
 /* Strategy:
 
    This garbage-collecting allocator allocates objects on one of a set
@@ -104,6 +115,28 @@ Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA
    deallocated at the start of the next collection if they haven't
    been recycled by then.  */
 
+/* APPLE LOCAL begin generational ggc */
+/* With --param ggc-full-expand=N, most collections are minor
+   collections, which only free objects allocated since the previous
+   collection; every object that survives a collection joins the old
+   generation, as do the objects of outer contexts, such as those read
+   from a PCH file.  A minor collection starts with old objects marked,
+   so that marking stops at them.  Old objects that point to young ones
+   must have been written to since the previous collection, and those
+   are found with the help of the system's memory protection.
+
+   At the end of each collection, when every object left is old, full
+   pages are write-protected a system page at a time.  The first write
+   to each of those system pages is caught in a signal handler, which
+   unprotects it.  A minor collection scans the old objects on every
+   unprotected system page, taking each word in them as a possible
+   pointer to a young object.  The young objects found this way are
+   marked and scanned in the same way.
+
+   A full collection happens when the heap has grown by N percent since
+   the last one.  */
+/* APPLE LOCAL end generational ggc */
+
 /* Define GGC_DEBUG_LEVEL to print debugging information.
      0: No debugging output.
      1: GC statistics only.
@@ -204,9 +237,42 @@ static const size_t extra_order_size_table[] = {
   RTL_SIZE (9),			/* INSN */
 };
 
+/* APPLE LOCAL begin ggc page kinds */
+/* Objects allocated with ggc_alloc_zone go on pages of their own kind,
+   so that rtl, trees and identifiers are neither mixed with each other
+   nor with other objects of the same size.  Each kind of page has its
+   own copy of the orders that small objects use.  */
+
+enum page_kind
+{
+  KIND_OTHER,
+  KIND_RTL,
+  KIND_TREE,
+  KIND_TREE_ID,
+  NUM_KINDS
+};
+
+struct alloc_zone
+{
+  enum page_kind kind;
+};
+
+struct alloc_zone rtl_zone = { KIND_RTL };
+struct alloc_zone tree_zone = { KIND_TREE };
+struct alloc_zone tree_id_zone = { KIND_TREE_ID };
+
+/* The number of orders of power-of-two sized objects in size_lookup,
+   and of the orders each kind other than KIND_OTHER has.  */
+#define NUM_SMALL_ORDERS 10
+#define NUM_KIND_ORDERS (NUM_SMALL_ORDERS + NUM_EXTRA_ORDERS)
+
+/* The number of orders for KIND_OTHER.  */
+#define NUM_BASE_ORDERS (HOST_BITS_PER_PTR + NUM_EXTRA_ORDERS)
+
 /* The total number of orders.  */
 
-#define NUM_ORDERS (HOST_BITS_PER_PTR + NUM_EXTRA_ORDERS)
+#define NUM_ORDERS (NUM_BASE_ORDERS + (NUM_KINDS - 1) * NUM_KIND_ORDERS)
+/* APPLE LOCAL end ggc page kinds */
 
 /* We use this structure to determine the alignment required for
    allocations.  For power-of-two sized allocations, that's not a
@@ -292,8 +358,32 @@ typedef struct page_entry
   unsigned short next_bit_hint;
 
   /* The lg of size of objects allocated from this page.  */
+  /* APPLE LOCAL ggc page kinds */
+  /* Orders past NUM_BASE_ORDERS are those of other kinds of pages.  */
   unsigned char order;
 
+  /* APPLE LOCAL begin lazy PCH */
+  /* Nonzero if this page was read from a PCH file and IN_USE_P has not
+     been filled in yet.  Every object on such a page is in use.  */
+  unsigned char pch_lazy_p;
+  /* APPLE LOCAL end lazy PCH */
+
+  /* APPLE LOCAL begin generational ggc */
+  /* During a minor collection, nonzero if this page has young objects
+     in use.  */
+  unsigned char gen_young;
+
+  /* A bit vector like IN_USE_P, of the objects that were in use at the
+     end of the last collection, and so are old; NULL if there were
+     none.  Not used for pages of outer contexts, all of whose objects
+     are old.  */
+  unsigned long *gen_old_p;
+
+  /* One byte for each system page, nonzero while that system page is
+     write-protected.  NULL if no part of this page is.  */
+  unsigned char *gen_cards;
+  /* APPLE LOCAL end generational ggc */
+
   /* A bit vector indicating whether or not objects are in use.  The
      Nth bit is one if the Nth object on this page is allocated.  This
      array is dynamically sized.  */
@@ -421,6 +511,67 @@ static struct globals
      better runtime data access pattern.  */
   unsigned long **save_in_use;
 
+  /* APPLE LOCAL begin lazy PCH */
+  /* The memory read from a PCH file, if any.  Page-table entries for
+     it are only set up when a page is first looked up.  */
+  char *pch_start;
+  char *pch_end;
+
+  /* The page_entry covering the objects of each order in that memory,
+     or NULL.  */
+  page_entry *pch_pages[NUM_ORDERS];
+  /* APPLE LOCAL end lazy PCH */
+
+  /* APPLE LOCAL begin ggc bump allocation */
+  /* For each order, the page last allocated for it, and the part of it
+     whose objects have not been handed out yet.  Those are handed out
+     in turn, from BUMP_NEXT up to BUMP_END.  All the objects on the
+     page are marked in use meanwhile; see bump_flush.  */
+  page_entry *bump_page[NUM_ORDERS];
+  char *bump_next[NUM_ORDERS];
+  char *bump_end[NUM_ORDERS];
+  /* APPLE LOCAL end ggc bump allocation */
+
+  /* APPLE LOCAL begin generational ggc */
+  /* Nonzero during a minor collection.  */
+  int minor_collection;
+
+  /* Bytes currently allocated at the end of the last full
+     collection.  */
+  size_t allocated_last_full;
+
+  /* Young objects reached from old pages, whose words are still to be
+     scanned.  */
+  char **gen_stack;
+  size_t gen_stack_depth;
+  size_t gen_stack_max;
+
+  /* One byte for each system page from GEN_YOUNG_START on, nonzero if
+     it belongs to a page with young objects.  This lets scanning pass
+     over most words quickly.  GEN_YOUNG_SIZE is the number of bytes,
+     and zero if those pages are too scattered for it to be
+     worthwhile.  */
+  unsigned char *gen_young_map;
+  char *gen_young_start;
+  size_t gen_young_size;
+
+  /* System pages whose protection is to be changed.  */
+  struct gen_card *gen_queue;
+  size_t gen_queue_count;
+  size_t gen_queue_max;
+
+#ifdef GGC_GENERATIONAL
+  /* The handlers that gen_fault_handler replaced.  */
+  struct sigaction gen_old_segv;
+  struct sigaction gen_old_bus;
+#endif
+  int gen_handler_installed;
+
+  unsigned long minor_collections;
+  unsigned long full_collections;
+  unsigned long gen_faults;
+  /* APPLE LOCAL end generational ggc */
+
 #ifdef ENABLE_GC_ALWAYS_COLLECT
   /* List of free objects to be verified as actually free on the
      next collection.  */
@@ -461,6 +612,15 @@ static struct globals
 #endif
 } G;
 
+/* APPLE LOCAL begin generational ggc */
+/* A system page at ADDR in ENTRY.  */
+struct gen_card
+{
+  char *addr;
+  page_entry *entry;
+};
+/* APPLE LOCAL end generational ggc */
+
 /* The size in bytes required to maintain a bitmap for the objects
    on a page-entry.  */
 #define BITMAP_SIZE(Num_objects) \
@@ -484,6 +644,10 @@ static struct globals
 
 static int ggc_allocated_p (const void *);
 static page_entry *lookup_page_table_entry (const void *);
+/* APPLE LOCAL begin lazy PCH */
+static page_entry *lookup_pch_page (const void *);
+static void fill_pch_in_use_p (page_entry *);
+/* APPLE LOCAL end lazy PCH */
 static void set_page_table_entry (void *, page_entry *);
 #ifdef USING_MMAP
 static char *alloc_anon (char *, size_t);
@@ -498,6 +662,36 @@ static void free_page (struct page_entry *);
 static void release_pages (void);
 static void clear_marks (void);
 static void sweep_pages (void);
+/* APPLE LOCAL begin ggc bump allocation */
+static void *ggc_alloc_order (size_t, size_t MEM_STAT_DECL);
+static void bump_flush (unsigned);
+static void bump_flush_all (void);
+/* APPLE LOCAL end ggc bump allocation */
+/* APPLE LOCAL begin generational ggc */
+#ifdef GGC_GENERATIONAL
+static page_entry *gen_lookup (const void *);
+static void gen_fault_handler (int, siginfo_t *, void *);
+static void gen_alloc_cards (page_entry *);
+static void gen_free_cards (page_entry *);
+static void gen_queue_card (page_entry *, size_t);
+static void gen_set_protection (int);
+static page_entry *gen_young_object (const void *, size_t *);
+static void gen_scan_words (const char *, const char *);
+static void gen_scan_old_page (page_entry *, const unsigned long *);
+static void gen_map_young (void);
+static void gen_scan_old (void);
+static int gen_minor_p (void);
+static void gen_reset (void);
+static void gen_promote (void);
+#else
+#define gen_free_cards(P)
+#define gen_scan_old()
+#define gen_minor_p() 0
+#define gen_reset()
+#define gen_promote()
+#define gen_set_protection(PROT)
+#endif
+/* APPLE LOCAL end generational ggc */
 static void ggc_recalculate_in_use_p (page_entry *);
 static void compute_inverse (unsigned);
 static inline void adjust_depth (void);
@@ -556,6 +750,11 @@ ggc_allocated_p (const void *p)
   page_entry ***base;
   size_t L1, L2;
 
+  /* APPLE LOCAL begin lazy PCH */
+  if ((const char *) p >= G.pch_start && (const char *) p < G.pch_end)
+    return 1;
+  /* APPLE LOCAL end lazy PCH */
+
 #if HOST_BITS_PER_PTR <= 32
   base = &G.lookup[0];
 #else
@@ -593,8 +792,12 @@ lookup_page_table_entry (const void *p)
 #else
   page_table table = G.lookup;
   size_t high_bits = (size_t) p & ~ (size_t) 0xffffffff;
-  while (table->high_bits != high_bits)
+  /* APPLE LOCAL begin lazy PCH */
+  while (table && table->high_bits != high_bits)
     table = table->next;
+  if (! table)
+    return lookup_pch_page (p);
+  /* APPLE LOCAL end lazy PCH */
   base = &table->table[0];
 #endif
 
@@ -602,6 +805,10 @@ lookup_page_table_entry (const void *p)
   L1 = LOOKUP_L1 (p);
   L2 = LOOKUP_L2 (p);
 
+  /* APPLE LOCAL begin lazy PCH */
+  if (! base[L1] || ! base[L1][L2])
+    return lookup_pch_page (p);
+  /* APPLE LOCAL end lazy PCH */
   return base[L1][L2];
 }
 
@@ -641,6 +848,56 @@ found:
   base[L1][L2] = entry;
 }
 
+/* APPLE LOCAL begin lazy PCH */
+/* P has no page-table entry yet.  If it lies in the memory read from a
+   PCH file, set one up for its page and return it; otherwise return
+   NULL.  */
+
+static page_entry *
+lookup_pch_page (const void *p)
+{
+  unsigned order;
+
+  if ((const char *) p < G.pch_start || (const char *) p >= G.pch_end)
+    return NULL;
+
+  for (order = 0; order < NUM_ORDERS; order++)
+    {
+      page_entry *entry = G.pch_pages[order];
+
+      if (entry
+	  && (const char *) p >= entry->page
+	  && (const char *) p < entry->page + entry->bytes)
+	{
+	  size_t offset = ((const char *) p - entry->page) & ~(G.pagesize - 1);
+	  set_page_table_entry (entry->page + offset, entry);
+	  return entry;
+	}
+    }
+
+  return NULL;
+}
+
+/* Fill in the in-use bitmap of ENTRY, a page read from a PCH file.  */
+
+static void
+fill_pch_in_use_p (page_entry *entry)
+{
+  size_t num_objs = OBJECTS_IN_PAGE (entry);
+  size_t j;
+
+  for (j = 0;
+       j + HOST_BITS_PER_LONG <= num_objs + 1;
+       j += HOST_BITS_PER_LONG)
+    entry->in_use_p[j / HOST_BITS_PER_LONG] = -1;
+  for (; j < num_objs + 1; j++)
+    entry->in_use_p[j / HOST_BITS_PER_LONG]
+      |= 1L << (j % HOST_BITS_PER_LONG);
+
+  entry->pch_lazy_p = 0;
+}
+/* APPLE LOCAL end lazy PCH */
+
 /* Prints the page-entry for object size ORDER, for debugging.  */
 
 void
@@ -935,6 +1192,15 @@ free_page (page_entry *entry)
      leak.  */
   VALGRIND_DISCARD (VALGRIND_MAKE_NOACCESS (entry->page, entry->bytes));
 
+  /* APPLE LOCAL begin generational ggc */
+  gen_free_cards (entry);
+  free (entry->gen_old_p);
+  entry->gen_old_p = NULL;
+  /* A minor collection backs up the in-use bits of pages in the
+     topmost context too, and the slot is about to be reused.  */
+  free (save_in_use_p (entry));
+  save_in_use_p (entry) = NULL;
+  /* APPLE LOCAL end generational ggc */
   set_page_table_entry (entry->page, NULL);
 
 #ifdef USING_MALLOC_PAGE_GROUPS
@@ -1066,6 +1332,11 @@ static unsigned char size_lookup[NUM_SIZE_LOOKUP] =
   9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9
 };
 
+/* APPLE LOCAL begin ggc page kinds */
+/* Like size_lookup, for each kind of page but KIND_OTHER.  */
+static unsigned char kind_size_lookup[NUM_KINDS - 1][NUM_SIZE_LOOKUP];
+/* APPLE LOCAL end ggc page kinds */
+
 /* Typed allocation function.  Does nothing special in this collector.  */
 
 void *
@@ -1075,27 +1346,63 @@ ggc_alloc_typed_stat (enum gt_types_enum type ATTRIBUTE_UNUSED, size_t size
   return ggc_alloc_stat (size PASS_MEM_STAT);
 }
 
+/* APPLE LOCAL begin ggc bump allocation */
 /* Allocate a chunk of memory of SIZE bytes.  Its contents are undefined.  */
 
 void *
 ggc_alloc_stat (size_t size MEM_STAT_DECL)
 {
-  size_t order, word, bit, object_offset, object_size;
-  struct page_entry *entry;
-  void *result;
+  size_t order;
 
   if (size < NUM_SIZE_LOOKUP)
-    {
-      order = size_lookup[size];
-      object_size = OBJECT_SIZE (order);
-    }
+    order = size_lookup[size];
   else
     {
       order = 10;
-      while (size > (object_size = OBJECT_SIZE (order)))
+      while (size > OBJECT_SIZE (order))
 	order++;
     }
 
+  return ggc_alloc_order (order, size PASS_MEM_STAT);
+}
+/* APPLE LOCAL end ggc bump allocation */
+
+/* APPLE LOCAL begin ggc page kinds */
+/* Allocate a chunk of memory of SIZE bytes on a page of ZONE's kind.
+   Its contents are undefined.  */
+
+void *
+ggc_alloc_zone_stat (size_t size, struct alloc_zone *zone MEM_STAT_DECL)
+{
+  if (size < NUM_SIZE_LOOKUP && zone->kind != KIND_OTHER)
+    return ggc_alloc_order (kind_size_lookup[zone->kind - 1][size], size
+			    PASS_MEM_STAT);
+
+  return ggc_alloc_stat (size PASS_MEM_STAT);
+}
+/* APPLE LOCAL end ggc page kinds */
+
+/* APPLE LOCAL begin ggc bump allocation */
+/* Allocate a chunk of memory of SIZE bytes on a page of ORDER.  */
+
+static inline void *
+ggc_alloc_order (size_t order, size_t size MEM_STAT_DECL)
+{
+  size_t word, bit, object_offset, object_size;
+  struct page_entry *entry;
+  void *result;
+
+  object_size = OBJECT_SIZE (order);
+
+  /* Most objects come from the last page allocated.  */
+  if (G.bump_next[order] != G.bump_end[order])
+    {
+      entry = G.bump_page[order];
+      result = G.bump_next[order];
+      G.bump_next[order] += object_size;
+      goto allocated;
+    }
+
   /* If there are non-full pages for this size allocation, they are at
      the head of the list.  */
   entry = G.pages[order];
@@ -1104,6 +1411,7 @@ ggc_alloc_stat (size_t size MEM_STAT_DECL)
      context are full, allocate a new page.  */
   if (entry == NULL || entry->num_free_objects == 0)
     {
+      size_t num_objects;
       struct page_entry *new_entry;
       new_entry = alloc_page (order);
 
@@ -1130,12 +1438,24 @@ ggc_alloc_stat (size_t size MEM_STAT_DECL)
       entry = new_entry;
       G.pages[order] = new_entry;
 
-      /* For a new page, we know the word and bit positions (in the
-	 in_use bitmap) of the first available object -- they're zero.  */
-      new_entry->next_bit_hint = 1;
-      word = 0;
-      bit = 0;
-      object_offset = 0;
+      /* Hand out the objects on the new page in turn, starting with the
+	 first.  Mark them all in use now, sentry bit included; those
+	 still unused when someone else looks at the bitmap are freed
+	 by bump_flush.  */
+      num_objects = OBJECTS_IN_PAGE (entry);
+      memset (entry->in_use_p, 0xff,
+	      (num_objects + 1) / HOST_BITS_PER_LONG * sizeof (long));
+      if ((num_objects + 1) % HOST_BITS_PER_LONG)
+	entry->in_use_p[(num_objects + 1) / HOST_BITS_PER_LONG]
+	  = ((unsigned long) 1 << ((num_objects + 1) % HOST_BITS_PER_LONG)) - 1;
+      entry->num_free_objects = 0;
+
+      G.bump_page[order] = entry;
+      G.bump_next[order] = entry->page + object_size;
+      G.bump_end[order] = entry->page + num_objects * object_size;
+
+      result = entry->page;
+      goto allocated;
     }
   else
     {
@@ -1198,6 +1518,8 @@ ggc_alloc_stat (size_t size MEM_STAT_DECL)
 
   /* Calculate the object's address.  */
   result = entry->page + object_offset;
+
+ allocated:
 #ifdef GATHER_STATISTICS
   ggc_record_overhead (OBJECT_SIZE (order), OBJECT_SIZE (order) - size,
 		       result PASS_MEM_STAT);
@@ -1268,6 +1590,43 @@ ggc_alloc_stat (size_t size MEM_STAT_DECL)
   return result;
 }
 
+/* Give back the objects on the page last allocated for ORDER that have
+   not been handed out, so that its bitmap and count of free objects
+   are right.  */
+
+static void
+bump_flush (unsigned order)
+{
+  page_entry *p = G.bump_page[order];
+  size_t num_objects, i;
+
+  if (p == NULL)
+    return;
+
+  num_objects = OBJECTS_IN_PAGE (p);
+  i = (G.bump_next[order] - p->page) / OBJECT_SIZE (order);
+  p->num_free_objects = num_objects - i;
+  p->next_bit_hint = i;
+  for (; i < num_objects; i++)
+    p->in_use_p[i / HOST_BITS_PER_LONG]
+      &= ~((unsigned long) 1 << (i % HOST_BITS_PER_LONG));
+
+  G.bump_page[order] = NULL;
+  G.bump_next[order] = G.bump_end[order] = NULL;
+}
+
+/* Likewise for every order.  */
+
+static void
+bump_flush_all (void)
+{
+  unsigned order;
+
+  for (order = 0; order < NUM_ORDERS; order++)
+    bump_flush (order);
+}
+/* APPLE LOCAL end ggc bump allocation */
+
 /* If P is not marked, marks it and return false.  Otherwise return true.
    P must have been allocated by the GC allocator; it mustn't point to
    static objects, stack variables, or memory allocated with malloc.  */
@@ -1284,6 +1643,13 @@ ggc_set_mark (const void *p)
   entry = lookup_page_table_entry (p);
   gcc_assert (entry);
 
+  /* APPLE LOCAL begin generational ggc */
+  /* Only a minor collection leaves a PCH page's bitmap unfilled, and
+     then its objects are old, and so marked.  */
+  if (entry->pch_lazy_p)
+    return 1;
+  /* APPLE LOCAL end generational ggc */
+
   /* Calculate the index of the object on the page; this is its bit
      position in the in_use_p bitmap.  */
   bit = OFFSET_TO_BIT (((const char *) p) - entry->page, entry->order);
@@ -1320,6 +1686,12 @@ ggc_marked_p (const void *p)
   entry = lookup_page_table_entry (p);
   gcc_assert (entry);
 
+  /* APPLE LOCAL begin lazy PCH */
+  /* Outside a collection, an untouched PCH page is entirely in use.  */
+  if (entry->pch_lazy_p)
+    return 1;
+  /* APPLE LOCAL end lazy PCH */
+
   /* Calculate the index of the object on the page; this is its bit
      position in the in_use_p bitmap.  */
   bit = OFFSET_TO_BIT (((const char *) p) - entry->page, entry->order);
@@ -1380,11 +1752,25 @@ ggc_free (void *p)
 
     G.allocated -= size;
 
+    /* APPLE LOCAL begin ggc bump allocation */
+    if (pe == G.bump_page[order])
+      bump_flush (order);
+    /* APPLE LOCAL end ggc bump allocation */
+
+    /* APPLE LOCAL begin lazy PCH */
+    if (pe->pch_lazy_p)
+      fill_pch_in_use_p (pe);
+    /* APPLE LOCAL end lazy PCH */
+
     /* Mark the object not-in-use.  */
     bit_offset = OFFSET_TO_BIT (((const char *) p) - pe->page, order);
     word = bit_offset / HOST_BITS_PER_LONG;
     bit = bit_offset % HOST_BITS_PER_LONG;
     pe->in_use_p[word] &= ~(1UL << bit);
+    /* APPLE LOCAL begin generational ggc */
+    if (pe->gen_old_p)
+      pe->gen_old_p[word] &= ~(1UL << bit);
+    /* APPLE LOCAL end generational ggc */
 
     if (pe->num_free_objects++ == 0)
       {
@@ -1461,6 +1847,8 @@ void
 init_ggc (void)
 {
   unsigned order;
+  /* APPLE LOCAL ggc page kinds */
+  unsigned kind, i;
 
   G.pagesize = getpagesize();
   G.lg_pagesize = exact_log2 (G.pagesize);
@@ -1506,7 +1894,8 @@ init_ggc (void)
   /* Initialize the object size table.  */
   for (order = 0; order < HOST_BITS_PER_PTR; ++order)
     object_size_table[order] = (size_t) 1 << order;
-  for (order = HOST_BITS_PER_PTR; order < NUM_ORDERS; ++order)
+  /* APPLE LOCAL ggc page kinds */
+  for (order = HOST_BITS_PER_PTR; order < NUM_BASE_ORDERS; ++order)
     {
       size_t s = extra_order_size_table[order - HOST_BITS_PER_PTR];
 
@@ -1516,6 +1905,21 @@ init_ggc (void)
       object_size_table[order] = s;
     }
 
+  /* APPLE LOCAL begin ggc page kinds */
+  /* The orders of each other kind of page come after those, first the
+     small power-of-two sizes and then the extra ones.  */
+  for (order = NUM_BASE_ORDERS; order < NUM_ORDERS; ++order)
+    {
+      unsigned o = (order - NUM_BASE_ORDERS) % NUM_KIND_ORDERS;
+
+      if (o < NUM_SMALL_ORDERS)
+	object_size_table[order] = OBJECT_SIZE (o);
+      else
+	object_size_table[order]
+	  = OBJECT_SIZE (HOST_BITS_PER_PTR + o - NUM_SMALL_ORDERS);
+    }
+  /* APPLE LOCAL end ggc page kinds */
+
   /* Initialize the objects-per-page and inverse tables.  */
   for (order = 0; order < NUM_ORDERS; ++order)
     {
@@ -1529,7 +1933,8 @@ init_ggc (void)
      the special orders.  All objects bigger than the previous power
      of two, but no greater than the special size, should go in the
      new order.  */
-  for (order = HOST_BITS_PER_PTR; order < NUM_ORDERS; ++order)
+  /* APPLE LOCAL ggc page kinds */
+  for (order = HOST_BITS_PER_PTR; order < NUM_BASE_ORDERS; ++order)
     {
       int o;
       int i;
@@ -1542,6 +1947,19 @@ init_ggc (void)
 	size_lookup[i] = order;
     }
 
+  /* APPLE LOCAL begin ggc page kinds */
+  for (kind = 1; kind < NUM_KINDS; kind++)
+    for (i = 0; i < NUM_SIZE_LOOKUP; i++)
+      {
+	unsigned o = size_lookup[i];
+
+	if (o >= HOST_BITS_PER_PTR)
+	  o = o - HOST_BITS_PER_PTR + NUM_SMALL_ORDERS;
+	kind_size_lookup[kind - 1][i]
+	  = NUM_BASE_ORDERS + (kind - 1) * NUM_KIND_ORDERS + o;
+      }
+  /* APPLE LOCAL end ggc page kinds */
+
   G.depth_in_use = 0;
   G.depth_max = 10;
   G.depth = XNEWVEC (unsigned int, G.depth_max);
@@ -1621,16 +2039,51 @@ clear_marks (void)
 	  /* The data should be page-aligned.  */
 	  gcc_assert (!((size_t) p->page & (G.pagesize - 1)));
 
+	  /* APPLE LOCAL begin generational ggc */
+	  /* A minor collection leaves pages of outer contexts alone.  */
+	  if (G.minor_collection && p->context_depth < G.context_depth)
+	    continue;
+	  /* APPLE LOCAL end generational ggc */
+
+	  /* APPLE LOCAL begin lazy PCH */
+	  if (p->pch_lazy_p)
+	    fill_pch_in_use_p (p);
+	  /* APPLE LOCAL end lazy PCH */
+
 	  /* Pages that aren't in the topmost context are not collected;
 	     nevertheless, we need their in-use bit vectors to store GC
 	     marks.  So, back them up first.  */
-	  if (p->context_depth < G.context_depth)
+	  /* APPLE LOCAL begin generational ggc */
+	  /* A minor collection backs up the others too, to tell objects in
+	     use from free ones when scanning old objects.  */
+	  if (p->context_depth < G.context_depth || G.minor_collection)
 	    {
 	      if (! save_in_use_p (p))
 		save_in_use_p (p) = xmalloc (bitmap_size);
 	      memcpy (save_in_use_p (p), p->in_use_p, bitmap_size);
 	    }
 
+	  /* In a minor collection, old objects start out marked.  */
+	  if (G.minor_collection && p->gen_old_p)
+	    {
+	      size_t i;
+	      unsigned long j;
+
+	      memcpy (p->in_use_p, p->gen_old_p, bitmap_size);
+	      p->num_free_objects = num_objects + 1;
+	      p->gen_young = 0;
+	      for (i = 0; i < bitmap_size / sizeof (long); i++)
+		{
+		  for (j = p->gen_old_p[i]; j; j &= j - 1)
+		    p->num_free_objects--;
+		  if (save_in_use_p (p)[i] & ~p->gen_old_p[i])
+		    p->gen_young = 1;
+		}
+	      continue;
+	    }
+	  p->gen_young = G.minor_collection;
+	  /* APPLE LOCAL end generational ggc */
+
 	  /* Reset reset the number of free objects and clear the
              in-use bits.  These will be adjusted by mark_obj.  */
 	  p->num_free_objects = num_objects;
@@ -1770,9 +2223,13 @@ sweep_pages (void)
 
       /* Now, restore the in_use_p vectors for any pages from contexts
          other than the current one.  */
-      for (p = G.pages[order]; p; p = p->next)
-	if (p->context_depth != G.context_depth)
-	  ggc_recalculate_in_use_p (p);
+      /* APPLE LOCAL begin generational ggc */
+      /* A minor collection did not touch them.  */
+      if (! G.minor_collection)
+	for (p = G.pages[order]; p; p = p->next)
+	  if (p->context_depth != G.context_depth)
+	    ggc_recalculate_in_use_p (p);
+      /* APPLE LOCAL end generational ggc */
     }
 }
 
@@ -1869,6 +2326,522 @@ validate_free_objects (void)
 #define validate_free_objects()
 #endif
 
+/* APPLE LOCAL begin generational ggc */
+#ifdef GGC_GENERATIONAL
+/* Like lookup_page_table_entry, but return NULL for memory that the
+   collector does not manage, and never allocate, since the fault
+   handler uses this.  */
+
+static page_entry *
+gen_lookup (const void *p)
+{
+  page_entry ***base;
+  size_t L1, L2;
+  unsigned order;
+
+#if HOST_BITS_PER_PTR <= 32
+  base = &G.lookup[0];
+#else
+  page_table table = G.lookup;
+  size_t high_bits = (size_t) p & ~ (size_t) 0xffffffff;
+  while (table && table->high_bits != high_bits)
+    table = table->next;
+  base = table ? &table->table[0] : NULL;
+#endif
+
+  /* Extract the level 1 and 2 indices.  */
+  L1 = LOOKUP_L1 (p);
+  L2 = LOOKUP_L2 (p);
+
+  if (base && base[L1] && base[L1][L2])
+    return base[L1][L2];
+
+  /* The pages read from a PCH file might not have page-table entries
+     yet.  */
+  if ((const char *) p >= G.pch_start && (const char *) p < G.pch_end)
+    for (order = 0; order < NUM_ORDERS; order++)
+      {
+	page_entry *entry = G.pch_pages[order];
+
+	if (entry
+	    && (const char *) p >= entry->page
+	    && (const char *) p < entry->page + entry->bytes)
+	  return entry;
+      }
+
+  return NULL;
+}
+
+/* Handle a fault at INFO->si_addr.  If it is the first write to a
+   protected system page of the old generation, unprotect that page and
+   note that it must be scanned at the next minor collection.  */
+
+static void
+gen_fault_handler (int sig, siginfo_t *info, void *context ATTRIBUTE_UNUSED)
+{
+  char *addr = (char *) info->si_addr;
+  page_entry *p = gen_lookup (addr);
+
+  if (p && p->gen_cards)
+    {
+      size_t card = (addr - p->page) >> G.lg_pagesize;
+
+      if (p->gen_cards[card]
+	  && mprotect (p->page + (card << G.lg_pagesize), G.pagesize,
+		       PROT_READ | PROT_WRITE) == 0)
+	{
+	  p->gen_cards[card] = 0;
+	  G.gen_faults++;
+	  return;
+	}
+    }
+
+  /* Anything else is a real fault.  Put back the handler we replaced,
+     and let the access fault again.  */
+#ifdef SIGBUS
+  if (sig == SIGBUS)
+    sigaction (sig, &G.gen_old_bus, NULL);
+  else
+#endif
+    sigaction (sig, &G.gen_old_segv, NULL);
+}
+
+/* Give P its array of cards.  */
+
+static void
+gen_alloc_cards (page_entry *p)
+{
+  size_t num_cards = p->bytes >> G.lg_pagesize;
+  size_t i;
+
+  p->gen_cards = XCNEWVEC (unsigned char, num_cards);
+
+  /* Let the fault handler find P from any of its system pages.  Those
+     of a PCH file are found without.  */
+  if (p->page < G.pch_start || p->page >= G.pch_end)
+    for (i = 1; i < num_cards; i++)
+      set_page_table_entry (p->page + (i << G.lg_pagesize), p);
+}
+
+/* Make all of P writable and free its array of cards.  */
+
+static void
+gen_free_cards (page_entry *p)
+{
+  size_t num_cards = p->bytes >> G.lg_pagesize;
+  size_t i;
+
+  if (! p->gen_cards)
+    return;
+
+  for (i = 0; i < num_cards; i++)
+    if (p->gen_cards[i])
+      {
+	if (mprotect (p->page, p->bytes, PROT_READ | PROT_WRITE) != 0)
+	  internal_error ("mprotect: %m");
+	break;
+      }
+
+  if (p->page < G.pch_start || p->page >= G.pch_end)
+    for (i = 1; i < num_cards; i++)
+      set_page_table_entry (p->page + (i << G.lg_pagesize), NULL);
+
+  free (p->gen_cards);
+  p->gen_cards = NULL;
+}
+
+/* Queue system page CARD of P to have its protection changed by
+   gen_set_protection.  */
+
+static void
+gen_queue_card (page_entry *p, size_t card)
+{
+  if (G.gen_queue_count == G.gen_queue_max)
+    {
+      G.gen_queue_max = G.gen_queue_max * 2 + 256;
+      G.gen_queue = XRESIZEVEC (struct gen_card, G.gen_queue,
+				G.gen_queue_max);
+    }
+
+  G.gen_queue[G.gen_queue_count].addr = p->page + (card << G.lg_pagesize);
+  G.gen_queue[G.gen_queue_count].entry = p;
+  G.gen_queue_count++;
+}
+
+/* qsort comparison function for struct gen_card.  */
+
+static int
+gen_card_cmp (const void *a, const void *b)
+{
+  const char *x = ((const struct gen_card *) a)->addr;
+  const char *y = ((const struct gen_card *) b)->addr;
+
+  return x < y ? -1 : x > y;
+}
+
+/* Give the queued system pages protection PROT, PROT_READ or
+   PROT_READ | PROT_WRITE, and empty the queue.  Adjacent pages are
+   done together.  */
+
+static void
+gen_set_protection (int prot)
+{
+  size_t i, j, k;
+
+  if (G.gen_queue_count == 0)
+    return;
+
+  if (prot == PROT_READ && ! G.gen_handler_installed)
+    {
+      struct sigaction sa;
+
+      memset (&sa, 0, sizeof (sa));
+      sa.sa_sigaction = gen_fault_handler;
+      sa.sa_flags = SA_SIGINFO;
+      sigemptyset (&sa.sa_mask);
+      sigaction (SIGSEGV, &sa, &G.gen_old_segv);
+#ifdef SIGBUS
+      /* Some systems raise this instead for a write to a protected
+	 page.  */
+      sigaction (SIGBUS, &sa, &G.gen_old_bus);
+#endif
+      G.gen_handler_installed = 1;
+    }
+
+  qsort (G.gen_queue, G.gen_queue_count, sizeof (struct gen_card),
+	 gen_card_cmp);
+
+  for (i = 0; i < G.gen_queue_count; i = j)
+    {
+      for (j = i + 1;
+	   j < G.gen_queue_count
+	   && G.gen_queue[j].addr == G.gen_queue[j - 1].addr + G.pagesize;
+	   j++)
+	;
+
+      if (mprotect (G.gen_queue[i].addr, (j - i) << G.lg_pagesize, prot) != 0)
+	{
+	  /* The system may be unable to split its mappings any further.
+	     Pages left writable are just scanned at every minor
+	     collection.  */
+	  if (prot != PROT_READ)
+	    internal_error ("mprotect: %m");
+	  continue;
+	}
+
+      for (k = i; k < j; k++)
+	{
+	  page_entry *p = G.gen_queue[k].entry;
+	  p->gen_cards[(G.gen_queue[k].addr - p->page) >> G.lg_pagesize]
+	    = (prot == PROT_READ);
+	}
+    }
+
+  G.gen_queue_count = 0;
+}
+
+/* If PTR points to a young object, return its page and set *INDEX to
+   its index there.  Otherwise return NULL.  Young objects are on pages
+   of the topmost context, were in use when the collection started, and
+   are not old.  */
+
+static page_entry *
+gen_young_object (const void *ptr, size_t *index)
+{
+  page_entry *p = gen_lookup (ptr);
+  size_t i, word;
+  unsigned long mask;
+
+  if (p == NULL || ! p->gen_young)
+    return NULL;
+
+  i = (size_t) ((const char *) ptr - p->page) / OBJECT_SIZE (p->order);
+  if (i >= OBJECTS_IN_PAGE (p))
+    return NULL;
+
+  word = i / HOST_BITS_PER_LONG;
+  mask = (unsigned long) 1 << (i % HOST_BITS_PER_LONG);
+  if (! (save_in_use_p (p)[word] & mask)
+      || (p->gen_old_p && (p->gen_old_p[word] & mask)))
+    return NULL;
+
+  *index = i;
+  return p;
+}
+
+/* Mark every young object that a word from START to END might point
+   to, and push those not already marked to be scanned in turn.  Only
+   the aligned words that lie wholly in the range are read, so objects
+   smaller than a pointer are skipped, and nothing past the end of a
+   page is touched.  */
+
+static void
+gen_scan_words (const char *start, const char *end)
+{
+  const void *const *w;
+
+  w = (const void *const *) (((size_t) start + sizeof (void *) - 1)
+			     & -(size_t) sizeof (void *));
+  for (; (const char *) (w + 1) <= end; w++)
+    if (*w)
+      {
+	size_t offset = (const char *) *w - G.gen_young_start;
+	page_entry *p;
+	size_t i;
+	unsigned long mask;
+
+	if (G.gen_young_size
+	    && (offset >> G.lg_pagesize >= G.gen_young_size
+		|| ! G.gen_young_map[offset >> G.lg_pagesize]))
+	  continue;
+
+	p = gen_young_object (*w, &i);
+	if (p == NULL)
+	  continue;
+
+	mask = (unsigned long) 1 << (i % HOST_BITS_PER_LONG);
+	if (p->in_use_p[i / HOST_BITS_PER_LONG] & mask)
+	  continue;
+
+	p->in_use_p[i / HOST_BITS_PER_LONG] |= mask;
+	p->num_free_objects -= 1;
+
+	if (G.gen_stack_depth == G.gen_stack_max)
+	  {
+	    G.gen_stack_max = G.gen_stack_max * 2 + 256;
+	    G.gen_stack = XRESIZEVEC (char *, G.gen_stack, G.gen_stack_max);
+	  }
+	G.gen_stack[G.gen_stack_depth++] = p->page + i * OBJECT_SIZE (p->order);
+      }
+}
+
+/* Scan the old objects of P on the system pages that have been written
+   to since they were last protected, and the young objects they lead
+   to.  OLD is the bit vector of P's old objects, or NULL if all the
+   objects on P are to be scanned.  */
+
+static void
+gen_scan_old_page (page_entry *p, const unsigned long *old)
+{
+  size_t size = OBJECT_SIZE (p->order);
+  size_t num_objects = OBJECTS_IN_PAGE (p);
+  size_t num_cards = p->bytes >> G.lg_pagesize;
+  size_t card;
+
+  /* Objects smaller than a pointer can't hold one.  */
+  if (size < sizeof (void *))
+    return;
+
+  for (card = 0; card < num_cards; card++)
+    {
+      char *start = p->page + (card << G.lg_pagesize);
+      char *end = start + G.pagesize;
+      size_t i;
+
+      if (p->gen_cards && p->gen_cards[card])
+	continue;
+
+      for (i = (start - p->page) / size;
+	   i < num_objects && p->page + i * size < end;
+	   i++)
+	if (old == NULL
+	    || ((old[i / HOST_BITS_PER_LONG] >> (i % HOST_BITS_PER_LONG)) & 1))
+	  {
+	    char *object = p->page + i * size;
+	    gen_scan_words (MAX (object, start), MIN (object + size, end));
+	  }
+
+      while (G.gen_stack_depth)
+	{
+	  char *object = G.gen_stack[--G.gen_stack_depth];
+	  page_entry *q = gen_lookup (object);
+	  gen_scan_words (object, object + OBJECT_SIZE (q->order));
+	}
+    }
+}
+
+/* Set up G.gen_young_map for the pages with young objects.  */
+
+static void
+gen_map_young (void)
+{
+  char *start = NULL, *end = NULL;
+  unsigned order;
+  page_entry *p;
+
+  for (order = 2; order < NUM_ORDERS; order++)
+    for (p = G.pages[order]; p != NULL; p = p->next)
+      if (p->gen_young)
+	{
+	  if (start == NULL || p->page < start)
+	    start = p->page;
+	  if (end == NULL || p->page + p->bytes > end)
+	    end = p->page + p->bytes;
+	}
+
+  G.gen_young_start = start;
+  G.gen_young_size = (end - start) >> G.lg_pagesize;
+
+  /* Past a byte for each 256 bytes of the heap, say, the map is more
+     trouble than it is worth.  */
+  if (G.gen_young_size == 0
+      || G.gen_young_size > (G.allocated_last_gc >> 8) + 65536)
+    {
+      G.gen_young_size = 0;
+      return;
+    }
+
+  G.gen_young_map = XRESIZEVEC (unsigned char, G.gen_young_map,
+				G.gen_young_size);
+  memset (G.gen_young_map, 0, G.gen_young_size);
+  for (order = 2; order < NUM_ORDERS; order++)
+    for (p = G.pages[order]; p != NULL; p = p->next)
+      if (p->gen_young)
+	memset (G.gen_young_map + ((p->page - start) >> G.lg_pagesize), 1,
+		p->bytes >> G.lg_pagesize);
+}
+
+/* In a minor collection, mark the young objects reachable from old
+   objects on the unprotected parts of the heap.  */
+
+static void
+gen_scan_old (void)
+{
+  unsigned order;
+
+  if (! G.minor_collection)
+    return;
+
+  gen_map_young ();
+
+  for (order = 2; order < NUM_ORDERS; order++)
+    {
+      page_entry *p;
+
+      for (p = G.pages[order]; p != NULL; p = p->next)
+	if (p->context_depth < G.context_depth)
+	  gen_scan_old_page (p, p->pch_lazy_p ? NULL : p->in_use_p);
+	else if (p->gen_old_p)
+	  gen_scan_old_page (p, p->gen_old_p);
+    }
+}
+
+/* Return nonzero if the collection about to start should be a minor
+   one: generational collection is on, a full collection has started
+   the old generation, and the heap has not grown by ggc-full-expand
+   percent since the last one.  */
+
+static int
+gen_minor_p (void)
+{
+#ifdef ENABLE_GC_ALWAYS_COLLECT
+  /* validate_free_objects wants to see freed old objects unmarked.  */
+  return 0;
+#else
+  float allocated_last_full;
+  int full_expand = PARAM_VALUE (GGC_FULL_EXPAND);
+
+  if (full_expand == 0 || ggc_force_collect || G.full_collections == 0)
+    return 0;
+
+  allocated_last_full =
+    MAX (G.allocated_last_full,
+	 (size_t) PARAM_VALUE (GGC_MIN_HEAPSIZE) * 1024);
+
+  return (G.allocated_last_gc
+	  < allocated_last_full + allocated_last_full * full_expand / 100);
+#endif
+}
+
+/* Make the whole heap writable again and forget the old generation,
+   before reading a PCH file.  */
+
+static void
+gen_reset (void)
+{
+  unsigned order;
+  page_entry *p;
+
+  for (order = 2; order < NUM_ORDERS; order++)
+    for (p = G.pages[order]; p != NULL; p = p->next)
+      if (p->gen_cards)
+	{
+	  size_t num_cards = p->bytes >> G.lg_pagesize;
+	  size_t card;
+
+	  for (card = 0; card < num_cards; card++)
+	    if (p->gen_cards[card])
+	      gen_queue_card (p, card);
+	}
+
+  gen_set_protection (PROT_READ | PROT_WRITE);
+
+  for (order = 2; order < NUM_ORDERS; order++)
+    for (p = G.pages[order]; p != NULL; p = p->next)
+      {
+	gen_free_cards (p);
+	free (p->gen_old_p);
+	p->gen_old_p = NULL;
+      }
+}
+
+/* After a collection, make every object in use in the topmost context
+   old, and queue the system pages of full pages and of pages of outer
+   contexts to be write-protected.  Every object those point to is in
+   use, and so now old.  Pages with free objects are left writable,
+   since they will most likely be allocated from.  */
+
+static void
+gen_promote (void)
+{
+  unsigned order;
+
+  if (PARAM_VALUE (GGC_FULL_EXPAND) == 0)
+    return;
+
+  for (order = 2; order < NUM_ORDERS; order++)
+    {
+      page_entry *p;
+
+      for (p = G.pages[order]; p != NULL; p = p->next)
+	{
+	  size_t num_cards = p->bytes >> G.lg_pagesize;
+	  size_t card;
+
+	  if (p->context_depth == G.context_depth)
+	    {
+	      size_t bitmap_size = BITMAP_SIZE (OBJECTS_IN_PAGE (p) + 1);
+
+	      /* The one-past-the-end bit comes along.  */
+	      if (! p->gen_old_p)
+		p->gen_old_p = XNEWVEC (unsigned long,
+					bitmap_size / sizeof (long));
+	      memcpy (p->gen_old_p, p->in_use_p, bitmap_size);
+	      p->gen_young = 0;
+
+	      if (p->num_free_objects != 0)
+		continue;
+	    }
+
+	  if (! p->gen_cards)
+	    gen_alloc_cards (p);
+	  for (card = 0; card < num_cards; card++)
+	    if (! p->gen_cards[card])
+	      gen_queue_card (p, card);
+	}
+    }
+
+  if (G.minor_collection)
+    G.minor_collections++;
+  else
+    {
+      G.full_collections++;
+      G.allocated_last_full = G.allocated;
+    }
+}
+#endif /* GGC_GENERATIONAL */
+/* APPLE LOCAL end generational ggc */
+
 /* Top level mark-and-sweep routine.  */
 
 void
@@ -1895,6 +2868,9 @@ ggc_collect (void)
      sweep phase.  */
   G.allocated = 0;
 
+  /* APPLE LOCAL ggc bump allocation */
+  bump_flush_all ();
+
   /* Release the pages we freed the last time we collected, but didn't
      reuse in the interim.  */
   release_pages ();
@@ -1902,7 +2878,11 @@ ggc_collect (void)
   /* Indicate that we've seen collections at this context depth.  */
   G.context_depth_collections = ((unsigned long)1 << (G.context_depth + 1)) - 1;
 
+  /* APPLE LOCAL begin generational ggc */
+  G.minor_collection = gen_minor_p ();
   clear_marks ();
+  gen_scan_old ();
+  /* APPLE LOCAL end generational ggc */
   ggc_mark_roots ();
 #ifdef GATHER_STATISTICS
   ggc_prune_overhead_list ();
@@ -1910,9 +2890,16 @@ ggc_collect (void)
   poison_pages ();
   validate_free_objects ();
   sweep_pages ();
+  /* APPLE LOCAL begin generational ggc */
+  gen_promote ();
+  gen_set_protection (PROT_READ);
+  G.minor_collection = 0;
+  /* APPLE LOCAL end generational ggc */
 
   G.allocated_last_gc = G.allocated;
 
+  /* APPLE LOCAL timevar memory */
+  timevar_ggc_collected (G.allocated);
   timevar_pop (TV_GC);
 
   if (!quiet_flag)
@@ -1992,6 +2979,13 @@ ggc_print_statistics (void)
 	   SCALE (G.allocated), STAT_LABEL(G.allocated),
 	   SCALE (total_overhead), STAT_LABEL (total_overhead));
 
+  /* APPLE LOCAL begin generational ggc */
+  if (G.minor_collections)
+    fprintf (stderr, "%lu full and %lu minor collections, "
+	     "%lu writes to protected pages caught\n",
+	     G.full_collections, G.minor_collections, G.gen_faults);
+  /* APPLE LOCAL end generational ggc */
+
 #ifdef GATHER_STATISTICS  
   {
     fprintf (stderr, "\nTotal allocations and overheads during the compilation process\n");
@@ -2236,6 +3230,11 @@ ggc_pch_read (FILE *f, void *addr)
 
   count_old_page_tables = G.by_depth_in_use;
 
+  /* APPLE LOCAL generational ggc */
+  gen_reset ();
+  /* APPLE LOCAL ggc bump allocation */
+  bump_flush_all ();
+
   /* We've just read in a PCH file.  So, every object that used to be
      allocated is now free.  */
   clear_marks ();
@@ -2263,10 +3262,8 @@ ggc_pch_read (FILE *f, void *addr)
   for (i = 0; i < NUM_ORDERS; i++)
     {
       struct page_entry *entry;
-      char *pte;
       size_t bytes;
       size_t num_objs;
-      size_t j;
 
       if (d.totals[i] == 0)
 	continue;
@@ -2283,18 +3280,15 @@ ggc_pch_read (FILE *f, void *addr)
       entry->num_free_objects = 0;
       entry->order = i;
 
-      for (j = 0;
-	   j + HOST_BITS_PER_LONG <= num_objs + 1;
-	   j += HOST_BITS_PER_LONG)
-	entry->in_use_p[j / HOST_BITS_PER_LONG] = -1;
-      for (; j < num_objs + 1; j++)
-	entry->in_use_p[j / HOST_BITS_PER_LONG]
-	  |= 1L << (j % HOST_BITS_PER_LONG);
-
-      for (pte = entry->page;
-	   pte < entry->page + entry->bytes;
-	   pte += G.pagesize)
-	set_page_table_entry (pte, entry);
+      /* APPLE LOCAL begin lazy PCH */
+      /* Neither the in-use bitmap nor the page-table entries are set up
+	 here; that is done when the collector first looks at the page,
+	 so that a compilation pays only for the part of the PCH it
+	 touches.  The bitmap is calloc'd, so until then it costs no
+	 memory either.  */
+      entry->pch_lazy_p = 1;
+      G.pch_pages[i] = entry;
+      /* APPLE LOCAL end lazy PCH */
 
       if (G.page_tails[i] != NULL)
 	G.page_tails[i]->next = entry;
@@ -2315,6 +3309,13 @@ ggc_pch_read (FILE *f, void *addr)
 
   move_ptes_to_front (count_old_page_tables, count_new_page_tables);
 
+  /* APPLE LOCAL begin lazy PCH */
+  G.pch_start = addr;
+  G.pch_end = offs;
+  /* APPLE LOCAL end lazy PCH */
+
   /* Update the statistics.  */
   G.allocated = G.allocated_last_gc = offs - (char *)addr;
+  /* APPLE LOCAL generational ggc */
+  G.allocated_last_full = offs - (char *)addr;
 }
@@ -1947,6 +1947,16 @@ ggc_collect (void)
 	}
     }
 
+  /* APPLE LOCAL begin timevar memory */
+  {
+    size_t live = 0;
+
+    for (zone = G.zones; zone; zone = zone->next_zone)
+      live += zone->allocated;
+    timevar_ggc_collected (live);
+  }
+  /* APPLE LOCAL end timevar memory */
+
   timevar_pop (TV_GC);
 }
 
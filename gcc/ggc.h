@@ -61,6 +61,23 @@ extern int gt_pch_note_object (void *, void *, gt_note_pointers,
    function.  */
 extern void gt_pch_note_reorder (void *, void *, gt_handle_reorder);
 
+/* APPLE LOCAL begin relocatable PCH */
+/* Used by the gt_pch_p_* routines.  Register that the first parameter
+   points to a pointer into the compiler executable, given the cookie
+   in the second parameter.  */
+extern void gt_pch_note_callback (void *, void *);
+
+/* Used by the gt_pch_p_* routines.  Register that the first parameter
+   points to a pointer into the PCH image that was relocated through a
+   copy, given the cookie in the second parameter.  */
+extern void gt_pch_note_relocation (void *, void *);
+
+/* Used by the gt_pch_n_* routines.  Register that the object in the
+   first parameter, already registered, is a hash table, which must be
+   rehashed when the PCH image is read back.  */
+extern void gt_pch_note_htab (void *);
+/* APPLE LOCAL end relocatable PCH */
+
 /* Mark the object in the first parameter and anything it points to.  */
 typedef void (*gt_pointer_walker) (void *);
 
@@ -143,7 +160,10 @@ extern void init_stringpool (void);
 /* A GC implementation must provide these functions.  They are internal
    to the GC system.  */
 
-/* Forward declare the zone structure.  Only ggc_zone implements this.  */
+/* APPLE LOCAL begin ggc page kinds */
+/* Forward declare the zone structure.  Only ggc_zone implements new
+   zones; the page collector only has the fixed ones below.  */
+/* APPLE LOCAL end ggc page kinds */
 struct alloc_zone;
 
 /* Initialize the garbage collector.  */
@@ -296,7 +316,8 @@ extern void init_ggc_heuristics (bool);
 /* APPLE LOCAL end retune gc params 6124839 */
 
 /* Zone collection.  */
-#if defined (GGC_ZONE) && !defined (GENERATOR_FILE)
+/* APPLE LOCAL ggc page kinds */
+#ifndef GENERATOR_FILE
 
 /* For regular rtl allocations.  */
 extern struct alloc_zone rtl_zone;
@@ -279,6 +279,8 @@ lower_stmt (tree_stmt_iterator *tsi, struct lower_data *data)
       break;
 
     case OMP_PARALLEL:
+    /* APPLE LOCAL libgomp tasks */
+    case OMP_TASK:
       lower_omp_directive (tsi, data);
       return;
 
@@ -74,6 +74,8 @@ struct gimplify_omp_ctx
   enum omp_clause_default_kind default_kind;
   bool is_parallel;
   bool is_combined_parallel;
+  /* APPLE LOCAL libgomp tasks */
+  bool is_task;
 };
 
 struct gimplify_ctx
@@ -259,8 +261,10 @@ splay_tree_compare_decl_uid (splay_tree_key xa, splay_tree_key xb)
 
 /* Create a new omp construct that deals with variable remapping.  */
 
+/* APPLE LOCAL begin libgomp tasks */
 static struct gimplify_omp_ctx *
-new_omp_context (bool is_parallel, bool is_combined_parallel)
+new_omp_context (bool is_parallel, bool is_combined_parallel, bool is_task)
+/* APPLE LOCAL end libgomp tasks */
 {
   struct gimplify_omp_ctx *c;
 
@@ -271,7 +275,13 @@ new_omp_context (bool is_parallel, bool is_combined_parallel)
   c->location = input_location;
   c->is_parallel = is_parallel;
   c->is_combined_parallel = is_combined_parallel;
-  c->default_kind = OMP_CLAUSE_DEFAULT_SHARED;
+  /* APPLE LOCAL begin libgomp tasks */
+  c->is_task = is_task;
+  /* Without a default clause, sharing in a task depends on the
+     enclosing contexts; see omp_notice_variable.  */
+  c->default_kind = (is_task ? OMP_CLAUSE_DEFAULT_UNSPECIFIED
+		     : OMP_CLAUSE_DEFAULT_SHARED);
+  /* APPLE LOCAL end libgomp tasks */
 
   return c;
 }
@@ -4512,6 +4522,8 @@ static bool
 omp_notice_variable (struct gimplify_omp_ctx *ctx, tree decl, bool in_code)
 {
   splay_tree_node n;
+  /* APPLE LOCAL libgomp tasks */
+  struct gimplify_omp_ctx *octx;
   unsigned flags = in_code ? GOVD_SEEN : 0;
   bool ret = false, shared;
 
@@ -4552,9 +4564,20 @@ omp_notice_variable (struct gimplify_omp_ctx *ctx, tree decl, bool in_code)
       switch (default_kind)
 	{
 	case OMP_CLAUSE_DEFAULT_NONE:
-	  error ("%qs not specified in enclosing parallel",
-		 IDENTIFIER_POINTER (DECL_NAME (decl)));
-	  error ("%Henclosing parallel", &ctx->location);
+	  /* APPLE LOCAL begin libgomp tasks */
+	  if (ctx->is_task)
+	    {
+	      error ("%qs not specified in enclosing task",
+		     IDENTIFIER_POINTER (DECL_NAME (decl)));
+	      error ("%Henclosing task", &ctx->location);
+	    }
+	  else
+	    {
+	      error ("%qs not specified in enclosing parallel",
+		     IDENTIFIER_POINTER (DECL_NAME (decl)));
+	      error ("%Henclosing parallel", &ctx->location);
+	    }
+	  /* APPLE LOCAL end libgomp tasks */
 	  /* FALLTHRU */
 	case OMP_CLAUSE_DEFAULT_SHARED:
 	  flags |= GOVD_SHARED;
@@ -4562,6 +4585,40 @@ omp_notice_variable (struct gimplify_omp_ctx *ctx, tree decl, bool in_code)
 	case OMP_CLAUSE_DEFAULT_PRIVATE:
 	  flags |= GOVD_PRIVATE;
 	  break;
+	/* APPLE LOCAL begin libgomp tasks */
+	case OMP_CLAUSE_DEFAULT_UNSPECIFIED:
+	  /* A variable is shared in a task if it is shared in every
+	     enclosing context out to the innermost parallel, or is global
+	     in an orphaned task.  Otherwise it is firstprivate.  */
+	  gcc_assert (ctx->is_task);
+	  if (ctx->outer_context)
+	    omp_notice_variable (ctx->outer_context, decl, in_code);
+	  for (octx = ctx->outer_context; octx; octx = octx->outer_context)
+	    {
+	      splay_tree_node n2;
+
+	      n2 = splay_tree_lookup (octx->variables, (splay_tree_key) decl);
+	      if (n2 && (n2->value & GOVD_DATA_SHARE_CLASS) != GOVD_SHARED)
+		{
+		  flags |= GOVD_FIRSTPRIVATE;
+		  break;
+		}
+	      if (octx->is_parallel)
+		break;
+	    }
+	  if (flags & GOVD_FIRSTPRIVATE)
+	    break;
+	  if (octx == NULL
+	      && (TREE_CODE (decl) == PARM_DECL
+		  || (!is_global_var (decl)
+		      && DECL_CONTEXT (decl) == current_function_decl)))
+	    {
+	      flags |= GOVD_FIRSTPRIVATE;
+	      break;
+	    }
+	  flags |= GOVD_SHARED;
+	  break;
+	/* APPLE LOCAL end libgomp tasks */
 	default:
 	  gcc_unreachable ();
 	}
@@ -4667,14 +4724,16 @@ omp_check_private (struct gimplify_omp_ctx *ctx, tree decl)
 /* Scan the OpenMP clauses in *LIST_P, installing mappings into a new
    and previous omp contexts.  */
 
+/* APPLE LOCAL begin libgomp tasks */
 static void
 gimplify_scan_omp_clauses (tree *list_p, tree *pre_p, bool in_parallel,
-			   bool in_combined_parallel)
+			   bool in_combined_parallel, bool in_task)
 {
   struct gimplify_omp_ctx *ctx, *outer_ctx;
   tree c;
 
-  ctx = new_omp_context (in_parallel, in_combined_parallel);
+  ctx = new_omp_context (in_parallel, in_combined_parallel, in_task);
+/* APPLE LOCAL end libgomp tasks */
   outer_ctx = ctx->outer_context;
 
   while ((c = *list_p) != NULL)
@@ -4770,6 +4829,8 @@ gimplify_scan_omp_clauses (tree *list_p, tree *pre_p, bool in_parallel,
 
 	case OMP_CLAUSE_NOWAIT:
 	case OMP_CLAUSE_ORDERED:
+	/* APPLE LOCAL libgomp tasks */
+	case OMP_CLAUSE_UNTIED:
 	  break;
 
 	case OMP_CLAUSE_DEFAULT:
@@ -4905,6 +4966,8 @@ gimplify_adjust_omp_clauses (tree *list_p)
 	case OMP_CLAUSE_NOWAIT:
 	case OMP_CLAUSE_ORDERED:
 	case OMP_CLAUSE_DEFAULT:
+	/* APPLE LOCAL libgomp tasks */
+	case OMP_CLAUSE_UNTIED:
 	  break;
 
 	default:
@@ -4934,8 +4997,10 @@ gimplify_omp_parallel (tree *expr_p, tree *pre_p)
 {
   tree expr = *expr_p;
 
+  /* APPLE LOCAL begin libgomp tasks */
   gimplify_scan_omp_clauses (&OMP_PARALLEL_CLAUSES (expr), pre_p, true,
-			     OMP_PARALLEL_COMBINED (expr));
+			     OMP_PARALLEL_COMBINED (expr), false);
+  /* APPLE LOCAL end libgomp tasks */
 
   push_gimplify_context ();
 
@@ -4951,6 +5016,33 @@ gimplify_omp_parallel (tree *expr_p, tree *pre_p)
   return GS_ALL_DONE;
 }
 
+/* APPLE LOCAL begin libgomp tasks */
+/* Gimplify the contents of an OMP_TASK statement.  This is done the same
+   way as for OMP_PARALLEL; only the implicit data sharing differs.  */
+
+static enum gimplify_status
+gimplify_omp_task (tree *expr_p, tree *pre_p)
+{
+  tree expr = *expr_p;
+
+  gimplify_scan_omp_clauses (&OMP_TASK_CLAUSES (expr), pre_p, true,
+			     false, true);
+
+  push_gimplify_context ();
+
+  gimplify_stmt (&OMP_TASK_BODY (expr));
+
+  if (TREE_CODE (OMP_TASK_BODY (expr)) == BIND_EXPR)
+    pop_gimplify_context (OMP_TASK_BODY (expr));
+  else
+    pop_gimplify_context (NULL_TREE);
+
+  gimplify_adjust_omp_clauses (&OMP_TASK_CLAUSES (expr));
+
+  return GS_ALL_DONE;
+}
+/* APPLE LOCAL end libgomp tasks */
+
 /* Gimplify the gross structure of an OMP_FOR statement.  */
 
 static enum gimplify_status
@@ -4961,7 +5053,9 @@ gimplify_omp_for (tree *expr_p, tree *pre_p)
 
   for_stmt = *expr_p;
 
-  gimplify_scan_omp_clauses (&OMP_FOR_CLAUSES (for_stmt), pre_p, false, false);
+  /* APPLE LOCAL libgomp tasks */
+  gimplify_scan_omp_clauses (&OMP_FOR_CLAUSES (for_stmt), pre_p, false, false,
+			     false);
 
   t = OMP_FOR_INIT (for_stmt);
   gcc_assert (TREE_CODE (t) == MODIFY_EXPR);
@@ -5043,7 +5137,8 @@ gimplify_omp_workshare (tree *expr_p, tree *pre_p)
 {
   tree stmt = *expr_p;
 
-  gimplify_scan_omp_clauses (&OMP_CLAUSES (stmt), pre_p, false, false);
+  /* APPLE LOCAL libgomp tasks */
+  gimplify_scan_omp_clauses (&OMP_CLAUSES (stmt), pre_p, false, false, false);
   gimplify_to_stmt_list (&OMP_BODY (stmt));
   gimplify_adjust_omp_clauses (&OMP_CLAUSES (stmt));
 
@@ -5288,32 +5383,41 @@ gimplify_omp_atomic_pipeline (tree *expr_p, tree *pre_p, tree addr,
 
 /* A subroutine of gimplify_omp_atomic.  Implement the atomic operation as:
 
-	GOMP_atomic_start ();
+	GOMP_atomic_addr_start (addr);
 	*addr = rhs;
-	GOMP_atomic_end ();
+	GOMP_atomic_addr_end (addr);
 
-   The result is not globally atomic, but works so long as all parallel
-   references are within #pragma omp atomic directives.  According to
-   responses received from omp@openmp.org, appears to be within spec.
-   Which makes sense, since that's how several other compilers handle
-   this situation as well.  */
+   The lock is picked by the runtime from ADDR, so updates of unrelated
+   data don't contend.  The result is not globally atomic, but works so
+   long as all parallel references are within #pragma omp atomic
+   directives.  According to responses received from omp@openmp.org,
+   appears to be within spec.  Which makes sense, since that's how
+   several other compilers handle this situation as well.  */
 
 static enum gimplify_status
 gimplify_omp_atomic_mutex (tree *expr_p, tree *pre_p, tree addr, tree rhs)
 {
-  tree t;
+  /* APPLE LOCAL begin libgomp striped atomic locks */
+  tree t, args;
 
-  t = built_in_decls[BUILT_IN_GOMP_ATOMIC_START];
-  t = build_function_call_expr (t, NULL);
+  if (gimplify_expr (&addr, pre_p, NULL, is_gimple_val, fb_rvalue)
+      == GS_ERROR)
+    return GS_ERROR;
+  args = tree_cons (NULL, fold_convert (ptr_type_node, addr), NULL);
+  t = built_in_decls[BUILT_IN_GOMP_ATOMIC_ADDR_START];
+  t = build_function_call_expr (t, args);
   gimplify_and_add (t, pre_p);
 
   t = build_fold_indirect_ref (addr);
   t = build2 (MODIFY_EXPR, void_type_node, t, rhs);
   gimplify_and_add (t, pre_p);
   
-  t = built_in_decls[BUILT_IN_GOMP_ATOMIC_END];
-  t = build_function_call_expr (t, NULL);
+  args = tree_cons (NULL, fold_convert (ptr_type_node, unshare_expr (addr)),
+		    NULL);
+  t = built_in_decls[BUILT_IN_GOMP_ATOMIC_ADDR_END];
+  t = build_function_call_expr (t, args);
   gimplify_and_add (t, pre_p);
+  /* APPLE LOCAL end libgomp striped atomic locks */
 
   *expr_p = NULL;
   return GS_ALL_DONE;
@@ -5807,6 +5911,12 @@ gimplify_expr (tree *expr_p, tree *pre_p, tree *post_p,
 	  ret = gimplify_omp_parallel (expr_p, pre_p);
 	  break;
 
+	/* APPLE LOCAL begin libgomp tasks */
+	case OMP_TASK:
+	  ret = gimplify_omp_task (expr_p, pre_p);
+	  break;
+	/* APPLE LOCAL end libgomp tasks */
+
 	case OMP_FOR:
 	  ret = gimplify_omp_for (expr_p, pre_p);
 	  break;
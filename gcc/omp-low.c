@@ -41,6 +41,8 @@ Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA
 #include "tree-pass.h"
 #include "ggc.h"
 #include "except.h"
+/* APPLE LOCAL libgomp tree reductions */
+#include "optabs.h"
 
 
 /* Lowering of OpenMP parallel and workshare constructs proceeds in two 
@@ -108,6 +110,11 @@ struct omp_for_data
 
 static splay_tree all_contexts;
 static int parallel_nesting_level;
+/* APPLE LOCAL begin libgomp tasks */
+/* The DECL_UIDs of variables that were gimple registers until a task
+   needed their address; see mark_task_shared_vars.  */
+static bitmap task_shared_vars;
+/* APPLE LOCAL end libgomp tasks */
 struct omp_region *root_omp_region;
 
 static void scan_omp (tree *, omp_context *);
@@ -135,6 +142,25 @@ is_parallel_ctx (omp_context *ctx)
   return TREE_CODE (ctx->stmt) == OMP_PARALLEL;
 }
 
+/* APPLE LOCAL begin libgomp tasks */
+/* Return true if CTX is for an omp task.  */
+
+static inline bool
+is_task_ctx (omp_context *ctx)
+{
+  return TREE_CODE (ctx->stmt) == OMP_TASK;
+}
+
+/* Return true if CTX is for an omp parallel or an omp task, i.e. a
+   construct whose body is outlined into a child function.  */
+
+static inline bool
+is_taskreg_ctx (omp_context *ctx)
+{
+  return is_parallel_ctx (ctx) || is_task_ctx (ctx);
+}
+/* APPLE LOCAL end libgomp tasks */
+
 
 /* Return true if REGION is a combined parallel+workshare region.  */
 
@@ -509,6 +535,57 @@ use_pointer_for_field (tree decl, bool shared_p)
   return false;
 }
 
+/* APPLE LOCAL begin libgomp tasks */
+/* Like use_pointer_for_field, but for a field of the data block sent to
+   the construct CTX.  A task may run after the code that created it has
+   moved on, so a firstprivate variable is always copied into the task's
+   data when it is created, and a shared one is always passed by
+   address.  */
+
+static bool
+use_pointer_for_ctx_field (tree decl, bool shared_p, omp_context *ctx)
+{
+  if (!is_task_ctx (ctx))
+    return use_pointer_for_field (decl, shared_p);
+  return shared_p;
+}
+
+/* Callback for walk_tree.  Variables shared with a task are passed to
+   it by address, so they can't live in registers.  Make them addressable
+   before anything decides how to pass them to an enclosing parallel, and
+   remember them in TASK_SHARED_VARS: their uses were gimplified while
+   they were registers.  */
+
+static tree
+mark_task_shared_vars (tree *tp, int *walk_subtrees,
+		       void *data ATTRIBUTE_UNUSED)
+{
+  tree c, decl;
+
+  if (TREE_CODE (*tp) != OMP_TASK)
+    {
+      if (TYPE_P (*tp) || DECL_P (*tp))
+	*walk_subtrees = 0;
+      return NULL_TREE;
+    }
+
+  for (c = OMP_TASK_CLAUSES (*tp); c; c = OMP_CLAUSE_CHAIN (c))
+    if (OMP_CLAUSE_CODE (c) == OMP_CLAUSE_SHARED)
+      {
+	decl = OMP_CLAUSE_DECL (c);
+	if (is_gimple_reg (decl))
+	  {
+	    if (!task_shared_vars)
+	      task_shared_vars = BITMAP_ALLOC (NULL);
+	    bitmap_set_bit (task_shared_vars, DECL_UID (decl));
+	    TREE_ADDRESSABLE (decl) = 1;
+	  }
+      }
+
+  return NULL_TREE;
+}
+/* APPLE LOCAL end libgomp tasks */
+
 /* Construct a new automatic decl similar to VAR.  */
 
 static tree
@@ -574,11 +651,13 @@ build_outer_var_ref (tree var, omp_context *ctx)
       x = build_outer_var_ref (x, ctx);
       x = build_fold_indirect_ref (x);
     }
-  else if (is_parallel_ctx (ctx))
+  /* APPLE LOCAL begin libgomp tasks */
+  else if (is_taskreg_ctx (ctx))
     {
-      bool by_ref = use_pointer_for_field (var, false);
+      bool by_ref = use_pointer_for_ctx_field (var, false, ctx);
       x = build_receiver_ref (var, by_ref, ctx);
     }
+  /* APPLE LOCAL end libgomp tasks */
   else if (ctx->outer)
     x = lookup_decl (var, ctx->outer);
   else if (is_reference (var))
@@ -692,7 +771,8 @@ omp_copy_decl (tree var, copy_body_data *cb)
       return new_var;
     }
 
-  while (!is_parallel_ctx (ctx))
+  /* APPLE LOCAL libgomp tasks */
+  while (!is_taskreg_ctx (ctx))
     {
       ctx = ctx->outer;
       if (ctx == NULL)
@@ -943,10 +1023,12 @@ scan_sharing_clauses (tree clauses, omp_context *ctx)
 	  break;
 
 	case OMP_CLAUSE_SHARED:
-	  gcc_assert (is_parallel_ctx (ctx));
+	  /* APPLE LOCAL begin libgomp tasks */
+	  gcc_assert (is_taskreg_ctx (ctx));
 	  decl = OMP_CLAUSE_DECL (c);
 	  gcc_assert (!is_variable_sized (decl));
-	  by_ref = use_pointer_for_field (decl, true);
+	  by_ref = use_pointer_for_ctx_field (decl, true, ctx);
+	  /* APPLE LOCAL end libgomp tasks */
 	  /* Global variables don't need to be copied,
 	     the receiver side will use them directly.  */
 	  if (is_global_var (maybe_lookup_decl_in_outer_ctx (decl, ctx)))
@@ -975,15 +1057,29 @@ scan_sharing_clauses (tree clauses, omp_context *ctx)
 	case OMP_CLAUSE_REDUCTION:
 	  decl = OMP_CLAUSE_DECL (c);
 	do_private:
+	  /* APPLE LOCAL begin libgomp tasks */
+	  if (is_task_ctx (ctx)
+	      && (is_variable_sized (decl)
+		  || is_reference (decl)
+		  || TREE_ADDRESSABLE (TREE_TYPE (decl))))
+	    {
+	      /* The task's data block is copied bitwise when the task is
+		 deferred.  */
+	      sorry ("firstprivate %qD in a task", decl);
+	      if (!is_variable_sized (decl))
+		install_var_local (decl, ctx);
+	      break;
+	    }
 	  if (is_variable_sized (decl))
 	    break;
-	  else if (is_parallel_ctx (ctx)
+	  else if (is_taskreg_ctx (ctx)
 		   && ! is_global_var (maybe_lookup_decl_in_outer_ctx (decl,
 								       ctx)))
 	    {
-	      by_ref = use_pointer_for_field (decl, false);
+	      by_ref = use_pointer_for_ctx_field (decl, false, ctx);
 	      install_var_field (decl, by_ref, ctx);
 	    }
+	  /* APPLE LOCAL end libgomp tasks */
 	  install_var_local (decl, ctx);
 	  break;
 
@@ -1011,6 +1107,8 @@ scan_sharing_clauses (tree clauses, omp_context *ctx)
 
 	case OMP_CLAUSE_NOWAIT:
 	case OMP_CLAUSE_ORDERED:
+	/* APPLE LOCAL libgomp tasks */
+	case OMP_CLAUSE_UNTIED:
 	  break;
 
 	default:
@@ -1057,6 +1155,8 @@ scan_sharing_clauses (tree clauses, omp_context *ctx)
 	case OMP_CLAUSE_SCHEDULE:
 	case OMP_CLAUSE_NOWAIT:
 	case OMP_CLAUSE_ORDERED:
+	/* APPLE LOCAL libgomp tasks */
+	case OMP_CLAUSE_UNTIED:
 	  break;
 
 	default:
@@ -1188,6 +1288,41 @@ scan_omp_parallel (tree *stmt_p, omp_context *outer_ctx)
     }
 }
 
+/* APPLE LOCAL begin libgomp tasks */
+/* Scan an OpenMP task directive.  This is done like a parallel, except
+   that an empty task still has to be scheduled.  */
+
+static void
+scan_omp_task (tree *stmt_p, omp_context *outer_ctx)
+{
+  omp_context *ctx;
+  tree name;
+
+  ctx = new_omp_context (*stmt_p, outer_ctx);
+  if (parallel_nesting_level > 1)
+    ctx->is_nested = true;
+  ctx->field_map = splay_tree_new (splay_tree_compare_pointers, 0, 0);
+  ctx->default_kind = OMP_CLAUSE_DEFAULT_SHARED;
+  ctx->record_type = lang_hooks.types.make_type (RECORD_TYPE);
+  name = create_tmp_var_name (".omp_data_s");
+  name = build_decl (TYPE_DECL, name, ctx->record_type);
+  TYPE_NAME (ctx->record_type) = name;
+  create_omp_child_function (ctx);
+  OMP_TASK_FN (*stmt_p) = ctx->cb.dst_fn;
+
+  scan_sharing_clauses (OMP_TASK_CLAUSES (*stmt_p), ctx);
+  scan_omp (&OMP_TASK_BODY (*stmt_p), ctx);
+
+  if (TYPE_FIELDS (ctx->record_type) == NULL)
+    ctx->record_type = ctx->receiver_decl = NULL;
+  else
+    {
+      layout_type (ctx->record_type);
+      fixup_child_record_type (ctx);
+    }
+}
+/* APPLE LOCAL end libgomp tasks */
+
 
 /* Scan an OpenMP loop directive.  */
 
@@ -1266,9 +1401,13 @@ check_omp_nesting_restrictions (tree t, omp_context *ctx)
 	  case OMP_SINGLE:
 	  case OMP_ORDERED:
 	  case OMP_MASTER:
+	  /* APPLE LOCAL begin libgomp tasks */
+	  case OMP_TASK:
 	    warning (0, "work-sharing region may not be closely nested inside "
-			"of work-sharing, critical, ordered or master region");
+			"of work-sharing, critical, ordered, master or explicit "
+			"task region");
 	    return;
+	  /* APPLE LOCAL end libgomp tasks */
 	  case OMP_PARALLEL:
 	    return;
 	  default:
@@ -1282,9 +1421,12 @@ check_omp_nesting_restrictions (tree t, omp_context *ctx)
 	  case OMP_FOR:
 	  case OMP_SECTIONS:
 	  case OMP_SINGLE:
+	  /* APPLE LOCAL begin libgomp tasks */
+	  case OMP_TASK:
 	    warning (0, "master region may not be closely nested inside "
-			"of work-sharing region");
+			"of work-sharing or explicit task region");
 	    return;
+	  /* APPLE LOCAL end libgomp tasks */
 	  case OMP_PARALLEL:
 	    return;
 	  default:
@@ -1306,6 +1448,8 @@ check_omp_nesting_restrictions (tree t, omp_context *ctx)
 			  "a loop region with an ordered clause");
 	    return;
 	  case OMP_PARALLEL:
+	  /* APPLE LOCAL libgomp tasks */
+	  case OMP_TASK:
 	    return;
 	  default:
 	    break;
@@ -1352,6 +1496,14 @@ scan_omp_1 (tree *tp, int *walk_subtrees, void *data)
       parallel_nesting_level--;
       break;
 
+    /* APPLE LOCAL begin libgomp tasks */
+    case OMP_TASK:
+      parallel_nesting_level++;
+      scan_omp_task (tp, ctx);
+      parallel_nesting_level--;
+      break;
+    /* APPLE LOCAL end libgomp tasks */
+
     case OMP_FOR:
       scan_omp_for (tp, ctx);
       break;
@@ -1742,7 +1894,8 @@ lower_rec_input_clauses (tree clauses, tree *ilist, tree *dlist,
 	      /* Set up the DECL_VALUE_EXPR for shared variables now.  This
 		 needs to be delayed until after fixup_child_record_type so
 		 that we get the correct type during the dereference.  */
-	      by_ref = use_pointer_for_field (var, true);
+	      /* APPLE LOCAL libgomp tasks */
+	      by_ref = use_pointer_for_ctx_field (var, true, ctx);
 	      x = build_receiver_ref (var, by_ref, ctx);
 	      SET_DECL_VALUE_EXPR (new_var, x);
 	      DECL_HAS_VALUE_EXPR_P (new_var) = 1;
@@ -1894,6 +2047,159 @@ lower_lastprivate_clauses (tree clauses, tree predicate, tree *stmt_list,
 }
 
 
+/* APPLE LOCAL begin libgomp tree reductions */
+/* Return true if an OMP_ATOMIC update of a variable of TYPE can be done
+   without falling back to a lock; see gimplify_omp_atomic.  */
+
+static bool
+omp_atomic_type_p (tree type)
+{
+  HOST_WIDE_INT size;
+  enum machine_mode mode;
+
+  if (!host_integerp (TYPE_SIZE_UNIT (type), 1))
+    return false;
+  size = tree_low_cst (TYPE_SIZE_UNIT (type), 1);
+  if (exact_log2 (size) < 0 || exact_log2 (size) > 4
+      || TYPE_ALIGN_UNIT (type) < size)
+    return false;
+
+  mode = mode_for_size (size * BITS_PER_UNIT, MODE_INT, 0);
+  return mode != BLKmode && sync_compare_and_swap[mode] != CODE_FOR_nothing;
+}
+
+/* Generate code to merge the REDUCTION clauses in CLAUSES by combining
+   the partial results of the threads pairwise in a tree, with the help
+   of the runtime.  Each thread copies its private copies into a block
+   .omp_red and runs
+
+	L0:
+	  .omp_red_p = GOMP_reduction_next (&.omp_red);
+	  if (.omp_red_p == 0) goto L2; else goto L1;
+	L1:
+	  .omp_red.x = .omp_red.x OP .omp_red_p->x;  (for each variable)
+	  goto L0;
+	L2:
+	  if (GOMP_reduction_end ()) goto L3; else goto L4;
+	L3:
+	  x = x OP .omp_red.x;  (for each variable)
+	L4:
+
+   so that only one thread ever touches the shared variables.  */
+
+static void
+lower_tree_reduction_clauses (tree clauses, tree *stmt_list,
+			      omp_context *ctx)
+{
+  tree record_type, ptr_type, fields = NULL, red, red_p, t, x, c;
+  tree merge_list = NULL, final_list = NULL, l0, l1, l2, l3, l4;
+
+  record_type = lang_hooks.types.make_type (RECORD_TYPE);
+  t = build_decl (TYPE_DECL, create_tmp_var_name (".omp_red_s"),
+		  record_type);
+  TYPE_NAME (record_type) = t;
+
+  for (c = clauses; c ; c = OMP_CLAUSE_CHAIN (c))
+    if (OMP_CLAUSE_CODE (c) == OMP_CLAUSE_REDUCTION)
+      {
+	tree var = OMP_CLAUSE_DECL (c), new_var, field;
+
+	new_var = lookup_decl (var, ctx);
+	if (is_reference (var))
+	  new_var = build_fold_indirect_ref (new_var);
+	field = build_decl (FIELD_DECL, DECL_NAME (var),
+			    TYPE_MAIN_VARIANT (TREE_TYPE (new_var)));
+	insert_field_into_struct (record_type, field);
+	fields = tree_cons (field, c, fields);
+      }
+  fields = nreverse (fields);
+  layout_type (record_type);
+
+  red = create_tmp_var (record_type, ".omp_red");
+  TREE_ADDRESSABLE (red) = 1;
+  ptr_type = build_pointer_type (record_type);
+  red_p = create_tmp_var (ptr_type, ".omp_red_p");
+
+  l0 = create_artificial_label ();
+  l1 = create_artificial_label ();
+  l2 = create_artificial_label ();
+  l3 = create_artificial_label ();
+  l4 = create_artificial_label ();
+
+  for (t = fields; t ; t = TREE_CHAIN (t))
+    {
+      tree field = TREE_PURPOSE (t), var, new_var, ref, mine, theirs;
+      enum tree_code code;
+
+      c = TREE_VALUE (t);
+      var = OMP_CLAUSE_DECL (c);
+      new_var = lookup_decl (var, ctx);
+      if (is_reference (var))
+	new_var = build_fold_indirect_ref (new_var);
+      code = OMP_CLAUSE_REDUCTION_CODE (c);
+      if (code == MINUS_EXPR)
+	code = PLUS_EXPR;
+
+      mine = build3 (COMPONENT_REF, TREE_TYPE (field), red, field, NULL);
+      x = build2 (MODIFY_EXPR, void_type_node, mine,
+		  fold_convert (TREE_TYPE (field), new_var));
+      gimplify_and_add (x, stmt_list);
+
+      theirs = build_fold_indirect_ref (red_p);
+      theirs = build3 (COMPONENT_REF, TREE_TYPE (field), theirs, field, NULL);
+      x = build2 (code, TREE_TYPE (field), mine, theirs);
+      x = build2 (MODIFY_EXPR, void_type_node, mine, x);
+      append_to_statement_list (x, &merge_list);
+
+      ref = build_outer_var_ref (var, ctx);
+      x = build2 (code, TREE_TYPE (ref), ref,
+		  fold_convert (TREE_TYPE (ref), mine));
+      ref = build_outer_var_ref (var, ctx);
+      x = build2 (MODIFY_EXPR, void_type_node, ref, x);
+      append_to_statement_list (x, &final_list);
+    }
+
+  t = build1 (LABEL_EXPR, void_type_node, l0);
+  gimplify_and_add (t, stmt_list);
+
+  t = build_fold_addr_expr (red);
+  t = build_function_call_expr (built_in_decls[BUILT_IN_GOMP_REDUCTION_NEXT],
+				tree_cons (NULL, t, NULL));
+  t = fold_convert (ptr_type, t);
+  t = build2 (MODIFY_EXPR, void_type_node, red_p, t);
+  gimplify_and_add (t, stmt_list);
+
+  t = build2 (EQ_EXPR, boolean_type_node, red_p,
+	      build_int_cst (ptr_type, 0));
+  t = build3 (COND_EXPR, void_type_node, t,
+	      build_and_jump (&l2), build_and_jump (&l1));
+  gimplify_and_add (t, stmt_list);
+
+  t = build1 (LABEL_EXPR, void_type_node, l1);
+  gimplify_and_add (t, stmt_list);
+  gimplify_and_add (merge_list, stmt_list);
+  t = build_and_jump (&l0);
+  gimplify_and_add (t, stmt_list);
+
+  t = build1 (LABEL_EXPR, void_type_node, l2);
+  gimplify_and_add (t, stmt_list);
+
+  t = built_in_decls[BUILT_IN_GOMP_REDUCTION_END];
+  t = build_function_call_expr (t, NULL);
+  t = build3 (COND_EXPR, void_type_node, t,
+	      build_and_jump (&l3), build_and_jump (&l4));
+  gimplify_and_add (t, stmt_list);
+
+  t = build1 (LABEL_EXPR, void_type_node, l3);
+  gimplify_and_add (t, stmt_list);
+  gimplify_and_add (final_list, stmt_list);
+
+  t = build1 (LABEL_EXPR, void_type_node, l4);
+  gimplify_and_add (t, stmt_list);
+}
+/* APPLE LOCAL end libgomp tree reductions */
+
+
 /* Generate code to implement the REDUCTION clauses.  */
 
 static void
@@ -1901,10 +2207,17 @@ lower_reduction_clauses (tree clauses, tree *stmt_list, omp_context *ctx)
 {
   tree sub_list = NULL, x, c;
   int count = 0;
-
-  /* First see if there is exactly one reduction clause.  Use OMP_ATOMIC
-     update in that case, otherwise use a lock.  */
-  for (c = clauses; c && count < 2; c = OMP_CLAUSE_CHAIN (c))
+  /* APPLE LOCAL libgomp tree reductions */
+  tree type = NULL;
+  /* APPLE LOCAL libgomp striped atomic locks */
+  tree lock_addr;
+
+  /* APPLE LOCAL begin libgomp tree reductions */
+  /* First see if there is exactly one reduction clause, of a type that
+     can be updated atomically.  Use OMP_ATOMIC update in that case.
+     Array reductions use a lock, and anything else is combined in a
+     tree by lower_tree_reduction_clauses.  */
+  for (c = clauses; c ; c = OMP_CLAUSE_CHAIN (c))
     if (OMP_CLAUSE_CODE (c) == OMP_CLAUSE_REDUCTION)
       {
 	if (OMP_CLAUSE_REDUCTION_PLACEHOLDER (c))
@@ -1913,12 +2226,24 @@ lower_reduction_clauses (tree clauses, tree *stmt_list, omp_context *ctx)
 	    count = -1;
 	    break;
 	  }
+	type = TREE_TYPE (OMP_CLAUSE_DECL (c));
+	if (is_reference (OMP_CLAUSE_DECL (c)))
+	  type = TREE_TYPE (type);
 	count++;
       }
+  /* APPLE LOCAL end libgomp tree reductions */
 
   if (count == 0)
     return;
 
+  /* APPLE LOCAL begin libgomp tree reductions */
+  if (count > 1 || (count == 1 && !omp_atomic_type_p (type)))
+    {
+      lower_tree_reduction_clauses (clauses, stmt_list, ctx);
+      return;
+    }
+  /* APPLE LOCAL end libgomp tree reductions */
+
   for (c = clauses; c ; c = OMP_CLAUSE_CHAIN (c))
     {
       tree var, ref, new_var;
@@ -1972,15 +2297,26 @@ lower_reduction_clauses (tree clauses, tree *stmt_list, omp_context *ctx)
 	}
     }
 
-  x = built_in_decls[BUILT_IN_GOMP_ATOMIC_START];
-  x = build_function_call_expr (x, NULL);
+  /* APPLE LOCAL begin libgomp striped atomic locks */
+  /* Every thread merges into the same shared variables, so any one of
+     their addresses picks the same lock for the whole team.  */
+  for (c = clauses; OMP_CLAUSE_CODE (c) != OMP_CLAUSE_REDUCTION;
+       c = OMP_CLAUSE_CHAIN (c))
+    continue;
+  lock_addr = build_outer_var_ref (OMP_CLAUSE_DECL (c), ctx);
+  lock_addr = fold_convert (ptr_type_node, build_fold_addr_expr (lock_addr));
+  lock_addr = get_formal_tmp_var (lock_addr, stmt_list);
+
+  x = built_in_decls[BUILT_IN_GOMP_ATOMIC_ADDR_START];
+  x = build_function_call_expr (x, tree_cons (NULL, lock_addr, NULL));
   gimplify_and_add (x, stmt_list);
 
   gimplify_and_add (sub_list, stmt_list);
 
-  x = built_in_decls[BUILT_IN_GOMP_ATOMIC_END];
-  x = build_function_call_expr (x, NULL);
+  x = built_in_decls[BUILT_IN_GOMP_ATOMIC_ADDR_END];
+  x = build_function_call_expr (x, tree_cons (NULL, lock_addr, NULL));
   gimplify_and_add (x, stmt_list);
+  /* APPLE LOCAL end libgomp striped atomic locks */
 }
 
 
@@ -2054,7 +2390,8 @@ lower_send_clauses (tree clauses, tree *ilist, tree *olist, omp_context *ctx)
 	continue;
       if (is_variable_sized (val))
 	continue;
-      by_ref = use_pointer_for_field (val, false);
+      /* APPLE LOCAL libgomp tasks */
+      by_ref = use_pointer_for_ctx_field (val, false, ctx);
 
       switch (OMP_CLAUSE_CODE (c))
 	{
@@ -2127,7 +2464,8 @@ lower_send_shared_vars (tree *ilist, tree *olist, omp_context *ctx)
       if (ctx->is_nested)
 	var = lookup_decl_in_outer_ctx (ovar, ctx);
 
-      if (use_pointer_for_field (ovar, true))
+      /* APPLE LOCAL libgomp tasks */
+      if (use_pointer_for_ctx_field (ovar, true, ctx))
 	{
 	  x = build_sender_ref (ovar, ctx);
 	  var = build_fold_addr_expr (var);
@@ -2300,6 +2638,66 @@ expand_parallel_call (struct omp_region *region, basic_block bb,
   pop_gimplify_context (NULL_TREE);
 }
 
+/* APPLE LOCAL begin libgomp tasks */
+/* Build the function call to GOMP_task to actually generate the task
+   operation.  BB is the block where to insert the code.  */
+
+static void
+expand_task_call (basic_block bb, tree entry_stmt)
+{
+  tree t, args, list, size, align, cond, flags, clauses, c;
+  block_stmt_iterator si;
+
+  clauses = OMP_TASK_CLAUSES (entry_stmt);
+  push_gimplify_context ();
+
+  c = find_omp_clause (clauses, OMP_CLAUSE_IF);
+  if (c)
+    cond = gimple_boolify (OMP_CLAUSE_IF_EXPR (c));
+  else
+    cond = boolean_true_node;
+
+  /* Bit 0 of the flags is GOMP_TASK_FLAG_UNTIED in libgomp.  */
+  c = find_omp_clause (clauses, OMP_CLAUSE_UNTIED);
+  flags = build_int_cst (unsigned_type_node, c ? 1 : 0);
+
+  t = OMP_TASK_DATA_ARG (entry_stmt);
+  if (t == NULL)
+    {
+      size = build_int_cst (long_integer_type_node, 0);
+      align = build_int_cst (long_integer_type_node, 1);
+      t = null_pointer_node;
+    }
+  else
+    {
+      size = fold_convert (long_integer_type_node,
+			   TYPE_SIZE_UNIT (TREE_TYPE (t)));
+      align = build_int_cst (long_integer_type_node,
+			     TYPE_ALIGN_UNIT (TREE_TYPE (t)));
+      t = build_fold_addr_expr (t);
+    }
+
+  list = NULL_TREE;
+  args = tree_cons (NULL, flags, NULL);
+  args = tree_cons (NULL, cond, args);
+  args = tree_cons (NULL, align, args);
+  args = tree_cons (NULL, size, args);
+  args = tree_cons (NULL, null_pointer_node, args);
+  args = tree_cons (NULL, t, args);
+  t = build_fold_addr_expr (OMP_TASK_FN (entry_stmt));
+  args = tree_cons (NULL, t, args);
+
+  t = built_in_decls[BUILT_IN_GOMP_TASK];
+  t = build_function_call_expr (t, args);
+  gimplify_and_add (t, &list);
+
+  si = bsi_last (bb);
+  bsi_insert_after (&si, list, BSI_CONTINUE_LINKING);
+
+  pop_gimplify_context (NULL_TREE);
+}
+/* APPLE LOCAL end libgomp tasks */
+
 
 /* If exceptions are enabled, wrap *STMT_P in a MUST_NOT_THROW catch
    handler.  This prevents programs from violating the structured
@@ -2395,11 +2793,29 @@ remove_exit_barrier (struct omp_region *region)
     }
 }
 
+/* APPLE LOCAL begin libgomp tasks */
+/* Return true if REGION contains a task.  */
+
+static bool
+contains_task_region_p (struct omp_region *region)
+{
+  for (region = region->inner; region; region = region->next)
+    if (region->type == OMP_TASK || contains_task_region_p (region))
+      return true;
+  return false;
+}
+/* APPLE LOCAL end libgomp tasks */
+
 static void
 remove_exit_barriers (struct omp_region *region)
 {
-  if (region->type == OMP_PARALLEL)
+  /* APPLE LOCAL begin libgomp tasks */
+  /* A task may still be using the parallel body's locals after the
+     thread that created it has returned from the body, unless a barrier
+     waits for it first.  */
+  if (region->type == OMP_PARALLEL && !contains_task_region_p (region))
     remove_exit_barrier (region);
+  /* APPLE LOCAL end libgomp tasks */
 
   if (region->inner)
     {
@@ -2413,10 +2829,12 @@ remove_exit_barriers (struct omp_region *region)
     }
 }
 
-/* Expand the OpenMP parallel directive starting at REGION.  */
+/* APPLE LOCAL begin libgomp tasks */
+/* Expand the OpenMP parallel or task directive starting at REGION.  */
 
 static void
-expand_omp_parallel (struct omp_region *region)
+expand_omp_taskreg (struct omp_region *region)
+/* APPLE LOCAL end libgomp tasks */
 {
   basic_block entry_bb, exit_bb, new_bb;
   struct function *child_cfun, *saved_cfun;
@@ -2427,7 +2845,8 @@ expand_omp_parallel (struct omp_region *region)
   bool do_cleanup_cfg = false;
 
   entry_stmt = last_stmt (region->entry);
-  child_fn = OMP_PARALLEL_FN (entry_stmt);
+  /* APPLE LOCAL libgomp tasks */
+  child_fn = OMP_TASKREG_FN (entry_stmt);
   child_cfun = DECL_STRUCT_FUNCTION (child_fn);
   saved_cfun = cfun;
 
@@ -2450,7 +2869,8 @@ expand_omp_parallel (struct omp_region *region)
       entry_succ_e = single_succ_edge (entry_bb);
 
       si = bsi_last (entry_bb);
-      gcc_assert (TREE_CODE (bsi_stmt (si)) == OMP_PARALLEL);
+      /* APPLE LOCAL libgomp tasks */
+      gcc_assert (TREE_CODE (bsi_stmt (si)) == region->type);
       bsi_remove (&si, true);
 
       new_bb = entry_bb;
@@ -2477,7 +2897,8 @@ expand_omp_parallel (struct omp_region *region)
 	 a function call that has been inlined, the original PARM_DECL
 	 .OMP_DATA_I may have been converted into a different local
 	 variable.  In which case, we need to keep the assignment.  */
-      if (OMP_PARALLEL_DATA_ARG (entry_stmt))
+      /* APPLE LOCAL libgomp tasks */
+      if (OMP_TASKREG_DATA_ARG (entry_stmt))
 	{
 	  basic_block entry_succ_bb = single_succ (entry_bb);
 	  block_stmt_iterator si;
@@ -2493,9 +2914,10 @@ expand_omp_parallel (struct omp_region *region)
 
 	      arg = TREE_OPERAND (stmt, 1);
 	      STRIP_NOPS (arg);
+	      /* APPLE LOCAL libgomp tasks */
 	      if (TREE_CODE (arg) == ADDR_EXPR
 		  && TREE_OPERAND (arg, 0)
-		     == OMP_PARALLEL_DATA_ARG (entry_stmt))
+		     == OMP_TASKREG_DATA_ARG (entry_stmt))
 		{
 		  if (TREE_OPERAND (stmt, 0) == DECL_ARGUMENTS (child_fn))
 		    bsi_remove (&si, true);
@@ -2522,7 +2944,8 @@ expand_omp_parallel (struct omp_region *region)
 	 child function.  */
       si = bsi_last (entry_bb);
       t = bsi_stmt (si);
-      gcc_assert (t && TREE_CODE (t) == OMP_PARALLEL);
+      /* APPLE LOCAL libgomp tasks */
+      gcc_assert (t && TREE_CODE (t) == region->type);
       bsi_remove (&si, true);
       e = split_block (entry_bb, t);
       entry_bb = e->dest;
@@ -2549,8 +2972,14 @@ expand_omp_parallel (struct omp_region *region)
 	}
     }
 
-  /* Emit a library call to launch the children threads.  */
-  expand_parallel_call (region, new_bb, entry_stmt, ws_args);
+  /* APPLE LOCAL begin libgomp tasks */
+  /* Emit a library call to launch the children threads, or to queue
+     the task.  */
+  if (region->type == OMP_PARALLEL)
+    expand_parallel_call (region, new_bb, entry_stmt, ws_args);
+  else
+    expand_task_call (new_bb, entry_stmt);
+  /* APPLE LOCAL end libgomp tasks */
 
   if (do_cleanup_cfg)
     {
@@ -3427,9 +3856,12 @@ expand_omp (struct omp_region *region)
 
       switch (region->type)
 	{
+	/* APPLE LOCAL begin libgomp tasks */
 	case OMP_PARALLEL:
-	  expand_omp_parallel (region);
+	case OMP_TASK:
+	  expand_omp_taskreg (region);
 	  break;
+	/* APPLE LOCAL end libgomp tasks */
 
 	case OMP_FOR:
 	  expand_omp_for (region);
@@ -4145,11 +4577,12 @@ check_combined_parallel (tree *tp, int *walk_subtrees, void *data)
   return NULL;
 }
 
-/* Lower the OpenMP parallel directive in *STMT_P.  CTX holds context
-   information for the directive.  */
+/* APPLE LOCAL begin libgomp tasks */
+/* Lower the OpenMP parallel or task directive in *STMT_P.  CTX holds
+   context information for the directive.  */
 
 static void
-lower_omp_parallel (tree *stmt_p, omp_context *ctx)
+lower_omp_taskreg (tree *stmt_p, omp_context *ctx)
 {
   tree clauses, par_bind, par_body, new_body, bind;
   tree olist, ilist, par_olist, par_ilist;
@@ -4157,11 +4590,12 @@ lower_omp_parallel (tree *stmt_p, omp_context *ctx)
 
   stmt = *stmt_p;
 
-  clauses = OMP_PARALLEL_CLAUSES (stmt);
-  par_bind = OMP_PARALLEL_BODY (stmt);
+  clauses = OMP_TASKREG_CLAUSES (stmt);
+  par_bind = OMP_TASKREG_BODY (stmt);
   par_body = BIND_EXPR_BODY (par_bind);
   child_fn = ctx->cb.dst_fn;
-  if (!OMP_PARALLEL_COMBINED (stmt))
+  if (TREE_CODE (stmt) == OMP_PARALLEL && !OMP_PARALLEL_COMBINED (stmt))
+  /* APPLE LOCAL end libgomp tasks */
     {
       struct walk_stmt_info wi;
       int ws_num = 0;
@@ -4191,7 +4625,8 @@ lower_omp_parallel (tree *stmt_p, omp_context *ctx)
   if (ctx->record_type)
     {
       ctx->sender_decl = create_tmp_var (ctx->record_type, ".omp_data_o");
-      OMP_PARALLEL_DATA_ARG (stmt) = ctx->sender_decl;
+      /* APPLE LOCAL libgomp tasks */
+      OMP_TASKREG_DATA_ARG (stmt) = ctx->sender_decl;
     }
 
   olist = NULL_TREE;
@@ -4221,7 +4656,8 @@ lower_omp_parallel (tree *stmt_p, omp_context *ctx)
   maybe_catch_exception (&new_body);
   t = make_node (OMP_RETURN);
   append_to_statement_list (t, &new_body);
-  OMP_PARALLEL_BODY (stmt) = new_body;
+  /* APPLE LOCAL libgomp tasks */
+  OMP_TASKREG_BODY (stmt) = new_body;
 
   append_to_statement_list (stmt, &BIND_EXPR_BODY (bind));
   append_to_statement_list (olist, &BIND_EXPR_BODY (bind));
@@ -4301,7 +4737,8 @@ lower_omp_1 (tree *tp, int *walk_subtrees, void *data)
   /* If we have issued syntax errors, avoid doing any heavy lifting.
      Just replace the OpenMP directives with a NOP to avoid
      confusing RTL expansion.  */
-  if (errorcount && OMP_DIRECTIVE_P (*tp))
+  /* APPLE LOCAL libgomp tasks */
+  if ((errorcount || sorrycount) && OMP_DIRECTIVE_P (*tp))
     {
       *tp = build_empty_stmt ();
       return NULL_TREE;
@@ -4310,10 +4747,13 @@ lower_omp_1 (tree *tp, int *walk_subtrees, void *data)
   *walk_subtrees = 0;
   switch (TREE_CODE (*tp))
     {
+    /* APPLE LOCAL begin libgomp tasks */
     case OMP_PARALLEL:
+    case OMP_TASK:
       ctx = maybe_lookup_ctx (t);
-      lower_omp_parallel (tp, ctx);
+      lower_omp_taskreg (tp, ctx);
       break;
+    /* APPLE LOCAL end libgomp tasks */
 
     case OMP_FOR:
       ctx = maybe_lookup_ctx (t);
@@ -4363,7 +4803,25 @@ lower_omp_1 (tree *tp, int *walk_subtrees, void *data)
 		t = init_tmp_var (t, &wi->tsi);
 	    }
 	  *tp = t;
+	  /* APPLE LOCAL libgomp tasks */
+	  break;
+	}
+      /* APPLE LOCAL begin libgomp tasks */
+      /* FALLTHRU */
+
+    case PARM_DECL:
+      /* A variable that a task shares was a register when this statement
+	 was gimplified, but is in memory now.  */
+      if (wi->val_only
+	  && task_shared_vars
+	  && bitmap_bit_p (task_shared_vars, DECL_UID (t)))
+	{
+	  if (wi->is_lhs)
+	    *tp = save_tmp_var (t, &wi->tsi);
+	  else
+	    *tp = init_tmp_var (t, &wi->tsi);
 	}
+      /* APPLE LOCAL end libgomp tasks */
       break;
 
     case ADDR_EXPR:
@@ -4421,12 +4879,20 @@ execute_lower_omp (void)
   all_contexts = splay_tree_new (splay_tree_compare_pointers, 0,
 				 delete_omp_context);
 
+  /* APPLE LOCAL libgomp tasks */
+  walk_tree_without_duplicates (&DECL_SAVED_TREE (current_function_decl),
+				mark_task_shared_vars, NULL);
   scan_omp (&DECL_SAVED_TREE (current_function_decl), NULL);
   gcc_assert (parallel_nesting_level == 0);
 
   if (all_contexts->root)
     lower_omp (&DECL_SAVED_TREE (current_function_decl), NULL);
 
+  /* APPLE LOCAL begin libgomp tasks */
+  if (task_shared_vars)
+    BITMAP_FREE (task_shared_vars);
+  /* APPLE LOCAL end libgomp tasks */
+
   if (all_contexts)
     {
       splay_tree_delete (all_contexts);
@@ -4517,6 +4983,8 @@ diagnose_sb_1 (tree *tp, int *walk_subtrees, void *data)
   switch (TREE_CODE (t))
     {
     case OMP_PARALLEL:
+    /* APPLE LOCAL libgomp tasks */
+    case OMP_TASK:
     case OMP_SECTIONS:
     case OMP_SINGLE:
       walk_tree (&OMP_CLAUSES (t), diagnose_sb_1, wi, NULL);
@@ -4571,6 +5039,8 @@ diagnose_sb_2 (tree *tp, int *walk_subtrees, void *data)
   switch (TREE_CODE (t))
     {
     case OMP_PARALLEL:
+    /* APPLE LOCAL libgomp tasks */
+    case OMP_TASK:
     case OMP_SECTIONS:
     case OMP_SINGLE:
       walk_tree (&OMP_CLAUSES (t), diagnose_sb_2, wi, NULL);
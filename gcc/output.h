@@ -107,6 +107,13 @@ extern void output_address (rtx);
    that may appear in these expressions.  */
 extern void output_addr_const (FILE *, rtx);
 
+/* APPLE LOCAL begin asm output */
+/* Print an integer to a file as HOST_WIDE_INT_PRINT_HEX and
+   HOST_WIDE_INT_PRINT_DEC would, without going through fprintf.  */
+extern void fprint_whex (FILE *, unsigned HOST_WIDE_INT);
+extern void fprint_w (FILE *, HOST_WIDE_INT);
+/* APPLE LOCAL end asm output */
+
 /* Output a string of assembler code, substituting numbers, strings
    and fixed syntactic prefixes.  */
 #if GCC_VERSION >= 3004
@@ -489,8 +496,11 @@ struct unnamed_section GTY(()) {
 
   /* The callback used to switch to the section, and the data that
      should be passed to the callback.  */
-  unnamed_section_callback GTY ((skip)) callback;
-  const void *GTY ((skip)) data;
+  /* APPLE LOCAL begin relocatable PCH */
+  unnamed_section_callback GTY ((callback)) callback;
+  /* DATA is always static, as it must be for PCH.  */
+  const void *GTY ((callback)) data;
+  /* APPLE LOCAL end relocatable PCH */
 
   /* The next entry in the chain of unnamed sections.  */
   section *next;
@@ -514,7 +524,8 @@ struct noswitch_section GTY(()) {
   struct section_common common;
 
   /* The callback used to assemble decls in this section.  */
-  noswitch_section_callback GTY ((skip)) callback;
+  /* APPLE LOCAL relocatable PCH */
+  noswitch_section_callback GTY ((callback)) callback;
 };
 
 /* Information about a section, which may be named or unnamed.  */
@@ -832,6 +832,10 @@ execute_one_pass (struct tree_opt_pass *pass)
 {
   bool initializing_dump;
   unsigned int todo_after = 0;
+  /* APPLE LOCAL begin time report functions */
+  struct timevar_time_def fn_start;
+  bool fn_timed;
+  /* APPLE LOCAL end time report functions */
 
   /* See if we're supposed to run this pass.  */
   if (pass->gate && !pass->gate ())
@@ -880,6 +884,15 @@ execute_one_pass (struct tree_opt_pass *pass)
   if (pass->tv_id)
     timevar_push (pass->tv_id);
 
+  /* APPLE LOCAL begin time report functions */
+  /* Under -ftime-report-functions, also charge the time to the
+     function the pass works on.  */
+  fn_timed = (time_report_functions && pass->tv_id
+	      && current_function_decl);
+  if (fn_timed)
+    timevar_function_start (&fn_start);
+  /* APPLE LOCAL end time report functions */
+
   /* Do it!  */
   if (pass->execute)
     {
@@ -887,6 +900,16 @@ execute_one_pass (struct tree_opt_pass *pass)
       last_verified = 0;
     }
 
+  /* APPLE LOCAL begin time report functions */
+  if (fn_timed)
+    timevar_function_stop
+      (pass->tv_id, &fn_start,
+       IDENTIFIER_POINTER (DECL_ASSEMBLER_NAME (current_function_decl)),
+       lang_hooks.decl_printable_name (current_function_decl, 2),
+       DECL_SOURCE_FILE (current_function_decl),
+       DECL_SOURCE_LINE (current_function_decl));
+  /* APPLE LOCAL end time report functions */
+
   /* Stop timevar.  */
   if (pass->tv_id)
     timevar_pop (pass->tv_id);
@@ -905,7 +928,12 @@ execute_one_pass (struct tree_opt_pass *pass)
     }
 
   /* Run post-pass cleanup and verification.  */
+  /* APPLE LOCAL begin timevar memory */
+  /* What a collection here finds live is what the pass left.  */
+  timevar_set_ggc_owner (pass->tv_id);
   execute_todo (todo_after | pass->todo_flags_finish);
+  timevar_set_ggc_owner (TV_TOTAL);
+  /* APPLE LOCAL end timevar memory */
   verify_interpass_invariants ();
 
   /* Flush and close dump file.  */
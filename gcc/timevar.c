@@ -137,6 +137,23 @@ ppc_intrinsic_time (void)
 /* APPLE LOCAL Mach time */
 #endif /* HAVE_MACH_TIME */
 
+/* APPLE LOCAL begin timevar memory */
+/* getrusage also gives the peak resident set size.  */
+#ifdef HAVE_GETRUSAGE
+# if defined HAVE_DECL_GETRUSAGE && !HAVE_DECL_GETRUSAGE
+  extern int getrusage (int, struct rusage *);
+# endif
+# define HAVE_MAX_RSS
+#endif
+
+/* Darwin gives ru_maxrss in bytes, other hosts in kB.  */
+#ifdef __APPLE__
+# define MAX_RSS_KB(RUSAGE) ((size_t) (RUSAGE).ru_maxrss >> 10)
+#else
+# define MAX_RSS_KB(RUSAGE) ((size_t) (RUSAGE).ru_maxrss)
+#endif
+/* APPLE LOCAL end timevar memory */
+
 /* libc is very likely to have snuck a call to sysconf() into one of
    the underlying constants, and that can be very slow, so we have to
    precompute them.  Whose wonderful idea was it to make all those
@@ -153,6 +170,8 @@ static double clocks_to_msec;
 
 #include "flags.h"
 #include "timevar.h"
+/* APPLE LOCAL time report functions */
+#include "hashtab.h"
 
 bool timevar_enable;
 
@@ -188,6 +207,12 @@ struct timevar_def
   /* Nonzero if this timing variable was ever started or pushed onto
      the timing stack.  */
   unsigned used : 1;
+
+  /* APPLE LOCAL begin timevar memory */
+  /* The most GC memory left live by a collection made while this
+     timing variable was on the stack, or while it owned collections.  */
+  size_t ggc_live;
+  /* APPLE LOCAL end timevar memory */
 };
 
 /* An element on the timing stack.  Elapsed time is attributed to the
@@ -218,6 +243,13 @@ static struct timevar_stack_def *unused_stack_instances;
    element.  */
 static struct timevar_time_def start_time;
 
+/* APPLE LOCAL begin timevar memory */
+/* The timing variable that collections are also credited to, or NULL.
+   Passes are collected after their timing variable is popped, so this
+   names the pass whose leftovers a collection sees.  */
+static struct timevar_def *ggc_owner;
+/* APPLE LOCAL end timevar memory */
+
 static void get_time (struct timevar_time_def *);
 static void timevar_accumulate (struct timevar_time_def *,
 				struct timevar_time_def *,
@@ -234,6 +266,8 @@ get_time (struct timevar_time_def *now)
   now->sys  = 0;
   now->wall = 0;
   now->ggc_mem = timevar_ggc_mem_total;
+  /* APPLE LOCAL timevar memory */
+  now->max_rss = 0;
 
   if (!timevar_enable)
     return;
@@ -250,6 +284,8 @@ get_time (struct timevar_time_def *now)
     getrusage (RUSAGE_SELF, &rusage);
     now->user = rusage.ru_utime.tv_sec + rusage.ru_utime.tv_usec * 1e-6;
     now->sys  = rusage.ru_stime.tv_sec + rusage.ru_stime.tv_usec * 1e-6;
+    /* APPLE LOCAL timevar memory */
+    now->max_rss = MAX_RSS_KB (rusage);
 #endif
 #ifdef USE_CLOCK
     now->user = clock () * clocks_to_msec;
@@ -263,6 +299,15 @@ get_time (struct timevar_time_def *now)
 #endif
     /* APPLE LOCAL end Mach time */
   }
+  /* APPLE LOCAL begin timevar memory */
+#if defined (HAVE_MAX_RSS) && !defined (USE_GETRUSAGE)
+  {
+    struct rusage rusage;
+    getrusage (RUSAGE_SELF, &rusage);
+    now->max_rss = MAX_RSS_KB (rusage);
+  }
+#endif
+  /* APPLE LOCAL end timevar memory */
 }
 
 /* Add the difference between STOP_TIME and START_TIME to TIMER.  */
@@ -276,6 +321,8 @@ timevar_accumulate (struct timevar_time_def *timer,
   timer->sys += stop_time->sys - start_time->sys;
   timer->wall += stop_time->wall - start_time->wall;
   timer->ggc_mem += stop_time->ggc_mem - start_time->ggc_mem;
+  /* APPLE LOCAL timevar memory */
+  timer->max_rss += stop_time->max_rss - start_time->max_rss;
 }
 
 /* Initialize timing variables.  */
@@ -287,6 +334,8 @@ timevar_init (void)
 
   /* Zero all elapsed times.  */
   memset (timevars, 0, sizeof (timevars));
+  /* APPLE LOCAL timevar memory */
+  ggc_owner = NULL;
 
   /* Initialize the names of timing variables.  */
 #define DEFTIMEVAR(identifier__, name__) \
@@ -431,6 +480,334 @@ timevar_stop (timevar_id_t timevar)
   timevar_accumulate (&tv->elapsed, &tv->start_time, &now);
 }
 
+/* APPLE LOCAL begin asm output */
+/* Fill ELAPSED with the time attributed to TIMEVAR so far.  */
+
+void
+timevar_get (timevar_id_t timevar, struct timevar_time_def *elapsed)
+{
+  *elapsed = timevars[timevar].elapsed;
+}
+/* APPLE LOCAL end asm output */
+
+/* APPLE LOCAL begin timevar memory */
+/* Credit collections made from now on to TIMEVAR as well as to the
+   timing variables on the stack, until this is called again.  TV_TOTAL
+   means no timing variable.  */
+
+void
+timevar_set_ggc_owner (timevar_id_t timevar)
+{
+  ggc_owner = timevar == TV_TOTAL ? NULL : &timevars[timevar];
+}
+
+/* Note that a collection has just left LIVE bytes of GC memory in use.
+   Credit it to the timing variables on the stack, to the owner of
+   collections, and to TV_TOTAL.  */
+
+void
+timevar_ggc_collected (size_t live)
+{
+  struct timevar_stack_def *context;
+
+  if (!timevar_enable)
+    return;
+
+  for (context = stack; context; context = context->next)
+    context->timevar->ggc_live = MAX (context->timevar->ggc_live, live);
+  if (ggc_owner)
+    ggc_owner->ggc_live = MAX (ggc_owner->ggc_live, live);
+  timevars[TV_TOTAL].ggc_live = MAX (timevars[TV_TOTAL].ggc_live, live);
+}
+/* APPLE LOCAL end timevar memory */
+
+/* APPLE LOCAL begin time report functions */
+/* The time a timing variable took on one function.  */
+
+struct timevar_function_pass
+{
+  timevar_id_t id;
+
+  /* How many times it ran on the function.  */
+  unsigned count;
+
+  struct timevar_time_def elapsed;
+};
+
+/* The time the passes took on one function.  */
+
+struct timevar_function
+{
+  /* The assembler name of the function, which tells it apart from the
+     others, and the name to print.  */
+  const char *asm_name;
+  const char *name;
+
+  /* Where the function is.  */
+  const char *file;
+  int line;
+
+  /* The time all its passes took.  */
+  struct timevar_time_def elapsed;
+
+  /* The time each timing variable took, in the order they first
+     ran.  */
+  struct timevar_function_pass *passes;
+  unsigned n_passes, max_passes;
+};
+
+/* The functions timed so far, hashed by assembler name.  */
+static htab_t timevar_functions;
+
+/* How many timed passes are running; a pass that runs another only
+   counts once towards the time of the function.  */
+static int timevar_function_depth;
+
+static hashval_t
+timevar_function_hash (const void *p)
+{
+  return htab_hash_string (((const struct timevar_function *) p)->asm_name);
+}
+
+static int
+timevar_function_eq (const void *p1, const void *p2)
+{
+  return !strcmp (((const struct timevar_function *) p1)->asm_name,
+		  (const char *) p2);
+}
+
+/* Fill NOW with the time so far, as precisely as the host allows.  A
+   single pass on a single function often takes less than the tick of
+   times, so prefer getrusage and gettimeofday to it.  */
+
+static void
+get_fine_time (struct timevar_time_def *now)
+{
+  get_time (now);
+#if defined (HAVE_GETRUSAGE) && !defined (USE_GETRUSAGE)
+  {
+    struct rusage rusage;
+    getrusage (RUSAGE_SELF, &rusage);
+    now->user = rusage.ru_utime.tv_sec + rusage.ru_utime.tv_usec * 1e-6;
+    now->sys  = rusage.ru_stime.tv_sec + rusage.ru_stime.tv_usec * 1e-6;
+  }
+#endif
+#if defined (HAVE_GETTIMEOFDAY) && defined (USE_TIMES)
+  {
+    struct timeval tv;
+    gettimeofday (&tv, NULL);
+    now->wall = tv.tv_sec + tv.tv_usec * 1e-6;
+  }
+#endif
+}
+
+/* A pass is about to run on a function.  Fill START with the time, to
+   give to timevar_function_stop when it is done.  */
+
+void
+timevar_function_start (struct timevar_time_def *start)
+{
+  timevar_function_depth++;
+  get_fine_time (start);
+}
+
+/* The pass timed by TIMEVAR, which started at START, has run on the
+   function called NAME, with assembler name ASM_NAME, at FILE:LINE.
+   Add the time it took to the function.  */
+
+void
+timevar_function_stop (timevar_id_t timevar, struct timevar_time_def *start,
+		       const char *asm_name, const char *name,
+		       const char *file, int line)
+{
+  struct timevar_time_def now, elapsed;
+  struct timevar_function *fn;
+  unsigned i;
+  void **slot;
+
+  get_fine_time (&now);
+  memset (&elapsed, 0, sizeof (elapsed));
+  timevar_accumulate (&elapsed, start, &now);
+
+  if (!timevar_functions)
+    timevar_functions = htab_create (64, timevar_function_hash,
+				     timevar_function_eq, NULL);
+  slot = htab_find_slot_with_hash (timevar_functions, asm_name,
+				   htab_hash_string (asm_name), INSERT);
+  fn = (struct timevar_function *) *slot;
+  if (!fn)
+    {
+      fn = XCNEW (struct timevar_function);
+      fn->asm_name = xstrdup (asm_name);
+      fn->name = xstrdup (name);
+      fn->file = file;
+      fn->line = line;
+      *slot = fn;
+    }
+
+  if (--timevar_function_depth == 0)
+    timevar_accumulate (&fn->elapsed, start, &now);
+
+  for (i = 0; i < fn->n_passes; i++)
+    if (fn->passes[i].id == timevar)
+      break;
+  if (i == fn->n_passes)
+    {
+      if (fn->n_passes == fn->max_passes)
+	{
+	  fn->max_passes = fn->max_passes * 2 + 16;
+	  fn->passes = XRESIZEVEC (struct timevar_function_pass, fn->passes,
+				   fn->max_passes);
+	}
+      memset (&fn->passes[i], 0, sizeof (fn->passes[i]));
+      fn->passes[i].id = timevar;
+      fn->n_passes++;
+    }
+  fn->passes[i].count++;
+  timevar_accumulate (&fn->passes[i].elapsed, start, &now);
+}
+
+/* The processor time in ELAPSED, for sorting.  */
+
+static double
+cpu_time (const struct timevar_time_def *elapsed)
+{
+  return elapsed->user + elapsed->sys;
+}
+
+/* qsort comparison functions putting the slowest functions and passes
+   first.  Ties go by name, so the order doesn't depend on hashing.  */
+
+static int
+slower_function_p (const void *p1, const void *p2)
+{
+  const struct timevar_function *f1
+    = *(const struct timevar_function *const *) p1;
+  const struct timevar_function *f2
+    = *(const struct timevar_function *const *) p2;
+  double t1 = cpu_time (&f1->elapsed), t2 = cpu_time (&f2->elapsed);
+
+  if (t1 != t2)
+    return t1 < t2 ? 1 : -1;
+  if (f1->elapsed.wall != f2->elapsed.wall)
+    return f1->elapsed.wall < f2->elapsed.wall ? 1 : -1;
+  return strcmp (f1->asm_name, f2->asm_name);
+}
+
+static int
+slower_pass_p (const void *p1, const void *p2)
+{
+  const struct timevar_function_pass *f1
+    = (const struct timevar_function_pass *) p1;
+  const struct timevar_function_pass *f2
+    = (const struct timevar_function_pass *) p2;
+  double t1 = cpu_time (&f1->elapsed), t2 = cpu_time (&f2->elapsed);
+
+  if (t1 != t2)
+    return t1 < t2 ? 1 : -1;
+  if (f1->elapsed.wall != f2->elapsed.wall)
+    return f1->elapsed.wall < f2->elapsed.wall ? 1 : -1;
+  return (int) f1->id - (int) f2->id;
+}
+
+static int
+add_timevar_function (void **slot, void *data)
+{
+  struct timevar_function ***next = (struct timevar_function ***) data;
+
+  *(*next)++ = (struct timevar_function *) *slot;
+  return 1;
+}
+
+/* Return the functions timed so far, slowest first, and their passes
+   likewise, and set *N to how many there are.  The caller frees the
+   vector.  */
+
+static struct timevar_function **
+sorted_timevar_functions (size_t *n)
+{
+  struct timevar_function **fns, **next;
+  size_t i;
+
+  *n = timevar_functions ? htab_elements (timevar_functions) : 0;
+  if (*n == 0)
+    return NULL;
+
+  fns = next = XNEWVEC (struct timevar_function *, *n);
+  htab_traverse_noresize (timevar_functions, add_timevar_function, &next);
+  qsort (fns, *n, sizeof (*fns), slower_function_p);
+  for (i = 0; i < *n; i++)
+    qsort (fns[i]->passes, fns[i]->n_passes, sizeof (*fns[i]->passes),
+	   slower_pass_p);
+  return fns;
+}
+
+/* Print a line of timevar_print_functions for NAME, which took
+   ELAPSED, to FP.  */
+
+static void
+print_function_row (FILE *fp, const char *name,
+		    const struct timevar_time_def *elapsed)
+{
+  const struct timevar_time_def *total = &timevars[TV_TOTAL].elapsed;
+
+  fprintf (fp, " %-22s:", name);
+  fprintf (fp, "%7.3f (%2.0f%%) usr",
+	   elapsed->user,
+	   (total->user == 0 ? 0 : elapsed->user / total->user) * 100);
+  fprintf (fp, "%7.3f (%2.0f%%) sys",
+	   elapsed->sys,
+	   (total->sys == 0 ? 0 : elapsed->sys / total->sys) * 100);
+  fprintf (fp, "%7.3f (%2.0f%%) wall",
+	   elapsed->wall,
+	   (total->wall == 0 ? 0 : elapsed->wall / total->wall) * 100);
+  fprintf (fp, "%8lu kB ggc", (unsigned long) (elapsed->ggc_mem >> 10));
+}
+
+/* Summarize the time the passes took on each function to FP, slowest
+   function and pass first.  Like timevar_print, this leaves out what
+   took next to no time.  */
+
+void
+timevar_print_functions (FILE *fp)
+{
+  struct timevar_function **fns;
+  size_t n, i;
+  unsigned j;
+  const double tiny = 5e-3;
+
+  fns = sorted_timevar_functions (&n);
+  if (!fns)
+    return;
+
+  fputs (_("\nExecution times by function (seconds)\n"), fp);
+  for (i = 0; i < n; i++)
+    {
+      struct timevar_function *fn = fns[i];
+
+      if (cpu_time (&fn->elapsed) < tiny && fn->elapsed.wall < tiny)
+	continue;
+
+      fprintf (fp, " %s (%s:%d)\n", fn->name, fn->file, fn->line);
+      print_function_row (fp, _("total"), &fn->elapsed);
+      putc ('\n', fp);
+      for (j = 0; j < fn->n_passes; j++)
+	{
+	  struct timevar_function_pass *pass = &fn->passes[j];
+
+	  if (cpu_time (&pass->elapsed) < tiny && pass->elapsed.wall < tiny)
+	    continue;
+	  print_function_row (fp, timevars[pass->id].name, &pass->elapsed);
+	  if (pass->count > 1)
+	    fprintf (fp, " (%u runs)", pass->count);
+	  putc ('\n', fp);
+	}
+    }
+
+  free (fns);
+}
+/* APPLE LOCAL end time report functions */
+
 /* Summarize timing variables to FP.  The timing variable TV_TOTAL has
    a special meaning -- it's considered to be the total elapsed time,
    for normalizing the others, and is displayed last.  */
@@ -484,7 +861,9 @@ timevar_print (FILE *fp)
       if (tv->elapsed.user < tiny
 	  && tv->elapsed.sys < tiny
 	  && tv->elapsed.wall < tiny
-	  && tv->elapsed.ggc_mem < GGC_MEM_BOUND)
+	  && tv->elapsed.ggc_mem < GGC_MEM_BOUND
+	  /* APPLE LOCAL timevar memory */
+	  && tv->elapsed.max_rss < (GGC_MEM_BOUND >> 10))
 	continue;
 
       /* The timing variable name.  */
@@ -518,6 +897,15 @@ timevar_print (FILE *fp)
 		? 0
 		: (float) tv->elapsed.ggc_mem / total->ggc_mem) * 100);
 
+      /* APPLE LOCAL begin timevar memory */
+      /* Print the most ggc memory a collection found live, and how
+	 much the peak resident set size grew.  */
+      fprintf (fp, "%8lu kB live", (unsigned long) (tv->ggc_live >> 10));
+#ifdef HAVE_MAX_RSS
+      fprintf (fp, "%8lu kB rss", (unsigned long) tv->elapsed.max_rss);
+#endif
+      /* APPLE LOCAL end timevar memory */
+
       putc ('\n', fp);
     }
 
@@ -535,7 +923,15 @@ timevar_print (FILE *fp)
   /* APPLE LOCAL time formatting */
   fprintf (fp, "          %7.2f", total->wall);
 #endif
-  fprintf (fp, "%8u kB\n", (unsigned) (total->ggc_mem >> 10));
+  /* APPLE LOCAL begin timevar memory */
+  fprintf (fp, "%8u kB          ", (unsigned) (total->ggc_mem >> 10));
+  fprintf (fp, "%8lu kB live",
+	   (unsigned long) (timevars[TV_TOTAL].ggc_live >> 10));
+#ifdef HAVE_MAX_RSS
+  fprintf (fp, "%8lu kB rss", (unsigned long) total->max_rss);
+#endif
+  putc ('\n', fp);
+  /* APPLE LOCAL end timevar memory */
 
 #ifdef ENABLE_CHECKING
   fprintf (fp, "Extra diagnostic checks enabled; compiler may run slowly.\n");
@@ -546,6 +942,195 @@ timevar_print (FILE *fp)
 	  || defined (HAVE_WALL_TIME) */
 }
 
+/* APPLE LOCAL begin timevar memory */
+/* Bring the elapsed time of the topmost timing variable up to date,
+   as timevar_print does.  */
+
+static void
+timevar_update (void)
+{
+  struct timevar_time_def now;
+
+  get_time (&now);
+  if (stack)
+    timevar_accumulate (&stack->timevar->elapsed, &start_time, &now);
+  start_time = now;
+}
+
+/* Write STR to FP as a JSON string.  */
+
+static void
+dump_json_string (FILE *fp, const char *str)
+{
+  putc ('"', fp);
+  for (; *str; str++)
+    {
+      unsigned char c = *str;
+      if (c == '"' || c == '\\')
+	fprintf (fp, "\\%c", c);
+      else if (c < ' ')
+	fprintf (fp, "\\u%04x", c);
+      else
+	putc (c, fp);
+    }
+  putc ('"', fp);
+}
+
+/* Write the fields of TV to FP as JSON members.  */
+
+static void
+dump_json_timevar (FILE *fp, struct timevar_def *tv)
+{
+  fprintf (fp, "\"user\": %.3f, \"sys\": %.3f, \"wall\": %.3f, ",
+	   tv->elapsed.user, tv->elapsed.sys, tv->elapsed.wall);
+  fprintf (fp, "\"ggc_bytes\": %lu, \"ggc_live_bytes\": %lu, "
+	   "\"rss_kb\": %lu",
+	   (unsigned long) tv->elapsed.ggc_mem, (unsigned long) tv->ggc_live,
+	   (unsigned long) tv->elapsed.max_rss);
+}
+
+/* Write the times in ELAPSED to FP as JSON members.  */
+
+static void
+dump_json_time (FILE *fp, const struct timevar_time_def *elapsed)
+{
+  fprintf (fp, "\"user\": %.6f, \"sys\": %.6f, \"wall\": %.6f, "
+	   "\"ggc_bytes\": %lu",
+	   elapsed->user, elapsed->sys, elapsed->wall,
+	   (unsigned long) elapsed->ggc_mem);
+}
+
+/* APPLE LOCAL begin time report functions */
+/* Write the time the passes took on each function to FP as a member of
+   the object timevar_dump_json writes, if any function was timed.  */
+
+static void
+dump_json_functions (FILE *fp)
+{
+  struct timevar_function **fns;
+  size_t n, i;
+  unsigned j;
+
+  fns = sorted_timevar_functions (&n);
+  if (!fns)
+    return;
+
+  fputs (",\n  \"functions\": [", fp);
+  for (i = 0; i < n; i++)
+    {
+      struct timevar_function *fn = fns[i];
+
+      fputs (i ? ",\n    { \"name\": " : "\n    { \"name\": ", fp);
+      dump_json_string (fp, fn->name);
+      fputs (", \"asm_name\": ", fp);
+      dump_json_string (fp, fn->asm_name);
+      fputs (", \"file\": ", fp);
+      dump_json_string (fp, fn->file);
+      fprintf (fp, ", \"line\": %d,\n      ", fn->line);
+      dump_json_time (fp, &fn->elapsed);
+      fputs (",\n      \"passes\": [", fp);
+      for (j = 0; j < fn->n_passes; j++)
+	{
+	  struct timevar_function_pass *pass = &fn->passes[j];
+
+	  fputs (j ? ",\n        { \"name\": " : "\n        { \"name\": ", fp);
+	  dump_json_string (fp, timevars[pass->id].name);
+	  fprintf (fp, ", \"count\": %u, ", pass->count);
+	  dump_json_time (fp, &pass->elapsed);
+	  fputs (" }", fp);
+	}
+      fputs (" ] }", fp);
+    }
+  fputs ("\n  ]", fp);
+
+  free (fns);
+}
+/* APPLE LOCAL end time report functions */
+
+/* Write every timing variable that was used to FP as a JSON object,
+   naming INPUT as the file compiled.  Unlike timevar_print, this
+   leaves nothing out.  */
+
+void
+timevar_dump_json (FILE *fp, const char *input)
+{
+  unsigned int /* timevar_id_t */ id;
+  bool first = true;
+
+  if (!timevar_enable)
+    return;
+  timevar_update ();
+
+  fputs ("{\n  \"file\": ", fp);
+  dump_json_string (fp, input ? input : "");
+  fputs (",\n  \"timevars\": [", fp);
+  for (id = 0; id < (unsigned int) TIMEVAR_LAST; ++id)
+    {
+      struct timevar_def *tv = &timevars[(timevar_id_t) id];
+
+      if ((timevar_id_t) id == TV_TOTAL || !tv->used)
+	continue;
+      fputs (first ? "\n    { \"name\": " : ",\n    { \"name\": ", fp);
+      dump_json_string (fp, tv->name);
+      fputs (", ", fp);
+      dump_json_timevar (fp, tv);
+      fputs (" }", fp);
+      first = false;
+    }
+  fputs ("\n  ]", fp);
+  /* APPLE LOCAL time report functions */
+  dump_json_functions (fp);
+  fputs (",\n  \"total\": { ", fp);
+  dump_json_timevar (fp, &timevars[TV_TOTAL]);
+  fputs (" }\n}\n", fp);
+}
+
+/* Write STR to FP as a CSV field.  */
+
+static void
+dump_csv_string (FILE *fp, const char *str)
+{
+  putc ('"', fp);
+  for (; *str; str++)
+    {
+      if (*str == '"')
+	putc ('"', fp);
+      putc (*str, fp);
+    }
+  putc ('"', fp);
+}
+
+/* Write every timing variable that was used, TV_TOTAL included, to FP
+   as CSV, one row each, naming INPUT as the file compiled.  */
+
+void
+timevar_dump_csv (FILE *fp, const char *input)
+{
+  unsigned int /* timevar_id_t */ id;
+
+  if (!timevar_enable)
+    return;
+  timevar_update ();
+
+  fputs ("file,timevar,user,sys,wall,ggc_bytes,ggc_live_bytes,rss_kb\n", fp);
+  for (id = 0; id < (unsigned int) TIMEVAR_LAST; ++id)
+    {
+      struct timevar_def *tv = &timevars[(timevar_id_t) id];
+
+      if (!tv->used)
+	continue;
+      dump_csv_string (fp, input ? input : "");
+      putc (',', fp);
+      dump_csv_string (fp, tv->name);
+      fprintf (fp, ",%.3f,%.3f,%.3f,%lu,%lu,%lu\n",
+	       tv->elapsed.user, tv->elapsed.sys, tv->elapsed.wall,
+	       (unsigned long) tv->elapsed.ggc_mem,
+	       (unsigned long) tv->ggc_live,
+	       (unsigned long) tv->elapsed.max_rss);
+    }
+}
+/* APPLE LOCAL end timevar memory */
+
 /* Prints a message to stderr stating that time elapsed in STR is
    TOTAL (given in microseconds).  */
 
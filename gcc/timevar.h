@@ -63,7 +63,12 @@ struct timevar_time_def
   double wall;
 
   /* Garbage collector memory.  */
-  unsigned ggc_mem;
+  /* APPLE LOCAL begin timevar memory */
+  size_t ggc_mem;
+
+  /* Peak resident set size of this process, in kB.  */
+  size_t max_rss;
+  /* APPLE LOCAL end timevar memory */
 };
 
 /* An enumeration of timing variable identifiers.  Constructed from
@@ -90,6 +95,21 @@ extern void timevar_pop_1 (timevar_id_t);
 extern void timevar_start (timevar_id_t);
 extern void timevar_stop (timevar_id_t);
 extern void timevar_print (FILE *);
+/* APPLE LOCAL asm output */
+extern void timevar_get (timevar_id_t, struct timevar_time_def *);
+/* APPLE LOCAL begin timevar memory */
+extern void timevar_set_ggc_owner (timevar_id_t);
+extern void timevar_ggc_collected (size_t);
+extern void timevar_dump_json (FILE *, const char *);
+extern void timevar_dump_csv (FILE *, const char *);
+/* APPLE LOCAL end timevar memory */
+/* APPLE LOCAL begin time report functions */
+extern void timevar_function_start (struct timevar_time_def *);
+extern void timevar_function_stop (timevar_id_t, struct timevar_time_def *,
+				   const char *, const char *, const char *,
+				   int);
+extern void timevar_print_functions (FILE *);
+/* APPLE LOCAL end time report functions */
 
 /* Provided for backward compatibility.  */
 extern void print_time (const char *, long);
@@ -1382,6 +1382,19 @@ get_arguments (void)
 }
 /* APPLE LOCAL end option verifier 4957887 */
 
+/* APPLE LOCAL begin asm output */
+/* The size of the stdio buffer for the assembly output file.  Assembly
+   is written a few bytes at a time; a large buffer turns that into a
+   few large writes, which matters most when the assembler reads it
+   through a pipe.  */
+#ifndef ASM_OUTPUT_BUFFER_SIZE
+#define ASM_OUTPUT_BUFFER_SIZE (64 * 1024)
+#endif
+
+/* The number of bytes of assembly written, for -ftime-report.  */
+static long asm_output_bytes;
+/* APPLE LOCAL end asm output */
+
 /* Open assembly code output file.  Do this even if -fsyntax-only is
    on, because then the driver will have provided the name of a
    temporary file or bit bucket for us.  NAME is the file specified on
@@ -1422,6 +1435,12 @@ init_asm_output (const char *name)
 	fatal_error ("can%'t open %s for writing: %m", asm_file_name);
     }
 
+  /* APPLE LOCAL begin asm output */
+  /* Some C libraries ignore the size unless given the buffer too.  */
+  setvbuf (asm_out_file, XNEWVEC (char, ASM_OUTPUT_BUFFER_SIZE), _IOFBF,
+	   ASM_OUTPUT_BUFFER_SIZE);
+  /* APPLE LOCAL end asm output */
+
   if (!flag_syntax_only)
     {
       targetm.asm_out.file_start ();
@@ -2130,6 +2149,11 @@ finalize (void)
     {
       if (ferror (asm_out_file) != 0)
 	fatal_error ("error writing to %s: %m", asm_file_name);
+      /* APPLE LOCAL begin asm output */
+      /* This fails, harmlessly, when writing to a pipe.  */
+      if (time_report)
+	asm_output_bytes = ftell (asm_out_file);
+      /* APPLE LOCAL end asm output */
       /* APPLE LOCAL begin ss2 */
       if (flag_save_repository
 	  && flag_pch_file 
@@ -2160,14 +2184,79 @@ finalize (void)
   lang_hooks.finish ();
 }
 
+/* APPLE LOCAL begin asm output */
+/* Under -ftime-report, say how much assembly was written, and how fast
+   the passes that write most of it went.  */
+
+static void
+print_asm_output_rate (void)
+{
+  struct timevar_time_def final_time, symout_time, varconst_time;
+  double secs;
+
+  if (!time_report || asm_output_bytes <= 0)
+    return;
+
+  timevar_get (TV_FINAL, &final_time);
+  timevar_get (TV_SYMOUT, &symout_time);
+  timevar_get (TV_VARCONST, &varconst_time);
+  secs = (final_time.user + final_time.sys
+	  + symout_time.user + symout_time.sys
+	  + varconst_time.user + varconst_time.sys);
+
+  fprintf (stderr, " %-22s:%10ld bytes", "assembly output",
+	   asm_output_bytes);
+  if (secs > 0)
+    fprintf (stderr, ", %.1f MB/s in final, symout and varconst",
+	     asm_output_bytes / secs / 1e6);
+  fputc ('\n', stderr);
+}
+/* APPLE LOCAL end asm output */
+
+/* APPLE LOCAL begin timevar memory */
+/* Write the timing variables to the files named by -ftime-report-csv=
+   and -ftime-report-json=.  */
+
+static void
+dump_time_report (void)
+{
+  FILE *fp;
+
+  if (time_report_csv)
+    {
+      fp = fopen (time_report_csv, "w");
+      if (!fp)
+	fatal_error ("can%'t open %s for writing: %m", time_report_csv);
+      timevar_dump_csv (fp, main_input_filename);
+      if (fclose (fp) != 0)
+	fatal_error ("error closing %s: %m", time_report_csv);
+    }
+
+  if (time_report_json)
+    {
+      fp = fopen (time_report_json, "w");
+      if (!fp)
+	fatal_error ("can%'t open %s for writing: %m", time_report_json);
+      timevar_dump_json (fp, main_input_filename);
+      if (fclose (fp) != 0)
+	fatal_error ("error closing %s: %m", time_report_json);
+    }
+}
+/* APPLE LOCAL end timevar memory */
+
 /* Initialize the compiler, and compile the input file.  */
 static void
 do_compile (void)
 {
   /* Initialize timing first.  The C front ends read the main file in
      the post_options hook, and C++ does file timings.  */
-  if (time_report || !quiet_flag  || flag_detailed_statistics)
+  /* APPLE LOCAL begin timevar memory */
+  if (time_report || !quiet_flag  || flag_detailed_statistics
+      /* APPLE LOCAL time report functions */
+      || time_report_functions
+      || time_report_csv || time_report_json)
     timevar_init ();
+  /* APPLE LOCAL end timevar memory */
   timevar_start (TV_TOTAL);
 
   process_options ();
@@ -2193,7 +2282,18 @@ do_compile (void)
 
   /* Stop timing and print the times.  */
   timevar_stop (TV_TOTAL);
-  timevar_print (stderr);
+  /* APPLE LOCAL begin timevar memory */
+  if (time_report || !quiet_flag  || flag_detailed_statistics)
+    timevar_print (stderr);
+  /* APPLE LOCAL end timevar memory */
+  /* APPLE LOCAL asm output */
+  print_asm_output_rate ();
+  /* APPLE LOCAL begin time report functions */
+  if (time_report_functions)
+    timevar_print_functions (stderr);
+  /* APPLE LOCAL end time report functions */
+  /* APPLE LOCAL timevar memory */
+  dump_time_report ();
 }
 
 /* Entry point of cc1, cc1plus, jc1, f771, etc.
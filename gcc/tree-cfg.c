@@ -525,6 +525,8 @@ make_edges (void)
 	      break;
 
 	    case OMP_PARALLEL:
+	    /* APPLE LOCAL libgomp tasks */
+	    case OMP_TASK:
 	    case OMP_FOR:
 	    case OMP_SINGLE:
 	    case OMP_MASTER:
@@ -220,6 +220,8 @@ is_gimple_stmt (tree t)
     case PHI_NODE:
     case STATEMENT_LIST:
     case OMP_PARALLEL:
+    /* APPLE LOCAL libgomp tasks */
+    case OMP_TASK:
     case OMP_FOR:
     case OMP_SECTIONS:
     case OMP_SECTION:
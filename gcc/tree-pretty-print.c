@@ -322,6 +322,11 @@ dump_omp_clause (pretty_printer *buffer, tree clause, int spc, int flags)
     case OMP_CLAUSE_ORDERED:
       pp_string (buffer, "ordered");
       break;
+    /* APPLE LOCAL begin libgomp tasks */
+    case OMP_CLAUSE_UNTIED:
+      pp_string (buffer, "untied");
+      break;
+    /* APPLE LOCAL end libgomp tasks */
 
     case OMP_CLAUSE_DEFAULT:
       pp_string (buffer, "default(");
@@ -1721,6 +1726,28 @@ dump_generic_node (pretty_printer *buffer, tree node, int spc, int flags,
 
 	  pp_string (buffer, ")]");
 	}
+      /* APPLE LOCAL begin libgomp tasks */
+      goto dump_omp_body;
+
+    case OMP_TASK:
+      pp_string (buffer, "#pragma omp task");
+      dump_omp_clauses (buffer, OMP_TASK_CLAUSES (node), spc, flags);
+      if (OMP_TASK_FN (node))
+	{
+	  pp_string (buffer, " [child fn: ");
+	  dump_generic_node (buffer, OMP_TASK_FN (node), spc, flags, false);
+
+	  pp_string (buffer, " (");
+
+	  if (OMP_TASK_DATA_ARG (node))
+	    dump_generic_node (buffer, OMP_TASK_DATA_ARG (node), spc, flags,
+			       false);
+	  else
+	    pp_string (buffer, "???");
+
+	  pp_string (buffer, ")]");
+	}
+      /* APPLE LOCAL end libgomp tasks */
 
     dump_omp_body:
       if (!(flags & TDF_SLIM) && OMP_BODY (node))
@@ -2064,6 +2064,8 @@ get_expr_operands (tree stmt, tree *expr_p, int flags)
     case LABEL_DECL:
     case CONST_DECL:
     case OMP_PARALLEL:
+    /* APPLE LOCAL libgomp tasks */
+    case OMP_TASK:
     case OMP_SECTIONS:
     case OMP_FOR:
     case OMP_SINGLE:
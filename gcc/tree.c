@@ -141,6 +141,11 @@ static GTY ((if_marked ("ggc_marked_p"), param_is (union tree_node)))
 
 /* General tree->tree mapping  structure for use in hash tables.  */
 
+/* APPLE LOCAL begin relocatable PCH */
+/* These tables hash decls by DECL_UID rather than by address, since
+   the hash is kept in each tree_map, and the decls in a PCH image are
+   not where they were when it was written.  */
+/* APPLE LOCAL end relocatable PCH */
 
 static GTY ((if_marked ("tree_map_marked_p"), param_is (struct tree_map))) 
      htab_t debug_expr_for_decl;
@@ -195,7 +200,10 @@ unsigned const char omp_clause_num_ops[] =
   1, /* OMP_CLAUSE_SCHEDULE  */
   0, /* OMP_CLAUSE_NOWAIT  */
   0, /* OMP_CLAUSE_ORDERED  */
-  0  /* OMP_CLAUSE_DEFAULT  */
+  /* APPLE LOCAL begin libgomp tasks */
+  0, /* OMP_CLAUSE_DEFAULT  */
+  0  /* OMP_CLAUSE_UNTIED  */
+  /* APPLE LOCAL end libgomp tasks */
 };
 
 const char * const omp_clause_code_name[] =
@@ -213,7 +221,10 @@ const char * const omp_clause_code_name[] =
   "schedule",
   "nowait",
   "ordered",
-  "default"
+  /* APPLE LOCAL begin libgomp tasks */
+  "default",
+  "untied"
+  /* APPLE LOCAL end libgomp tasks */
 };
 
 /* Init tree.c.  */
@@ -4057,8 +4068,8 @@ decl_restrict_base_lookup (tree from)
   struct tree_map in;
 
   in.from = from;
-  h = htab_find_with_hash (restrict_base_for_decl, &in,
-			   htab_hash_pointer (from));
+  /* APPLE LOCAL relocatable PCH */
+  h = htab_find_with_hash (restrict_base_for_decl, &in, DECL_UID (from));
   return h ? h->to : NULL_TREE;
 }
 
@@ -4071,7 +4082,8 @@ decl_restrict_base_insert (tree from, tree to)
   void **loc;
 
   h = ggc_alloc (sizeof (struct tree_map));
-  h->hash = htab_hash_pointer (from);
+  /* APPLE LOCAL relocatable PCH */
+  h->hash = DECL_UID (from);
   h->from = from;
   h->to = to;
   loc = htab_find_slot_with_hash (restrict_base_for_decl, h, h->hash, INSERT);
@@ -4122,7 +4134,8 @@ decl_debug_expr_lookup (tree from)
   struct tree_map *h, in;
   in.from = from;
 
-  h = htab_find_with_hash (debug_expr_for_decl, &in, htab_hash_pointer (from));
+  /* APPLE LOCAL relocatable PCH */
+  h = htab_find_with_hash (debug_expr_for_decl, &in, DECL_UID (from));
   if (h)
     return h->to;
   return NULL_TREE;
@@ -4137,7 +4150,8 @@ decl_debug_expr_insert (tree from, tree to)
   void **loc;
 
   h = ggc_alloc (sizeof (struct tree_map));
-  h->hash = htab_hash_pointer (from);
+  /* APPLE LOCAL relocatable PCH */
+  h->hash = DECL_UID (from);
   h->from = from;
   h->to = to;
   loc = htab_find_slot_with_hash (debug_expr_for_decl, h, h->hash, INSERT);
@@ -4152,7 +4166,8 @@ decl_value_expr_lookup (tree from)
   struct tree_map *h, in;
   in.from = from;
 
-  h = htab_find_with_hash (value_expr_for_decl, &in, htab_hash_pointer (from));
+  /* APPLE LOCAL relocatable PCH */
+  h = htab_find_with_hash (value_expr_for_decl, &in, DECL_UID (from));
   if (h)
     return h->to;
   return NULL_TREE;
@@ -4167,7 +4182,8 @@ decl_value_expr_insert (tree from, tree to)
   void **loc;
 
   h = ggc_alloc (sizeof (struct tree_map));
-  h->hash = htab_hash_pointer (from);
+  /* APPLE LOCAL relocatable PCH */
+  h->hash = DECL_UID (from);
   h->from = from;
   h->to = to;
   loc = htab_find_slot_with_hash (value_expr_for_decl, h, h->hash, INSERT);
@@ -7713,6 +7729,8 @@ walk_tree (tree *tp, walk_tree_fn func, void *data, struct pointer_set_t *pset)
 	case OMP_CLAUSE_NOWAIT:
 	case OMP_CLAUSE_ORDERED:
 	case OMP_CLAUSE_DEFAULT:
+	/* APPLE LOCAL libgomp tasks */
+	case OMP_CLAUSE_UNTIED:
 	  WALK_SUBTREE_TAIL (OMP_CLAUSE_CHAIN (*tp));
 
 	case OMP_CLAUSE_REDUCTION:
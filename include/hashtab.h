@@ -96,16 +96,19 @@ typedef void (*htab_free_with_arg) (void *, void *);
    functions mentioned below.  The size of this structure is subject to
    change.  */
 
+/* APPLE LOCAL begin relocatable PCH */
+/* The function pointers are marked 'callback' so that a precompiled
+   header can be used by a compiler loaded at a different address.  */
 struct htab GTY(())
 {
   /* Pointer to hash function.  */
-  htab_hash hash_f;
+  htab_hash GTY ((callback)) hash_f;
 
   /* Pointer to comparison function.  */
-  htab_eq eq_f;
+  htab_eq GTY ((callback)) eq_f;
 
   /* Pointer to cleanup function.  */
-  htab_del del_f;
+  htab_del GTY ((callback)) del_f;
 
   /* Table itself.  */
   void ** GTY ((use_param, length ("%h.size"))) entries;
@@ -128,18 +131,27 @@ struct htab GTY(())
   unsigned int collisions;
 
   /* Pointers to allocate/free functions.  */
-  htab_alloc alloc_f;
-  htab_free free_f;
+  htab_alloc GTY ((callback)) alloc_f;
+  htab_free GTY ((callback)) free_f;
 
   /* Alternate allocate/free functions, which take an extra argument.  */
   void * GTY((skip)) alloc_arg;
-  htab_alloc_with_arg alloc_with_arg_f;
-  htab_free_with_arg free_with_arg_f;
+  htab_alloc_with_arg GTY ((callback)) alloc_with_arg_f;
+  htab_free_with_arg GTY ((callback)) free_with_arg_f;
 
   /* Current size (in entries) of the hash table, as an index into the
      table of primes.  */
   unsigned int size_prime_index;
+
+  /* APPLE LOCAL begin htab cached hashes */
+  /* If not NULL, the hash of the entry in each slot.  The table is then
+     a power of two in size, 1 << SIZE_LOG2, and probed linearly.  See
+     htab_cache_hashes.  */
+  hashval_t * GTY ((skip)) hashes;
+  unsigned int size_log2;
+  /* APPLE LOCAL end htab cached hashes */
 };
+/* APPLE LOCAL end relocatable PCH */
 
 typedef struct htab *htab_t;
 
@@ -168,6 +180,12 @@ extern void	htab_set_functions_ex (htab_t, htab_hash,
 
 extern void	htab_delete (htab_t);
 extern void	htab_empty (htab_t);
+/* APPLE LOCAL begin htab cached hashes */
+extern int	htab_cache_hashes (htab_t);
+extern int	htab_insert_bulk (htab_t, void **, size_t);
+/* APPLE LOCAL end htab cached hashes */
+/* APPLE LOCAL relocatable PCH */
+extern int	htab_rehash (htab_t);
 
 extern void *	htab_find (htab_t, const void *);
 extern void **	htab_find_slot (htab_t, const void *, enum insert_option);
@@ -92,26 +92,28 @@ struct splay_tree_node_s GTY(())
 };
 
 /* The splay tree itself.  */
+/* APPLE LOCAL begin relocatable PCH */
 struct splay_tree_s GTY(())
 {
   /* The root of the tree.  */
   splay_tree_node GTY ((use_params)) root;
 
   /* The comparision function.  */
-  splay_tree_compare_fn comp;
+  splay_tree_compare_fn GTY ((callback)) comp;
 
   /* The deallocate-key function.  NULL if no cleanup is necessary.  */
-  splay_tree_delete_key_fn delete_key;
+  splay_tree_delete_key_fn GTY ((callback)) delete_key;
 
   /* The deallocate-value function.  NULL if no cleanup is necessary.  */
-  splay_tree_delete_value_fn delete_value;
+  splay_tree_delete_value_fn GTY ((callback)) delete_value;
 
   /* Allocate/free functions, and a data pointer to pass to them.  */
-  splay_tree_allocate_fn allocate;
-  splay_tree_deallocate_fn deallocate;
+  splay_tree_allocate_fn GTY ((callback)) allocate;
+  splay_tree_deallocate_fn GTY ((callback)) deallocate;
   void * GTY((skip)) allocate_data;
 
 };
+/* APPLE LOCAL end relocatable PCH */
 typedef struct splay_tree_s *splay_tree;
 
 extern splay_tree splay_tree_new        (splay_tree_compare_fn,
@@ -1683,10 +1683,15 @@ _cpp_convert_input (cpp_reader *pfile, const char *input_charset,
   if (input_cset.func == convert_using_iconv)
     iconv_close (input_cset.cd);
 
+  /* APPLE LOCAL begin vectorized line scanning */
   /* Resize buffer if we allocated substantially too much, or if we
-     haven't enough space for the \n-terminator.  */
-  if (to.len + 4096 < to.asize || to.len >= to.asize)
-    to.text = XRESIZEVEC (uchar, to.text, to.len + 1);
+     haven't enough space for the \n-terminator.  The line scanner in
+     lex.c reads whole aligned blocks of up to 16 bytes, so leave room
+     for it to look past the terminator without reading memory
+     outside the allocation.  */
+  if (to.len + 4096 < to.asize || to.len + 16 > to.asize)
+    to.text = XRESIZEVEC (uchar, to.text, to.len + 16);
+  /* APPLE LOCAL end vectorized line scanning */
 
   /* If the file is using old-school Mac line endings (\r only),
      terminate with another \r, not an \n, so that we do not mistake
@@ -149,6 +149,22 @@ struct file_hash_entry
   } u;
 };
 
+/* APPLE LOCAL begin include guard identity */
+/* A file with a multiple-include guard, identified by what stat(2)
+   says about it rather than by name.  A header included once through
+   a symlink, a different -I directory or a different relative path is
+   the same file, and needn't be read and lexed again to find that its
+   guard is defined.  */
+struct guarded_file
+{
+  dev_t dev;
+  ino_t ino;
+  off_t size;
+  time_t mtime;
+  const cpp_hashnode *cmacro;
+};
+/* APPLE LOCAL end include guard identity */
+
 static bool open_file (_cpp_file *file);
 static bool pch_open_file (cpp_reader *pfile, _cpp_file *file,
 			   bool *invalid_pch);
@@ -179,6 +195,15 @@ static bool validate_pch (cpp_reader *, _cpp_file *file, const char *pchname);
 static int pchf_save_compare (const void *e1, const void *e2);
 static int pchf_compare (const void *d_p, const void *e_p);
 static bool check_file_against_entries (cpp_reader *, _cpp_file *, bool);
+/* APPLE LOCAL header cache */
+static int hdr_cache_lookup (cpp_reader *, _cpp_file *);
+/* APPLE LOCAL begin include guard identity */
+static bool identity_known_p (const _cpp_file *);
+static hashval_t guarded_file_hash (const void *);
+static int guarded_file_eq (const void *, const void *);
+static void note_guarded_file (cpp_reader *, _cpp_file *);
+static const cpp_hashnode *lookup_guarded_file (cpp_reader *, _cpp_file *);
+/* APPLE LOCAL end include guard identity */
 
 /* APPLE LOCAL begin distcc pch indirection --mrs */
 #include <sys/param.h>
@@ -371,6 +396,36 @@ find_file_in_dir (cpp_reader *pfile, _cpp_file *file, bool *invalid_pch)
   return false;
 }
 
+/* APPLE LOCAL begin header cache */
+/* Consult the persistent header cache before trying to open FILE->name
+   in FILE->dir.  Return 1 if the cache shows it isn't there, -1 if the
+   cache can't be used for this directory, and 0 if the file has to be
+   looked for; in that case, if it isn't found, the caller should call
+   _cpp_hdr_cache_note_absent.  Remapped names and directories with
+   their own way of constructing paths (header maps and frameworks) are
+   left alone.  */
+static int
+hdr_cache_lookup (cpp_reader *pfile, _cpp_file *file)
+{
+  char *path;
+  int absent;
+
+  if (pfile->hdr_cache == NULL
+      || file->dir->construct
+      || CPP_OPTION (pfile, remap)
+      || pfile->is_main_file
+      || file->name[0] == '\0')
+    return -1;
+
+  path = append_file_to_dir (file->name, file->dir);
+  absent = _cpp_hdr_cache_probe (pfile, file->dir->name, file->name, path)
+	   ? 1 : 0;
+  free (path);
+
+  return absent;
+}
+/* APPLE LOCAL end header cache */
+
 /* Return tue iff the missing_header callback found the given HEADER.  */
 static bool
 search_path_exhausted (cpp_reader *pfile, const char *header, _cpp_file *file)
@@ -440,8 +495,29 @@ _cpp_find_file (cpp_reader *pfile, const char *fname, cpp_dir *start_dir, bool f
   /* Try each path in the include chain.  */
   for (; !fake ;)
     {
-      if (find_file_in_dir (pfile, file, &invalid_pch))
+      /* APPLE LOCAL begin header cache */
+      int cached = hdr_cache_lookup (pfile, file);
+      /* Whether this directory had an invalid PCH.  INVALID_PCH stays
+	 set once any directory has had one, for the error below.  */
+      bool dir_invalid_pch = false;
+
+      if (cached > 0)
+	{
+	  file->err_no = ENOENT;
+	  file->path = file->name;
+	  pfile->include_stats.header_cache_skips++;
+	}
+      else if (find_file_in_dir (pfile, file, &dir_invalid_pch))
 	break;
+      else
+	{
+	  invalid_pch |= dir_invalid_pch;
+	  /* A directory with a PCH for the header must go on being
+	     searched, to report the PCH if it is invalid.  */
+	  if (cached == 0 && !dir_invalid_pch)
+	    _cpp_hdr_cache_note_absent (pfile);
+	}
+      /* APPLE LOCAL end header cache */
 
       file->dir = file->dir->next;
       if (file->dir == NULL)
@@ -520,6 +596,9 @@ read_file_guts (cpp_reader *pfile, _cpp_file *file)
   uchar *buf;
   bool regular;
 
+  /* APPLE LOCAL include guard identity */
+  pfile->include_stats.reads++;
+
   if (S_ISBLK (file->st.st_mode))
     {
       cpp_error (pfile, CPP_DL_ERROR, "%s is a block device", file->path);
@@ -632,10 +711,19 @@ static bool
 should_stack_file (cpp_reader *pfile, _cpp_file *file, bool import)
 {
   _cpp_file *f;
+  /* APPLE LOCAL begin include guard identity */
+  bool by_identity = false;
+
+  pfile->include_stats.requests++;
+  /* APPLE LOCAL end include guard identity */
 
   /* Skip once-only files.  */
   if (file->once_only)
-    return false;
+    {
+      /* APPLE LOCAL include guard identity */
+      pfile->include_stats.once_only_skips++;
+      return false;
+    }
 
   /* We must mark the file once-only if #import now, before header
      guard checks.  Otherwise, undefining the header guard might
@@ -646,13 +734,60 @@ should_stack_file (cpp_reader *pfile, _cpp_file *file, bool import)
 
       /* Don't stack files that have been stacked before.  */
       if (file->stack_count)
-	return false;
+	{
+	  /* APPLE LOCAL include guard identity */
+	  pfile->include_stats.once_only_skips++;
+	  return false;
+	}
+    }
+
+  /* APPLE LOCAL begin include guard identity */
+  /* FILE may be new under this name, yet be known to be guarded under
+     another.  */
+  if (file->cmacro == NULL && !file->pch)
+    {
+      file->cmacro = lookup_guarded_file (pfile, file);
+      by_identity = file->cmacro != NULL;
     }
+  /* APPLE LOCAL end include guard identity */
 
   /* Skip if the file had a header guard and the macro is defined.
      PCH relies on this appearing before the PCH handler below.  */
   if (file->cmacro && file->cmacro->type == NT_MACRO)
-    return false;
+    /* APPLE LOCAL begin include guard identity */
+    {
+      if (by_identity)
+	{
+	  int sysp = 0;
+
+	  /* It was opened when it was found; we won't read it.  */
+	  if (file->fd != -1)
+	    {
+	      close (file->fd);
+	      file->fd = -1;
+	    }
+
+	  /* Had it been read, this name would be a dependency and
+	     would count as stacked; keep both so.  An #import of it
+	     would have been rejected as a copy of the file seen
+	     before.  */
+	  if (!import)
+	    {
+	      if (pfile->buffer != NULL && file->dir != NULL)
+		sysp = MAX (pfile->buffer->sysp, file->dir->sysp);
+	      if (CPP_OPTION (pfile, deps.style) > !!sysp
+		  && !file->stack_count)
+		deps_add_dep (pfile->deps, file->path);
+	      file->stack_count++;
+	    }
+
+	  pfile->include_stats.identity_skips++;
+	}
+      else
+	pfile->include_stats.guard_skips++;
+      return false;
+    }
+    /* APPLE LOCAL end include guard identity */
 
   /* Handle PCH files immediately; don't stack them.  */
   if (file->pch)
@@ -699,6 +834,17 @@ should_stack_file (cpp_reader *pfile, _cpp_file *file, bool import)
 	  _cpp_file *ref_file;
 	  bool same_file_p = false;
 
+	  /* APPLE LOCAL begin include guard identity */
+	  /* The same file under another name needn't be compared.  */
+	  if (identity_known_p (f) && identity_known_p (file)
+	      && f->st.st_ino == file->st.st_ino
+	      && f->st.st_dev == file->st.st_dev)
+	    {
+	      pfile->include_stats.once_only_identity++;
+	      break;
+	    }
+	  /* APPLE LOCAL end include guard identity */
+
 	  if (f->buffer && !f->buffer_valid)
 	    {
 	      /* We already have a buffer but it is not valid, because
@@ -728,6 +874,11 @@ should_stack_file (cpp_reader *pfile, _cpp_file *file, bool import)
 	}
     }
 
+  /* APPLE LOCAL begin include guard identity */
+  if (f != NULL)
+    pfile->include_stats.once_only_skips++;
+  /* APPLE LOCAL end include guard identity */
+
   return f == NULL;
 }
 
@@ -1061,6 +1212,11 @@ _cpp_init_files (cpp_reader *pfile)
 					NULL, xcalloc, free);
   pfile->dir_hash = htab_create_alloc (127, file_hash_hash, file_hash_eq,
 					NULL, xcalloc, free);
+  /* APPLE LOCAL begin include guard identity */
+  pfile->guarded_files = htab_create_alloc (127, guarded_file_hash,
+					    guarded_file_eq, free,
+					    xcalloc, free);
+  /* APPLE LOCAL end include guard identity */
   allocate_file_hash_entries (pfile);
 }
 
@@ -1070,6 +1226,10 @@ _cpp_cleanup_files (cpp_reader *pfile)
 {
   htab_delete (pfile->file_hash);
   htab_delete (pfile->dir_hash);
+  /* APPLE LOCAL include guard identity */
+  htab_delete (pfile->guarded_files);
+  /* APPLE LOCAL header cache */
+  _cpp_hdr_cache_close (pfile);
 }
 
 /* Enter a file name in the hash for the sake of cpp_included.  */
@@ -1147,6 +1307,104 @@ _cpp_report_missing_guards (cpp_reader *pfile)
   htab_traverse (pfile->file_hash, report_missing_guard, &banner);
 }
 
+/* APPLE LOCAL begin include guard identity */
+/* Return true if FILE was opened and is a regular file with a
+   meaningful inode number, so that it can be recognized under another
+   name.  */
+static bool
+identity_known_p (const _cpp_file *file)
+{
+  return (file->err_no == 0 && file->path != NULL && file->path[0] != '\0'
+	  && S_ISREG (file->st.st_mode) && file->st.st_ino != 0);
+}
+
+static hashval_t
+guarded_file_hash (const void *p)
+{
+  const struct guarded_file *g = (const struct guarded_file *) p;
+  hashval_t h = iterative_hash_object (g->ino, 0);
+
+  h = iterative_hash_object (g->dev, h);
+  h = iterative_hash_object (g->size, h);
+  return iterative_hash_object (g->mtime, h);
+}
+
+static int
+guarded_file_eq (const void *p, const void *q)
+{
+  const struct guarded_file *g1 = (const struct guarded_file *) p;
+  const struct guarded_file *g2 = (const struct guarded_file *) q;
+
+  return (g1->ino == g2->ino && g1->dev == g2->dev
+	  && g1->size == g2->size && g1->mtime == g2->mtime);
+}
+
+/* Remember that FILE, just popped, is guarded, if it is.  */
+static void
+note_guarded_file (cpp_reader *pfile, _cpp_file *file)
+{
+  struct guarded_file *g, dummy;
+  void **slot;
+
+  if (file->cmacro == NULL || !identity_known_p (file))
+    return;
+
+  dummy.dev = file->st.st_dev;
+  dummy.ino = file->st.st_ino;
+  dummy.size = file->st.st_size;
+  dummy.mtime = file->st.st_mtime;
+  slot = htab_find_slot (pfile->guarded_files, &dummy, INSERT);
+  if (*slot == NULL)
+    {
+      g = XNEW (struct guarded_file);
+      *g = dummy;
+      g->cmacro = file->cmacro;
+      *slot = g;
+    }
+}
+
+/* Return the guard macro of the file FILE is, if it has been seen
+   under another name and found to be guarded.  */
+static const cpp_hashnode *
+lookup_guarded_file (cpp_reader *pfile, _cpp_file *file)
+{
+  struct guarded_file *g, dummy;
+
+  if (!identity_known_p (file))
+    return NULL;
+
+  dummy.dev = file->st.st_dev;
+  dummy.ino = file->st.st_ino;
+  dummy.size = file->st.st_size;
+  dummy.mtime = file->st.st_mtime;
+  g = (struct guarded_file *) htab_find (pfile->guarded_files, &dummy);
+
+  return g ? g->cmacro : NULL;
+}
+
+/* Report how #include directives were handled.  Triggered by
+   -fcpp-stats.  */
+void
+_cpp_report_include_stats (cpp_reader *pfile)
+{
+  fprintf (stderr, "#include statistics:\n");
+  fprintf (stderr, "  %u files to include, %u read\n",
+	   pfile->include_stats.requests, pfile->include_stats.reads);
+  fprintf (stderr, "  %u skipped by guard macro, %u of them by file identity\n",
+	   pfile->include_stats.guard_skips
+	   + pfile->include_stats.identity_skips,
+	   pfile->include_stats.identity_skips);
+  fprintf (stderr, "  %u once-only files skipped, %u of them by file identity\n",
+	   pfile->include_stats.once_only_skips,
+	   pfile->include_stats.once_only_identity);
+  fprintf (stderr, "  %lu guarded files known\n",
+	   (unsigned long) htab_elements (pfile->guarded_files));
+  if (pfile->hdr_cache)
+    fprintf (stderr, "  %u search path probes avoided by the header cache\n",
+	     pfile->include_stats.header_cache_skips);
+}
+/* APPLE LOCAL end include guard identity */
+
 /* Locate HEADER, and determine whether it is newer than the current
    file.  If it cannot be located or dated, return -1, if it is
    newer, return 1, otherwise 0.  */
@@ -1192,6 +1450,9 @@ _cpp_pop_file_buffer (cpp_reader *pfile, _cpp_file *file)
   if (pfile->mi_valid && file->cmacro == NULL)
     file->cmacro = pfile->mi_cmacro;
 
+  /* APPLE LOCAL include guard identity */
+  note_guarded_file (pfile, file);
+
   /* Invalidate control macros in the #including file.  */
   pfile->mi_valid = false;
 
@@ -1230,6 +1491,9 @@ cpp_set_include_chains (cpp_reader *pfile, cpp_dir *quote, cpp_dir *bracket,
       if (quote == bracket)
 	pfile->bracket_include = bracket;
     }
+
+  /* APPLE LOCAL header cache */
+  _cpp_hdr_cache_open (pfile);
 }
 
 /* Append the file name to the directory to create the path, but don't
@@ -0,0 +1,874 @@
+/* APPLE LOCAL file header cache */
+/* Part of CPP library.  (Persistent cache of failed header lookups.)
+   Copyright (C) 2010 Free Software Foundation, Inc.
+
+This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 2, or (at your option) any
+later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.  */
+
+/* Almost all of the open() calls made while searching the include
+   chain fail: a header in the Nth directory of the chain costs N-1
+   failed probes (twice that when looking for PCH files too), and every
+   compilation in a build repeats the same probes.  With
+   -fheader-cache=DIR, the probes that failed are remembered in a file
+   in DIR and later compilations skip them.
+
+   The file is named after an MD5 of the working directory and the
+   include chain given to cpp_set_include_chains, so that only
+   compilations searching the same directories share it.  It is mapped
+   read-only and holds an open-addressed table of (search directory,
+   header name) pairs known to be absent.  Each entry names a witness:
+   the directory that would have contained the header, along with its
+   mtime (or its absence) when the probe was made.  Creating a header
+   or a PCH file in the witness changes its mtime, so an entry is only
+   believed if its witness is unchanged.  Each witness is stat()ed at
+   most once per compilation, the first time an entry depends on it,
+   and many headers share a witness.
+
+   Nothing is written in place.  At the end of the compilation, if
+   anything was learned, the entries still known to be valid in the
+   mapped table, in the file currently on disk (another compilation may
+   have replaced it meanwhile) and those found by this compilation are
+   merged into a temporary file which is then renamed over the old
+   one.  Concurrent compilations therefore always see a complete file;
+   at worst one of them loses its additions.  The cache is purely an
+   optimization, so any I/O problem simply disables it.  */
+
+#include "config.h"
+#include "system.h"
+#include "cpplib.h"
+#include "internal.h"
+#include "hashtab.h"
+#include "md5.h"
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+
+#ifndef O_BINARY
+# define O_BINARY 0
+#endif
+
+#ifndef MAP_FAILED
+# define MAP_FAILED ((void *) -1)
+#endif
+
+/* Bumped whenever the layout below changes.  */
+static const char hc_magic[8] = "gcchc01";
+
+/* The file begins with this header, followed by N_DIRS witness
+   records, N_SLOTS entry slots and STRINGS_SIZE bytes of
+   NUL-terminated strings.  Strings are referred to by their offset;
+   offset zero is the empty string and marks an unused slot.  */
+struct hc_header
+{
+  char magic[8];
+  unsigned int dir_size;
+  unsigned int slot_size;
+  unsigned int n_dirs;
+  unsigned int n_slots;
+  unsigned int n_entries;
+  unsigned int strings_size;
+  unsigned char key[16];
+};
+
+/* A witness directory.  */
+struct hc_dir
+{
+  unsigned int name;
+  unsigned int exists;
+  time_t mtime;
+};
+
+/* HEADER was not found in search directory DIR; WITNESS indexes the
+   directory that would have contained it.  N_SLOTS is a power of two
+   and collisions are resolved by linear probing.  */
+struct hc_slot
+{
+  hashval_t hash;
+  unsigned int dir;
+  unsigned int header;
+  unsigned int witness;
+};
+
+/* A cache file in memory, validated.  */
+struct hc_image
+{
+  void *base;
+  size_t size;
+  bool mapped;
+  const struct hc_header *hdr;
+  const struct hc_dir *dirs;
+  const struct hc_slot *slots;
+  const char *strings;
+};
+
+/* What this compilation knows about a witness directory.  */
+struct hc_witness
+{
+  const char *name;
+  bool exists;
+  /* False if the stat() failed oddly, or the directory was modified
+     too recently for its mtime to catch a further change.  */
+  bool usable;
+  time_t mtime;
+  /* Index in the file being written, or -1.  */
+  int index;
+};
+
+/* An absent header.  */
+struct hc_entry
+{
+  hashval_t hash;
+  const char *dir;
+  const char *header;
+  struct hc_witness *witness;
+};
+
+/* A string being written, and its offset in the file.  */
+struct hc_string
+{
+  const char *s;
+  unsigned int offset;
+};
+
+/* Witness states for the directories of the mapped image.  */
+enum hc_state { HC_UNKNOWN = 0, HC_VALID, HC_STALE };
+
+struct hdr_cache
+{
+  /* The cache file, and its contents when the compilation started.  */
+  char *path;
+  struct hc_image image;
+  unsigned char key[16];
+
+  /* One enum hc_state per witness in IMAGE.  */
+  unsigned char *state;
+
+  /* Witnesses stat()ed by this compilation, and headers it found to
+     be absent.  */
+  htab_t witnesses;
+  htab_t entries;
+
+  /* The probe made by the last call to _cpp_hdr_cache_probe.  */
+  struct hc_entry pending;
+
+  /* When the compilation started.  */
+  time_t now;
+};
+
+/* Don't grow the file beyond this many entries.  */
+#define HC_MAX_ENTRIES (1 << 18)
+
+static hashval_t hc_hash (const char *, const char *);
+static hashval_t hash_witness (const void *);
+static int eq_witness (const void *, const void *);
+static hashval_t hash_entry (const void *);
+static int eq_entry (const void *, const void *);
+static hashval_t hash_string (const void *);
+static int eq_string (const void *, const void *);
+static bool hc_load (const char *, const unsigned char *, struct hc_image *);
+static void hc_unload (struct hc_image *);
+static const struct hc_slot *hc_find (const struct hc_image *, hashval_t,
+				      const char *, const char *);
+static struct hc_witness *get_witness (struct hdr_cache *, const char *);
+static bool image_witness_valid (struct hdr_cache *, unsigned int);
+static void merge_image (const struct hc_image *, htab_t, htab_t);
+static unsigned int intern_string (htab_t, char **, unsigned int *,
+				   unsigned int *, const char *);
+static bool write_cache (struct hdr_cache *, htab_t);
+
+/* Hash the entry for HEADER in search directory DIR.  The result is
+   stored in the file, so must not depend on anything but the two
+   strings.  */
+static hashval_t
+hc_hash (const char *dir, const char *header)
+{
+  return iterative_hash (header, strlen (header), htab_hash_string (dir));
+}
+
+static hashval_t
+hash_witness (const void *p)
+{
+  return htab_hash_string (((const struct hc_witness *) p)->name);
+}
+
+static int
+eq_witness (const void *p, const void *q)
+{
+  return strcmp (((const struct hc_witness *) p)->name,
+		 ((const struct hc_witness *) q)->name) == 0;
+}
+
+static hashval_t
+hash_entry (const void *p)
+{
+  return ((const struct hc_entry *) p)->hash;
+}
+
+static int
+eq_entry (const void *p, const void *q)
+{
+  const struct hc_entry *e1 = (const struct hc_entry *) p;
+  const struct hc_entry *e2 = (const struct hc_entry *) q;
+
+  return (e1->hash == e2->hash
+	  && strcmp (e1->header, e2->header) == 0
+	  && strcmp (e1->dir, e2->dir) == 0);
+}
+
+static hashval_t
+hash_string (const void *p)
+{
+  return htab_hash_string (((const struct hc_string *) p)->s);
+}
+
+static int
+eq_string (const void *p, const void *q)
+{
+  return strcmp (((const struct hc_string *) p)->s,
+		 ((const struct hc_string *) q)->s) == 0;
+}
+
+/* Read the cache file PATH into IMAGE, returning true if it exists
+   and is a well-formed cache for KEY.  */
+static bool
+hc_load (const char *path, const unsigned char *key, struct hc_image *image)
+{
+  const struct hc_header *hdr;
+  struct stat st;
+  size_t size;
+  int fd;
+
+  memset (image, 0, sizeof (*image));
+
+  fd = open (path, O_RDONLY | O_NOCTTY | O_BINARY, 0666);
+  if (fd == -1)
+    return false;
+  if (fstat (fd, &st) != 0 || !S_ISREG (st.st_mode)
+      || (size_t) st.st_size < sizeof (struct hc_header)
+      || (size_t) st.st_size != (unsigned long) st.st_size)
+    {
+      close (fd);
+      return false;
+    }
+
+  size = st.st_size;
+#ifdef HAVE_SYS_MMAN_H
+  image->base = mmap (NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (image->base == MAP_FAILED)
+    image->base = NULL;
+  else
+    image->mapped = true;
+#endif
+  if (image->base == NULL)
+    {
+      image->base = xmalloc (size);
+      if (read (fd, image->base, size) != (ssize_t) size)
+	{
+	  free (image->base);
+	  image->base = NULL;
+	}
+    }
+  close (fd);
+  if (image->base == NULL)
+    return false;
+  image->size = size;
+
+  hdr = (const struct hc_header *) image->base;
+  if (memcmp (hdr->magic, hc_magic, sizeof (hc_magic)) != 0
+      || hdr->dir_size != sizeof (struct hc_dir)
+      || hdr->slot_size != sizeof (struct hc_slot)
+      || memcmp (hdr->key, key, sizeof (hdr->key)) != 0
+      || hdr->n_slots == 0
+      || (hdr->n_slots & (hdr->n_slots - 1)) != 0
+      || hdr->n_slots > (1U << 28)
+      || hdr->n_entries >= hdr->n_slots
+      || hdr->n_dirs > hdr->n_entries
+      || hdr->strings_size == 0
+      || size != (sizeof (struct hc_header)
+		  + hdr->n_dirs * sizeof (struct hc_dir)
+		  + hdr->n_slots * sizeof (struct hc_slot)
+		  + hdr->strings_size))
+    {
+      hc_unload (image);
+      return false;
+    }
+
+  image->hdr = hdr;
+  image->dirs = (const struct hc_dir *) (hdr + 1);
+  image->slots = (const struct hc_slot *) (image->dirs + hdr->n_dirs);
+  image->strings = (const char *) (image->slots + hdr->n_slots);
+  if (image->strings[0] != '\0'
+      || image->strings[hdr->strings_size - 1] != '\0')
+    {
+      hc_unload (image);
+      return false;
+    }
+
+  return true;
+}
+
+static void
+hc_unload (struct hc_image *image)
+{
+  if (image->base == NULL)
+    return;
+#ifdef HAVE_SYS_MMAN_H
+  if (image->mapped)
+    munmap (image->base, image->size);
+  else
+#endif
+    free (image->base);
+  memset (image, 0, sizeof (*image));
+}
+
+/* Return the slot of IMAGE recording that HEADER is absent from DIR,
+   or NULL.  Offsets are checked as the file is not trusted.  */
+static const struct hc_slot *
+hc_find (const struct hc_image *image, hashval_t hash, const char *dir,
+	 const char *header)
+{
+  unsigned int mask, i, n;
+  const struct hc_slot *slot;
+
+  if (image->hdr == NULL)
+    return NULL;
+
+  mask = image->hdr->n_slots - 1;
+  for (i = hash & mask, n = 0; n <= mask; i = (i + 1) & mask, n++)
+    {
+      slot = &image->slots[i];
+      if (slot->header == 0)
+	break;
+      if (slot->hash == hash
+	  && slot->header < image->hdr->strings_size
+	  && slot->dir < image->hdr->strings_size
+	  && slot->witness < image->hdr->n_dirs
+	  && strcmp (image->strings + slot->header, header) == 0
+	  && strcmp (image->strings + slot->dir, dir) == 0)
+	return slot;
+    }
+
+  return NULL;
+}
+
+/* Return this compilation's record of directory NAME, stat()ing it
+   the first time.  */
+static struct hc_witness *
+get_witness (struct hdr_cache *hc, const char *name)
+{
+  struct hc_witness dummy, *w;
+  struct stat st;
+  void **slot;
+
+  dummy.name = name;
+  slot = htab_find_slot (hc->witnesses, &dummy, INSERT);
+  if (*slot)
+    return (struct hc_witness *) *slot;
+
+  w = XNEW (struct hc_witness);
+  w->name = xstrdup (name);
+  w->index = -1;
+  if (stat (name, &st) == 0)
+    {
+      /* A change within the second of the recorded mtime would go
+	 unnoticed.  Allow for some clock skew with network file
+	 systems too.  */
+      w->exists = S_ISDIR (st.st_mode);
+      w->mtime = w->exists ? st.st_mtime : 0;
+      w->usable = !w->exists || st.st_mtime + 2 <= hc->now;
+    }
+  else
+    {
+      w->exists = false;
+      w->mtime = 0;
+      w->usable = errno == ENOENT || errno == ENOTDIR;
+    }
+  *slot = w;
+
+  return w;
+}
+
+/* Return true if witness directory INDEX of the mapped image is as it
+   was when the image's entries depending on it were made.  */
+static bool
+image_witness_valid (struct hdr_cache *hc, unsigned int index)
+{
+  const struct hc_dir *d = &hc->image.dirs[index];
+  struct hc_witness *w;
+
+  if (hc->state[index] == HC_UNKNOWN)
+    {
+      hc->state[index] = HC_STALE;
+      if (d->name < hc->image.hdr->strings_size)
+	{
+	  w = get_witness (hc, hc->image.strings + d->name);
+	  if (w->usable && w->exists == (d->exists != 0)
+	      && w->mtime == d->mtime)
+	    hc->state[index] = HC_VALID;
+	}
+    }
+
+  return hc->state[index] == HC_VALID;
+}
+
+/* Open the header cache for the include chains just set, if
+   -fheader-cache was given.  */
+void
+_cpp_hdr_cache_open (cpp_reader *pfile)
+{
+  struct hdr_cache *hc;
+  struct md5_ctx ctx;
+  const char *cwd;
+  cpp_dir *dir;
+  char *p;
+  size_t len;
+  int i;
+
+  _cpp_hdr_cache_close (pfile);
+
+  /* When PCH files are redirected by a distributed build server,
+     a witness no longer covers the PCH files it should.  */
+  if (CPP_OPTION (pfile, header_cache) == NULL
+      || getenv ("GCC_INDIRECT_FILES"))
+    return;
+
+  cwd = getpwd ();
+  if (cwd == NULL)
+    return;
+
+  hc = XCNEW (struct hdr_cache);
+
+  md5_init_ctx (&ctx);
+  md5_process_bytes (cwd, strlen (cwd) + 1, &ctx);
+  for (dir = pfile->quote_include; dir; dir = dir->next)
+    {
+      if (dir == pfile->bracket_include)
+	md5_process_bytes ("<", 1, &ctx);
+      md5_process_bytes (dir->name, strlen (dir->name) + 1, &ctx);
+    }
+  md5_process_bytes (pfile->quote_ignores_source_dir ? "1" : "0", 1, &ctx);
+  md5_finish_ctx (&ctx, hc->key);
+
+  len = strlen (CPP_OPTION (pfile, header_cache));
+  hc->path = XNEWVEC (char, len + sizeof ("/hc-.db") + 32);
+  p = hc->path;
+  memcpy (p, CPP_OPTION (pfile, header_cache), len);
+  p += len;
+  if (len == 0 || !IS_DIR_SEPARATOR (p[-1]))
+    *p++ = '/';
+  p += sprintf (p, "hc-");
+  for (i = 0; i < 16; i++)
+    p += sprintf (p, "%02x", hc->key[i]);
+  strcpy (p, ".db");
+
+  hc->now = time (NULL);
+  hc->witnesses = htab_create_alloc (127, hash_witness, eq_witness, NULL,
+				     xcalloc, free);
+  hc->entries = htab_create_alloc (127, hash_entry, eq_entry, NULL,
+				   xcalloc, free);
+  if (hc_load (hc->path, hc->key, &hc->image))
+    hc->state = XCNEWVEC (unsigned char, hc->image.hdr->n_dirs);
+
+  pfile->hdr_cache = hc;
+}
+
+/* HEADER is about to be looked for in search directory DIR, at PATH.
+   Return true if the cache shows it is not there, otherwise remember
+   the probe for _cpp_hdr_cache_note_absent.  */
+bool
+_cpp_hdr_cache_probe (cpp_reader *pfile, const char *dir,
+		      const char *header, const char *path)
+{
+  struct hdr_cache *hc = pfile->hdr_cache;
+  const struct hc_slot *slot;
+  struct hc_entry *e;
+  const char *sep;
+  char *wname;
+  hashval_t hash;
+
+  hc->pending.witness = NULL;
+  hash = hc_hash (dir, header);
+
+  slot = hc_find (&hc->image, hash, dir, header);
+  if (slot && image_witness_valid (hc, slot->witness))
+    return true;
+
+  hc->pending.hash = hash;
+  hc->pending.dir = dir;
+  hc->pending.header = header;
+  e = (struct hc_entry *) htab_find_with_hash (hc->entries, &hc->pending,
+					       hash);
+  if (e)
+    return true;
+
+  /* The witness is the directory the header would be in, stat()ed
+     (if it hasn't been already) before the header is probed.  */
+  sep = strrchr (path, '/');
+#ifdef HAVE_DOS_BASED_FILE_SYSTEM
+  {
+    const char *sep2 = strrchr (path, '\\');
+    if (sep == NULL || (sep2 && sep2 > sep))
+      sep = sep2;
+  }
+#endif
+  if (sep == NULL)
+    wname = xstrdup (".");
+  else if (sep == path)
+    wname = xstrdup ("/");
+  else
+    {
+      wname = XNEWVEC (char, sep - path + 1);
+      memcpy (wname, path, sep - path);
+      wname[sep - path] = '\0';
+    }
+  hc->pending.witness = get_witness (hc, wname);
+  free (wname);
+
+  return false;
+}
+
+/* The probe passed to the last _cpp_hdr_cache_probe failed.  */
+void
+_cpp_hdr_cache_note_absent (cpp_reader *pfile)
+{
+  struct hdr_cache *hc = pfile->hdr_cache;
+  struct hc_entry *e;
+  void **slot;
+
+  if (hc->pending.witness == NULL || !hc->pending.witness->usable)
+    return;
+
+  slot = htab_find_slot_with_hash (hc->entries, &hc->pending,
+				   hc->pending.hash, INSERT);
+  if (*slot == NULL)
+    {
+      e = XNEW (struct hc_entry);
+      e->hash = hc->pending.hash;
+      e->dir = xstrdup (hc->pending.dir);
+      e->header = xstrdup (hc->pending.header);
+      e->witness = hc->pending.witness;
+      *slot = e;
+    }
+  hc->pending.witness = NULL;
+}
+
+/* Add the entries of IMAGE still believed valid to ENTRIES, and their
+   witnesses to WITNESSES.  A witness already in WITNESSES, either
+   because this compilation stat()ed it or because a more recent image
+   recorded it, overrides IMAGE's record of it.  */
+static void
+merge_image (const struct hc_image *image, htab_t witnesses, htab_t entries)
+{
+  const struct hc_slot *slot;
+  const struct hc_dir *d;
+  struct hc_witness dummy, *w;
+  struct hc_entry *e;
+  unsigned int i, size;
+  void **p;
+
+  if (image->hdr == NULL)
+    return;
+
+  size = image->hdr->strings_size;
+  for (i = 0; i < image->hdr->n_slots; i++)
+    {
+      if (htab_elements (entries) >= HC_MAX_ENTRIES)
+	return;
+
+      slot = &image->slots[i];
+      if (slot->header == 0 || slot->header >= size || slot->dir >= size
+	  || slot->witness >= image->hdr->n_dirs)
+	continue;
+      d = &image->dirs[slot->witness];
+      if (d->name == 0 || d->name >= size)
+	continue;
+
+      dummy.name = image->strings + d->name;
+      p = htab_find_slot (witnesses, &dummy, INSERT);
+      if (*p == NULL)
+	{
+	  w = XNEW (struct hc_witness);
+	  w->name = dummy.name;
+	  w->exists = d->exists != 0;
+	  w->usable = true;
+	  w->mtime = d->mtime;
+	  w->index = -1;
+	  *p = w;
+	}
+      w = (struct hc_witness *) *p;
+      if (!w->usable || w->exists != (d->exists != 0) || w->mtime != d->mtime)
+	continue;
+
+      e = XNEW (struct hc_entry);
+      e->hash = hc_hash (image->strings + slot->dir,
+			 image->strings + slot->header);
+      e->dir = image->strings + slot->dir;
+      e->header = image->strings + slot->header;
+      e->witness = w;
+      p = htab_find_slot_with_hash (entries, e, e->hash, INSERT);
+      if (*p == NULL)
+	*p = e;
+      else
+	free (e);
+    }
+}
+
+/* Return the offset of S in the string table *POOL of *USED bytes
+   (*ALLOC allocated), adding it if need be.  STRINGS maps the strings
+   added so far to their offsets.  */
+static unsigned int
+intern_string (htab_t strings, char **pool, unsigned int *used,
+	       unsigned int *alloc, const char *s)
+{
+  struct hc_string dummy, *str;
+  size_t len;
+  void **slot;
+
+  dummy.s = s;
+  slot = htab_find_slot (strings, &dummy, INSERT);
+  if (*slot)
+    return ((struct hc_string *) *slot)->offset;
+
+  len = strlen (s) + 1;
+  if (*used + len > *alloc)
+    {
+      *alloc = (*used + len) * 2;
+      *pool = XRESIZEVEC (char, *pool, *alloc);
+    }
+  memcpy (*pool + *used, s, len);
+
+  str = XNEW (struct hc_string);
+  str->s = s;
+  str->offset = *used;
+  *slot = str;
+  *used += len;
+
+  return str->offset;
+}
+
+/* Write ENTRIES to a temporary file and rename it over the cache
+   file.  Return true on success.  */
+static bool
+write_cache (struct hdr_cache *hc, htab_t entries)
+{
+  struct hc_header hdr;
+  struct hc_dir *dirs;
+  struct hc_slot *slots;
+  struct hc_entry *e;
+  htab_t strings;
+  char *pool, *tmp;
+  unsigned int used, alloc, mask, i, j;
+  bool ok;
+  FILE *f;
+  int fd;
+
+  memset (&hdr, 0, sizeof (hdr));
+  memcpy (hdr.magic, hc_magic, sizeof (hc_magic));
+  hdr.dir_size = sizeof (struct hc_dir);
+  hdr.slot_size = sizeof (struct hc_slot);
+  memcpy (hdr.key, hc->key, sizeof (hdr.key));
+  hdr.n_entries = htab_elements (entries);
+  for (hdr.n_slots = 64; hdr.n_slots < 2 * hdr.n_entries; hdr.n_slots *= 2)
+    ;
+
+  slots = XCNEWVEC (struct hc_slot, hdr.n_slots);
+  dirs = XNEWVEC (struct hc_dir, hdr.n_entries);
+  strings = htab_create_alloc (127, hash_string, eq_string, free,
+			       xcalloc, free);
+  alloc = 4096;
+  pool = XNEWVEC (char, alloc);
+  pool[0] = '\0';
+  used = 1;
+
+  mask = hdr.n_slots - 1;
+  for (i = 0; i < htab_size (entries); i++)
+    {
+      e = (struct hc_entry *) entries->entries[i];
+      if (e == HTAB_EMPTY_ENTRY || e == HTAB_DELETED_ENTRY)
+	continue;
+
+      if (e->witness->index < 0)
+	{
+	  struct hc_dir *d = &dirs[hdr.n_dirs];
+
+	  d->name = intern_string (strings, &pool, &used, &alloc,
+				   e->witness->name);
+	  d->exists = e->witness->exists;
+	  d->mtime = e->witness->mtime;
+	  e->witness->index = hdr.n_dirs++;
+	}
+
+      for (j = e->hash & mask; slots[j].header; j = (j + 1) & mask)
+	;
+      slots[j].hash = e->hash;
+      slots[j].dir = intern_string (strings, &pool, &used, &alloc, e->dir);
+      slots[j].header = intern_string (strings, &pool, &used, &alloc,
+				       e->header);
+      slots[j].witness = e->witness->index;
+    }
+  hdr.strings_size = used;
+  htab_delete (strings);
+
+  tmp = XNEWVEC (char, strlen (hc->path) + 32);
+  sprintf (tmp, "%s.%ld.tmp", hc->path, (long) getpid ());
+  fd = open (tmp, O_WRONLY | O_CREAT | O_EXCL | O_BINARY, 0666);
+  ok = fd != -1;
+  if (ok)
+    {
+      f = fdopen (fd, "wb");
+      if (f == NULL)
+	{
+	  close (fd);
+	  ok = false;
+	}
+      else
+	{
+	  ok = (fwrite (&hdr, sizeof (hdr), 1, f) == 1
+		&& fwrite (dirs, sizeof (struct hc_dir), hdr.n_dirs, f)
+		   == hdr.n_dirs
+		&& fwrite (slots, sizeof (struct hc_slot), hdr.n_slots, f)
+		   == hdr.n_slots
+		&& fwrite (pool, 1, used, f) == used);
+	  if (fclose (f) != 0)
+	    ok = false;
+	}
+      if (ok)
+	ok = rename (tmp, hc->path) == 0;
+      if (!ok)
+	unlink (tmp);
+    }
+
+  free (tmp);
+  free (pool);
+  free (dirs);
+  free (slots);
+
+  return ok;
+}
+
+/* Called at the end of the compilation: if anything was learned,
+   merge it with what is on disk and write the cache back.  */
+void
+_cpp_hdr_cache_flush (cpp_reader *pfile)
+{
+  struct hdr_cache *hc = pfile->hdr_cache;
+  struct hc_image current;
+  struct hc_witness *w;
+  struct hc_entry *e;
+  htab_t witnesses, entries;
+  bool changed;
+  unsigned int i;
+  void **slot;
+
+  if (hc == NULL)
+    return;
+
+  /* Rewrite the file if there are new entries or some entries of the
+     old one turned out to be stale.  */
+  changed = htab_elements (hc->entries) != 0;
+  if (hc->state)
+    for (i = 0; i < hc->image.hdr->n_dirs && !changed; i++)
+      changed = hc->state[i] == HC_STALE;
+  if (!changed)
+    return;
+
+  /* What this compilation saw takes precedence, then the newest file.
+     The records are only borrowed; deleting the tables frees just the
+     copies made by merge_image.  */
+  witnesses = htab_create_alloc (htab_elements (hc->witnesses) * 2 + 1,
+				 hash_witness, eq_witness, NULL,
+				 xcalloc, free);
+  entries = htab_create_alloc (htab_elements (hc->entries) * 2 + 1,
+			       hash_entry, eq_entry, NULL, xcalloc, free);
+  for (i = 0; i < htab_size (hc->witnesses); i++)
+    {
+      w = (struct hc_witness *) hc->witnesses->entries[i];
+      if (w == HTAB_EMPTY_ENTRY || w == HTAB_DELETED_ENTRY)
+	continue;
+      w->index = -1;
+      *htab_find_slot (witnesses, w, INSERT) = w;
+    }
+  for (i = 0; i < htab_size (hc->entries); i++)
+    {
+      e = (struct hc_entry *) hc->entries->entries[i];
+      if (e == HTAB_EMPTY_ENTRY || e == HTAB_DELETED_ENTRY)
+	continue;
+      slot = htab_find_slot_with_hash (entries, e, e->hash, INSERT);
+      *slot = XNEW (struct hc_entry);
+      memcpy (*slot, e, sizeof (*e));
+    }
+
+  if (hc_load (hc->path, hc->key, &current))
+    merge_image (&current, witnesses, entries);
+  merge_image (&hc->image, witnesses, entries);
+
+  write_cache (hc, entries);
+
+  for (i = 0; i < htab_size (witnesses); i++)
+    {
+      w = (struct hc_witness *) witnesses->entries[i];
+      if (w != HTAB_EMPTY_ENTRY && w != HTAB_DELETED_ENTRY
+	  && htab_find (hc->witnesses, w) != w)
+	free (w);
+    }
+  for (i = 0; i < htab_size (entries); i++)
+    {
+      e = (struct hc_entry *) entries->entries[i];
+      if (e != HTAB_EMPTY_ENTRY && e != HTAB_DELETED_ENTRY)
+	free (e);
+    }
+  htab_delete (witnesses);
+  htab_delete (entries);
+  hc_unload (&current);
+}
+
+/* Release the header cache.  */
+void
+_cpp_hdr_cache_close (cpp_reader *pfile)
+{
+  struct hdr_cache *hc = pfile->hdr_cache;
+  struct hc_witness *w;
+  struct hc_entry *e;
+  unsigned int i;
+
+  if (hc == NULL)
+    return;
+
+  for (i = 0; i < htab_size (hc->entries); i++)
+    {
+      e = (struct hc_entry *) hc->entries->entries[i];
+      if (e != HTAB_EMPTY_ENTRY && e != HTAB_DELETED_ENTRY)
+	{
+	  free ((char *) e->dir);
+	  free ((char *) e->header);
+	  free (e);
+	}
+    }
+  for (i = 0; i < htab_size (hc->witnesses); i++)
+    {
+      w = (struct hc_witness *) hc->witnesses->entries[i];
+      if (w != HTAB_EMPTY_ENTRY && w != HTAB_DELETED_ENTRY)
+	{
+	  free ((char *) w->name);
+	  free (w);
+	}
+    }
+  htab_delete (hc->entries);
+  htab_delete (hc->witnesses);
+  hc_unload (&hc->image);
+  free (hc->state);
+  free (hc->path);
+  free (hc);
+  pfile->hdr_cache = NULL;
+}
@@ -456,6 +456,17 @@ struct cpp_options
   /* True if dependencies should be restored from a precompiled header.  */
   bool restore_pch_deps;
 
+  /* APPLE LOCAL begin header cache */
+  /* Directory in which to keep the persistent header lookup cache,
+     or NULL.  */
+  const char *header_cache;
+  /* APPLE LOCAL end header cache */
+
+  /* APPLE LOCAL begin include guard identity */
+  /* True to report how #include directives were handled.  */
+  bool print_include_stats;
+  /* APPLE LOCAL end include guard identity */
+
   /* APPLE LOCAL begin Symbol Separation */
   unsigned char making_pch;
   unsigned char making_ss;
@@ -125,6 +125,9 @@ init_library (void)
 	 initializers.  */
       init_trigraph_map ();
 
+      /* APPLE LOCAL vectorized line scanning */
+      _cpp_init_lexer ();
+
 #ifdef ENABLE_NLS
        (void) bindtextdomain (PACKAGE, LOCALEDIR);
 #endif
@@ -633,6 +636,14 @@ cpp_finish (cpp_reader *pfile, FILE *deps_stream)
   if (CPP_OPTION (pfile, print_include_names))
     _cpp_report_missing_guards (pfile);
 
+  /* APPLE LOCAL header cache */
+  _cpp_hdr_cache_flush (pfile);
+
+  /* APPLE LOCAL begin include guard identity */
+  if (CPP_OPTION (pfile, print_include_stats))
+    _cpp_report_include_stats (pfile);
+  /* APPLE LOCAL end include guard identity */
+
   return pfile->errors;
 }
 
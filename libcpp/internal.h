@@ -377,6 +377,32 @@ struct cpp_reader
      been used.  */
   bool seen_once_only;
 
+  /* APPLE LOCAL begin header cache */
+  /* Persistent record of failed header lookups, or NULL.  */
+  struct hdr_cache *hdr_cache;
+  /* APPLE LOCAL end header cache */
+
+  /* APPLE LOCAL begin include guard identity */
+  /* Files found to have a multiple-include guard, keyed by device,
+     inode, size and mtime rather than by name.  */
+  struct htab *guarded_files;
+
+  /* Counts for -fcpp-stats.  */
+  struct
+  {
+    /* Files the preprocessor was asked to stack, and files read.  */
+    unsigned int requests, reads;
+    /* Requests skipped because of a defined guard macro known for that
+       name, or known only for the same file under another name.  */
+    unsigned int guard_skips, identity_skips;
+    /* Requests for once-only files skipped, and how many of those were
+       recognized by identity without comparing contents.  */
+    unsigned int once_only_skips, once_only_identity;
+    /* Search path directories skipped thanks to the header cache.  */
+    unsigned int header_cache_skips;
+  } include_stats;
+  /* APPLE LOCAL end include guard identity */
+
   /* Multiple include optimization.  */
   const cpp_hashnode *mi_cmacro;
   const cpp_hashnode *mi_ind_cmacro;
@@ -547,6 +573,8 @@ extern bool _cpp_stack_include (cpp_reader *, const char *, int,
 				enum include_type);
 extern int _cpp_compare_file_date (cpp_reader *, const char *, int);
 extern void _cpp_report_missing_guards (cpp_reader *);
+/* APPLE LOCAL include guard identity */
+extern void _cpp_report_include_stats (cpp_reader *);
 extern void _cpp_init_files (cpp_reader *);
 extern void _cpp_cleanup_files (cpp_reader *);
 extern void _cpp_pop_file_buffer (cpp_reader *, struct _cpp_file *);
@@ -554,6 +582,16 @@ extern bool _cpp_save_file_entries (cpp_reader *pfile, FILE *f);
 extern bool _cpp_read_file_entries (cpp_reader *, FILE *);
 extern struct stat *_cpp_get_file_stat (_cpp_file *);
 
+/* APPLE LOCAL begin header cache */
+/* In hdrcache.c */
+extern void _cpp_hdr_cache_open (cpp_reader *);
+extern bool _cpp_hdr_cache_probe (cpp_reader *, const char *, const char *,
+				  const char *);
+extern void _cpp_hdr_cache_note_absent (cpp_reader *);
+extern void _cpp_hdr_cache_flush (cpp_reader *);
+extern void _cpp_hdr_cache_close (cpp_reader *);
+/* APPLE LOCAL end header cache */
+
 /* In expr.c */
 extern bool _cpp_parse_expr (cpp_reader *);
 extern struct op *_cpp_expand_op_stack (cpp_reader *);
@@ -561,6 +599,8 @@ extern struct op *_cpp_expand_op_stack (cpp_reader *);
 /* In lex.c */
 extern void _cpp_process_line_notes (cpp_reader *, int);
 extern void _cpp_clean_line (cpp_reader *);
+/* APPLE LOCAL vectorized line scanning */
+extern void _cpp_init_lexer (void);
 extern bool _cpp_get_fresh_line (cpp_reader *);
 extern bool _cpp_skip_block_comment (cpp_reader *);
 extern cpp_token *_cpp_temp_token (cpp_reader *);
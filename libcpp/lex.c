@@ -101,6 +101,183 @@ add_line_note (cpp_buffer *buffer, const uchar *pos, unsigned int type)
   buffer->notes_used++;
 }
 
+/* APPLE LOCAL begin vectorized line scanning */
+/* The fast path of _cpp_clean_line need only stop at the characters
+   below; it skips everything else as quickly as it can with one of the
+   search_line_* routines.  These return a pointer to the first such
+   character at or after S, and rely on there being one: every buffer
+   _cpp_clean_line sees is terminated by a newline.  They read whole
+   aligned words or vectors, which may extend before S and after the
+   terminator, but never into another page.  */
+#define CLEAN_LINE_SPECIAL(c) \
+  ((c) == '\n' || (c) == '\r' || (c) == '\\' || (c) == '?')
+
+/* With SSE2, look at 16 bytes at a time.  If the compiler can't assume
+   SSE2 is available, we enable it for the one function and check for
+   it at run time, falling back to the portable version.  */
+#if (defined (__i386__) || defined (__x86_64__)) \
+    && ((defined (__SSE2__) && GCC_VERSION >= 4000) || GCC_VERSION >= 4005)
+#define HAVE_SEARCH_LINE_SSE2 1
+#ifndef __SSE2__
+#define HAVE_SEARCH_LINE_DISPATCH 1
+#endif
+#endif
+
+#if !defined (HAVE_SEARCH_LINE_SSE2) || defined (HAVE_SEARCH_LINE_DISPATCH)
+/* The buffer is read a word at a time through this type.  */
+#if GCC_VERSION >= 3003
+typedef unsigned long __attribute__ ((__may_alias__)) line_word;
+#else
+typedef unsigned long line_word;
+#endif
+
+/* A word with each byte set to 1, a byte replicated across a word, and
+   a nonzero value iff some byte of a word is zero.  */
+#define WORD_ONES (~(line_word) 0 / 0xff)
+#define WORD_REPL(c) (WORD_ONES * (uchar) (c))
+#define WORD_HAS_ZERO(x) (((x) - WORD_ONES) & ~(x) & (WORD_ONES << 7))
+
+/* Portable version, scanning a word at a time.  */
+static const uchar *
+search_line_acc_char (const uchar *s)
+{
+  const line_word *p;
+  line_word val;
+
+  while ((size_t) s & (sizeof (line_word) - 1))
+    {
+      if (CLEAN_LINE_SPECIAL (*s))
+	return s;
+      s++;
+    }
+
+  for (p = (const line_word *) s; ; p++)
+    {
+      val = *p;
+      if (WORD_HAS_ZERO (val ^ WORD_REPL ('\n'))
+	  | WORD_HAS_ZERO (val ^ WORD_REPL ('\r'))
+	  | WORD_HAS_ZERO (val ^ WORD_REPL ('\\'))
+	  | WORD_HAS_ZERO (val ^ WORD_REPL ('?')))
+	break;
+    }
+
+  for (s = (const uchar *) p; !CLEAN_LINE_SPECIAL (*s); s++)
+    ;
+  return s;
+}
+#endif
+
+#ifdef HAVE_SEARCH_LINE_SSE2
+static const char search_line_repl[4][16] __attribute__ ((__aligned__ (16))) =
+{
+  { '\n', '\n', '\n', '\n', '\n', '\n', '\n', '\n',
+    '\n', '\n', '\n', '\n', '\n', '\n', '\n', '\n' },
+  { '\r', '\r', '\r', '\r', '\r', '\r', '\r', '\r',
+    '\r', '\r', '\r', '\r', '\r', '\r', '\r', '\r' },
+  { '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\',
+    '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\' },
+  { '?', '?', '?', '?', '?', '?', '?', '?',
+    '?', '?', '?', '?', '?', '?', '?', '?' }
+};
+
+#ifdef HAVE_SEARCH_LINE_DISPATCH
+static const uchar *search_line_sse2 (const uchar *)
+  __attribute__ ((__target__ ("sse2")));
+#endif
+
+static const uchar *
+search_line_sse2 (const uchar *s)
+{
+  typedef char v16qi __attribute__ ((__vector_size__ (16)));
+
+  const v16qi repl_nl = *(const v16qi *) search_line_repl[0];
+  const v16qi repl_cr = *(const v16qi *) search_line_repl[1];
+  const v16qi repl_bs = *(const v16qi *) search_line_repl[2];
+  const v16qi repl_qm = *(const v16qi *) search_line_repl[3];
+  const v16qi *p;
+  unsigned int found, mask;
+  v16qi data, t;
+
+  /* Start with the aligned block containing S, ignoring any matches
+     before S.  */
+  p = (const v16qi *) ((size_t) s & -(size_t) 16);
+  mask = -1U << ((size_t) s & 15);
+  data = *p;
+
+  for (;;)
+    {
+      t = __builtin_ia32_pcmpeqb128 (data, repl_nl);
+      t |= __builtin_ia32_pcmpeqb128 (data, repl_cr);
+      t |= __builtin_ia32_pcmpeqb128 (data, repl_bs);
+      t |= __builtin_ia32_pcmpeqb128 (data, repl_qm);
+      found = __builtin_ia32_pmovmskb128 (t) & mask;
+      if (found)
+	break;
+      data = *++p;
+      mask = -1U;
+    }
+
+  return (const uchar *) p + __builtin_ctz (found);
+}
+#endif
+
+#ifdef HAVE_SEARCH_LINE_DISPATCH
+/* Return true if the CPU we are running on has SSE2.  */
+static bool
+cpu_has_sse2 (void)
+{
+  unsigned int eax, ebx, ecx, edx;
+
+#ifdef __i386__
+  /* Check that CPUID exists, by trying to flip the ID flag.  */
+  __asm__ ("pushfl\n\t"
+	   "pushfl\n\t"
+	   "popl\t%0\n\t"
+	   "movl\t%0, %1\n\t"
+	   "xorl\t$0x200000, %0\n\t"
+	   "pushl\t%0\n\t"
+	   "popfl\n\t"
+	   "pushfl\n\t"
+	   "popl\t%0\n\t"
+	   "popfl"
+	   : "=&r" (eax), "=&r" (ebx));
+  if (((eax ^ ebx) & 0x200000) == 0)
+    return false;
+#endif
+
+  eax = 1;
+#if defined (__i386__) && defined (__PIC__)
+  /* %ebx holds the GOT pointer.  */
+  __asm__ ("xchgl\t%%ebx, %1\n\t"
+	   "cpuid\n\t"
+	   "xchgl\t%%ebx, %1"
+	   : "+a" (eax), "=&r" (ebx), "=c" (ecx), "=d" (edx));
+#else
+  __asm__ ("cpuid"
+	   : "+a" (eax), "=b" (ebx), "=c" (ecx), "=d" (edx));
+#endif
+
+  return (edx & (1 << 26)) != 0;
+}
+
+static const uchar *(*search_line_fast) (const uchar *) = search_line_acc_char;
+#elif defined (HAVE_SEARCH_LINE_SSE2)
+#define search_line_fast search_line_sse2
+#else
+#define search_line_fast search_line_acc_char
+#endif
+
+/* Choose the fastest way of scanning lines this host supports.  */
+void
+_cpp_init_lexer (void)
+{
+#ifdef HAVE_SEARCH_LINE_DISPATCH
+  if (cpu_has_sse2 ())
+    search_line_fast = search_line_sse2;
+#endif
+}
+/* APPLE LOCAL end vectorized line scanning */
+
 /* Returns with a logical line that contains no escaped newlines or
    trigraphs.  This is a time-critical inner loop.  */
 void
@@ -118,58 +295,70 @@ _cpp_clean_line (cpp_reader *pfile)
 
   if (!buffer->from_stage3)
     {
+      /* APPLE LOCAL begin vectorized line scanning */
+      /* The last backslash seen, if any; no backslash, no escaped
+	 newline.  */
+      const uchar *pbackslash = NULL;
+
       /* Short circuit for the common case of an un-escaped line with
 	 no trigraphs.  The primary win here is by not writing any
 	 data back to memory until we have to.  */
       for (;;)
 	{
-	  c = *++s;
-	  if (c == '\n' || c == '\r')
+	  s = search_line_fast (s + 1);
+	  c = *s;
+	  if (c == '\\')
+	    pbackslash = s;
+	  else if (c == '?')
 	    {
-	      d = (uchar *) s;
+	      if (s[1] == '?' && _cpp_trigraph_map[s[2]])
+		{
+		  /* Have a trigraph.  We may or may not have to convert
+		     it.  Add a line note regardless, for -Wtrigraphs.  */
+		  add_line_note (buffer, s, s[2]);
+		  if (CPP_OPTION (pfile, trigraphs))
+		    {
+		      /* We do, and that means we have to switch to the
+			 slow path.  */
+		      d = (uchar *) s;
+		      *d = _cpp_trigraph_map[s[2]];
+		      s += 2;
+		      goto slow_path;
+		    }
+		}
+	    }
+	  else
+	    break;
+	}
 
-	      if (s == buffer->rlimit)
-		goto done;
+      /* This must be \r or \n.  */
+      d = (uchar *) s;
 
-	      /* DOS line ending? */
-	      if (c == '\r' && s[1] == '\n')
-		s++;
+      if (s == buffer->rlimit)
+	goto done;
 
-	      if (s == buffer->rlimit)
-		goto done;
+      /* DOS line ending? */
+      if (c == '\r' && s[1] == '\n')
+	s++;
 
-	      /* check for escaped newline */
-	      p = d;
-	      while (p != buffer->next_line && is_nvspace (p[-1]))
-		p--;
-	      if (p == buffer->next_line || p[-1] != '\\')
-		goto done;
+      if (s == buffer->rlimit || pbackslash == NULL)
+	goto done;
 
-	      /* Have an escaped newline; process it and proceed to
-		 the slow path.  */
-	      add_line_note (buffer, p - 1, p != d ? ' ' : '\\');
-	      d = p - 2;
-	      buffer->next_line = p - 1;
-	      break;
-	    }
-	  if (c == '?' && s[1] == '?' && _cpp_trigraph_map[s[2]])
-	    {
-	      /* Have a trigraph.  We may or may not have to convert
-		 it.  Add a line note regardless, for -Wtrigraphs.  */
-	      add_line_note (buffer, s, s[2]);
-	      if (CPP_OPTION (pfile, trigraphs))
-		{
-		  /* We do, and that means we have to switch to the
-		     slow path.  */
-		  d = (uchar *) s;
-		  *d = _cpp_trigraph_map[s[2]];
-		  s += 2;
-		  break;
-		}
-	    }
-	}
+      /* check for escaped newline */
+      p = d;
+      while (p != buffer->next_line && is_nvspace (p[-1]))
+	p--;
+      if (p == buffer->next_line || p[-1] != '\\')
+	goto done;
 
+      /* Have an escaped newline; process it and proceed to
+	 the slow path.  */
+      add_line_note (buffer, p - 1, p != d ? ' ' : '\\');
+      d = p - 2;
+      buffer->next_line = p - 1;
 
+    slow_path:
+      /* APPLE LOCAL end vectorized line scanning */
       for (;;)
 	{
 	  c = *++s;
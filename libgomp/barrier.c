@@ -40,5 +40,6 @@ GOMP_barrier (void)
   if (team == NULL)
     return;
 
-  gomp_barrier_wait (&team->barrier);
+  /* APPLE LOCAL libgomp tasks */
+  gomp_team_barrier_wait (&team->barrier);
 }
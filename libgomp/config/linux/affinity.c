@@ -0,0 +1,115 @@
+/* APPLE LOCAL file libgomp affinity */
+/* Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This file is part of the GNU OpenMP Library (libgomp).
+
+   Libgomp is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation; either version 2.1 of the License, or
+   (at your option) any later version.
+
+   Libgomp is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+   FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+   more details.
+
+   You should have received a copy of the GNU Lesser General Public License 
+   along with libgomp; see the file COPYING.LIB.  If not, write to the
+   Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA.  */
+
+/* As a special exception, if you link this library with other files, some
+   of which are compiled with GCC, to produce an executable, this library
+   does not by itself cause the resulting executable to be covered by the
+   GNU General Public License.  This exception does not however invalidate
+   any other reasons why the executable file might be covered by the GNU
+   General Public License.  */
+
+/* This is a Linux specific implementation of binding threads to CPUs.  */
+
+#define _GNU_SOURCE 1
+#include "libgomp.h"
+#include <sched.h>
+#include <stdlib.h>
+
+#ifdef HAVE_PTHREAD_AFFINITY_NP
+
+/* The next CPU, by index into gomp_cpu_affinity, for a thread of a
+   nested team.  */
+static unsigned int affinity_counter;
+
+/* Reduce gomp_cpu_affinity to the CPUs this process may run on, or fill
+   it with all of them if OMP_PROC_BIND was given without a list.  Then
+   bind the initial thread to the first of them.  */
+
+void
+gomp_init_affinity (void)
+{
+  cpu_set_t cpuset;
+  size_t i, len;
+
+  if (pthread_getaffinity_np (pthread_self (), sizeof (cpuset), &cpuset))
+    {
+      gomp_error ("Could not get the CPU affinity set");
+      goto disable;
+    }
+
+  len = 0;
+  if (gomp_cpu_affinity == NULL)
+    {
+      gomp_cpu_affinity = gomp_malloc (CPU_SETSIZE
+				       * sizeof (gomp_cpu_affinity[0]));
+      for (i = 0; i < CPU_SETSIZE; i++)
+	if (CPU_ISSET (i, &cpuset))
+	  gomp_cpu_affinity[len++] = i;
+    }
+  else
+    for (i = 0; i < gomp_cpu_affinity_len; i++)
+      if (gomp_cpu_affinity[i] < CPU_SETSIZE
+	  && CPU_ISSET (gomp_cpu_affinity[i], &cpuset))
+	gomp_cpu_affinity[len++] = gomp_cpu_affinity[i];
+
+  if (len == 0)
+    {
+      gomp_error ("None of the CPUs in GOMP_CPU_AFFINITY can be used");
+      goto disable;
+    }
+  gomp_cpu_affinity_len = len;
+
+  CPU_ZERO (&cpuset);
+  CPU_SET (gomp_cpu_affinity[0], &cpuset);
+  pthread_setaffinity_np (pthread_self (), sizeof (cpuset), &cpuset);
+  affinity_counter = 1;
+  return;
+
+ disable:
+  free (gomp_cpu_affinity);
+  gomp_cpu_affinity = NULL;
+  gomp_cpu_affinity_len = 0;
+}
+
+/* Bind the thread about to be created with ATTR.  ID is its team_id in
+   a team that isn't nested; the master of such a team is always the
+   initial thread and each of the others always the same thread of the
+   pool, so every team_id stays on the same CPU from one parallel region
+   to the next.  Threads of nested teams pass -1 and are spread over the
+   CPUs in turn.  */
+
+void
+gomp_init_thread_affinity (pthread_attr_t *attr, unsigned id)
+{
+  cpu_set_t cpuset;
+
+  if (id == -1U)
+    id = __sync_fetch_and_add (&affinity_counter, 1);
+
+  CPU_ZERO (&cpuset);
+  CPU_SET (gomp_cpu_affinity[id % gomp_cpu_affinity_len], &cpuset);
+  pthread_attr_setaffinity_np (attr, sizeof (cpuset), &cpuset);
+}
+
+#else
+
+#include "../posix/affinity.c"
+
+#endif
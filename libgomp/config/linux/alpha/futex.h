@@ -74,3 +74,13 @@ futex_wake (int *addr, int count)
 		  : "$1", "$2", "$3", "$4", "$5", "$6", "$7", "$8",
 		    "$22", "$23", "$24", "$25", "$27", "$28", "memory");
 }
+
+/* APPLE LOCAL begin libgomp spin wait */
+/* Tell the processor that this is a spin loop.  */
+
+static inline void
+cpu_relax (void)
+{
+  __asm volatile ("" : : : "memory");
+}
+/* APPLE LOCAL end libgomp spin wait */
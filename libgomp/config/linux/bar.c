@@ -30,27 +30,81 @@
    implementation uses atomic instructions and the futex syscall.  */
 
 #include "libgomp.h"
-#include "futex.h"
+/* APPLE LOCAL libgomp spin wait */
+#include "wait.h"
 #include <limits.h>
+/* APPLE LOCAL libgomp tree barrier */
+#include <stdlib.h>
 
 
+/* APPLE LOCAL begin libgomp spin wait */
+/* Sleep until the generation word of BAR, last seen as GEN, changes.
+   A thread going to sleep first sets BAR_SLEEPING in the word, so the
+   flag belongs to the generation it was set in: whoever next clears it
+   must wake the sleepers, and nobody can clear it on behalf of an
+   earlier generation.  If the word changed before the flag could be set,
+   return at once.  */
+
+static void
+gomp_barrier_sleep (gomp_barrier_t *bar, int gen)
+{
+  if ((gen & BAR_SLEEPING) == 0
+      && !__sync_bool_compare_and_swap (&bar->generation, gen,
+					gen | BAR_SLEEPING))
+    return;
+  futex_wait (&bar->generation, gen | BAR_SLEEPING);
+}
+/* APPLE LOCAL end libgomp spin wait */
+
 void
 gomp_barrier_wait_end (gomp_barrier_t *bar, bool last)
 {
+  /* APPLE LOCAL begin libgomp spin wait */
+  int gen;
+
   if (last)
     {
-      bar->generation++;
-      futex_wake (&bar->generation, INT_MAX);
+      int old;
+
+      /* The waiters usually see the new generation while spinning, so
+	 only enter the kernel if one of them went to sleep.  */
+      gen = *(volatile int *) &bar->generation;
+      /* APPLE LOCAL libgomp tasks */
+      while ((old = __sync_val_compare_and_swap (&bar->generation, gen,
+						 (gen & ~BAR_SLEEPING)
+						 + BAR_INCR)) != gen)
+	gen = old;
+
+      if (gen & BAR_SLEEPING)
+	futex_wake (&bar->generation, INT_MAX);
     }
+  /* APPLE LOCAL end libgomp spin wait */
   else
     {
-      unsigned int generation = bar->generation;
+      unsigned int generation;
 
-      gomp_mutex_unlock (&bar->mutex);
+      /* APPLE LOCAL begin libgomp tree barrier */
+      /* A thread arriving through the tree noted the generation before
+	 it arrived, and doesn't hold the mutex.  */
+      if (bar->slots)
+	generation = bar->slots[gomp_thread ()->ts.team_id].generation;
+      else
+	{
+	  generation = bar->generation & ~BAR_FLAGS;
+	  gomp_mutex_unlock (&bar->mutex);
+	}
+      /* APPLE LOCAL end libgomp tree barrier */
 
-      do
-	futex_wait (&bar->generation, generation);
-      while (bar->generation == generation);
+      /* APPLE LOCAL begin libgomp spin wait */
+      for (;;)
+	{
+	  gen = *(volatile int *) &bar->generation;
+	  if ((gen & ~BAR_FLAGS) != generation)
+	    break;
+	  if (do_spin (&bar->generation, gen))
+	    gomp_barrier_sleep (bar, gen);
+	}
+      /* APPLE LOCAL end libgomp spin wait */
     }
 
   if (__sync_add_and_fetch (&bar->arrived, -1) == 0)
@@ -62,3 +116,243 @@ gomp_barrier_wait (gomp_barrier_t *barrier)
 {
   gomp_barrier_wait_end (barrier, gomp_barrier_wait_start (barrier));
 }
+
+/* APPLE LOCAL begin libgomp tree barrier */
+/* Set up the combining tree for BAR, whose TOTAL threads are numbered by
+   team_id.  Thread I arrives at leaf node I / GOMP_BARRIER_ARITY, and
+   the levels above the leaves follow in order, ending with the root.  */
+
+static void
+gomp_tree_barrier_init (gomp_barrier_t *bar)
+{
+  unsigned count = bar->total, nnodes, width, level, i;
+  struct gomp_barrier_node *nodes, *node;
+  char *p;
+
+  nnodes = 0;
+  width = count;
+  do
+    {
+      width = (width + GOMP_BARRIER_ARITY - 1) / GOMP_BARRIER_ARITY;
+      nnodes += width;
+    }
+  while (width > 1);
+
+  bar->tree_alloc = gomp_malloc (GOMP_BARRIER_LINE - 1
+				 + nnodes * sizeof (struct gomp_barrier_node)
+				 + count * sizeof (struct gomp_barrier_slot));
+  p = (char *) (((uintptr_t) bar->tree_alloc + GOMP_BARRIER_LINE - 1)
+		& -(uintptr_t) GOMP_BARRIER_LINE);
+  nodes = (struct gomp_barrier_node *) p;
+  bar->slots = (struct gomp_barrier_slot *) (nodes + nnodes);
+
+  /* WIDTH is the number of threads or nodes in the level below the
+     nodes being filled in, and LEVEL is the index of the first of them
+     when they are nodes.  */
+  width = count;
+  level = 0;
+  node = nodes;
+  do
+    {
+      struct gomp_barrier_node *first = node;
+
+      for (i = 0; i < width; i += GOMP_BARRIER_ARITY, node++)
+	{
+	  node->arrived = 0;
+	  node->total = width - i < GOMP_BARRIER_ARITY
+			? width - i : GOMP_BARRIER_ARITY;
+	  node->parent = NULL;
+	}
+      if (first != nodes)
+	for (i = 0; i < width; i++)
+	  nodes[level + i].parent = first + i / GOMP_BARRIER_ARITY;
+      level = first - nodes;
+      width = node - first;
+    }
+  while (width > 1);
+
+  bar->nodes = nodes;
+}
+
+void
+gomp_barrier_init_team (gomp_barrier_t *bar, unsigned count)
+{
+  gomp_barrier_init (bar, count);
+  if (count >= gomp_tree_barrier_threads)
+    gomp_tree_barrier_init (bar);
+}
+
+void
+gomp_tree_barrier_destroy (gomp_barrier_t *bar)
+{
+  free (bar->tree_alloc);
+}
+
+/* Arrive at BAR through the tree.  Return true for the last thread to
+   arrive, which then holds the mutex until every thread has left, just
+   as the last thread of a barrier without a tree does.  */
+
+bool
+gomp_tree_barrier_wait_start (gomp_barrier_t *bar)
+{
+  unsigned id = gomp_thread ()->ts.team_id;
+  struct gomp_barrier_node *node = &bar->nodes[id / GOMP_BARRIER_ARITY];
+
+  /* The generation can't change until this thread has arrived.  */
+  /* APPLE LOCAL libgomp tasks */
+  bar->slots[id].generation = bar->generation & ~BAR_FLAGS;
+
+  for (;;)
+    {
+      if (__sync_add_and_fetch (&node->arrived, 1) != node->total)
+	return false;
+
+      /* Everyone below this node has arrived, and nobody will arrive
+	 here again until the barrier has been released.  */
+      node->arrived = 0;
+      if (node->parent == NULL)
+	break;
+      node = node->parent;
+    }
+
+  gomp_mutex_lock (&bar->mutex);
+  bar->arrived = bar->total;
+  return true;
+}
+/* APPLE LOCAL end libgomp tree barrier */
+
+/* APPLE LOCAL begin libgomp tasks */
+/* Release the threads waiting at BAR, dropping its flags.  */
+
+static void
+gomp_barrier_release (gomp_barrier_t *bar)
+{
+  int gen = *(volatile int *) &bar->generation, old;
+
+  while ((old = __sync_val_compare_and_swap (&bar->generation, gen,
+					     (gen & ~BAR_FLAGS)
+					     + BAR_INCR)) != gen)
+    gen = old;
+
+  if (gen & BAR_SLEEPING)
+    futex_wake (&bar->generation, INT_MAX);
+}
+
+/* Tell the threads waiting at BAR that there are deferred tasks to run,
+   waking those that went to sleep.  The flag that says they did is
+   cleared in the same swap, so a thread that sleeps afterwards sets it
+   again, and the next swap that clears it wakes that thread too.  */
+
+void
+gomp_team_barrier_set_task_pending (gomp_barrier_t *bar)
+{
+  int gen = *(volatile int *) &bar->generation;
+
+  while ((gen & BAR_TASK_PENDING) == 0)
+    {
+      int old = __sync_val_compare_and_swap (&bar->generation, gen,
+					     (gen & ~BAR_SLEEPING)
+					     | BAR_TASK_PENDING);
+      if (old == gen)
+	{
+	  if (gen & BAR_SLEEPING)
+	    futex_wake (&bar->generation, INT_MAX);
+	  break;
+	}
+      gen = old;
+    }
+}
+
+/* Called when the last deferred task of the team has finished.  If every
+   thread has arrived at BAR already, release them.  Both the thread that
+   finished the task and the last thread to arrive may get here, and only
+   one of them does the release.  */
+
+void
+gomp_team_barrier_tasks_done (gomp_barrier_t *bar)
+{
+  if (*(volatile int *) &bar->awaiting_tasks
+      && __sync_bool_compare_and_swap (&bar->awaiting_tasks, 1, 0))
+    gomp_barrier_release (bar);
+}
+
+void
+gomp_team_barrier_wait_end (gomp_barrier_t *bar, bool last)
+{
+  struct gomp_thread *thr = gomp_thread ();
+  struct gomp_team *team = thr->ts.team;
+  int generation, gen;
+  /* APPLE LOCAL begin libgomp tracing */
+  /* The team may be freed, or reused for another region, once the
+     barrier has been left, so note what the trace needs now.  */
+  unsigned team_id = thr->ts.team_id;
+  unsigned long region = team->trace_region;
+
+  gomp_trace (GOMP_TRACE_BARRIER_ARRIVE, team_id, region);
+  /* APPLE LOCAL end libgomp tracing */
+
+  if (last)
+    {
+      generation = bar->generation & ~BAR_FLAGS;
+      if (*(volatile unsigned long *) &team->task_count == 0)
+	{
+	  gomp_barrier_release (bar);
+	  goto leave;
+	}
+
+      /* Whoever finishes the last task releases the barrier, unless it
+	 finished before AWAITING_TASKS was set.  */
+      bar->awaiting_tasks = 1;
+      __sync_synchronize ();
+      if (*(volatile unsigned long *) &team->task_count == 0)
+	gomp_team_barrier_tasks_done (bar);
+      gomp_team_barrier_set_task_pending (bar);
+    }
+  else if (bar->slots)
+    generation = bar->slots[thr->ts.team_id].generation;
+  else
+    {
+      generation = bar->generation & ~BAR_FLAGS;
+      gomp_mutex_unlock (&bar->mutex);
+    }
+
+  for (;;)
+    {
+      gen = *(volatile int *) &bar->generation;
+      if ((gen & ~BAR_FLAGS) != generation)
+	break;
+
+      if (gen & BAR_TASK_PENDING)
+	{
+	  gomp_barrier_handle_tasks ();
+
+	  /* Stop looking for tasks once none are queued.  A task queued
+	     after the check must see the flag clear, so look again.
+	     This keeps BAR_SLEEPING, and a sleeper always waits on a value
+	     with it set, so the word going back to an earlier value can't
+	     leave one asleep.  */
+	  if (*(volatile unsigned long *) &team->task_queued == 0
+	      && __sync_bool_compare_and_swap (&bar->generation, gen,
+					       gen & ~BAR_TASK_PENDING)
+	      && *(volatile unsigned long *) &team->task_queued != 0)
+	    gomp_team_barrier_set_task_pending (bar);
+	  continue;
+	}
+
+      if (do_spin (&bar->generation, gen))
+	gomp_barrier_sleep (bar, gen);
+    }
+
+ leave:
+  if (__sync_add_and_fetch (&bar->arrived, -1) == 0)
+    gomp_mutex_unlock (&bar->mutex);
+  /* APPLE LOCAL libgomp tracing */
+  gomp_trace (GOMP_TRACE_BARRIER_DEPART, team_id, region);
+}
+
+void
+gomp_team_barrier_wait (gomp_barrier_t *barrier)
+{
+  gomp_team_barrier_wait_end (barrier, gomp_team_barrier_wait_start (barrier));
+}
+/* APPLE LOCAL end libgomp tasks */
@@ -34,20 +34,81 @@
 
 #include "mutex.h"
 
+/* APPLE LOCAL begin libgomp tree barrier */
+/* In a large team, threads arrive through a combining tree rather than
+   at one counter guarded by one mutex.  Each node counts the arrivals of
+   up to GOMP_BARRIER_ARITY threads or child nodes, and the last thread
+   to arrive at a node carries on to its parent.  Nodes and per-thread
+   slots each have a cache line of their own.  */
+
+#define GOMP_BARRIER_ARITY	4
+#define GOMP_BARRIER_LINE	64
+
+struct gomp_barrier_node
+{
+  unsigned arrived;
+  unsigned total;
+  struct gomp_barrier_node *parent;
+} __attribute__ ((aligned (GOMP_BARRIER_LINE)));
+
+struct gomp_barrier_slot
+{
+  /* The generation the thread waits to see changed.  */
+  int generation;
+} __attribute__ ((aligned (GOMP_BARRIER_LINE)));
+/* APPLE LOCAL end libgomp tree barrier */
+
 typedef struct
 {
   gomp_mutex_t mutex;
   unsigned total;
   unsigned arrived;
   int generation;
+  /* APPLE LOCAL begin libgomp tree barrier */
+  /* The combining tree, indexed by level from the leaves, and a slot for
+     each thread, indexed by team_id.  Both are NULL for a barrier that
+     uses ARRIVED and MUTEX alone.  */
+  struct gomp_barrier_node *nodes;
+  struct gomp_barrier_slot *slots;
+  void *tree_alloc;
+  /* APPLE LOCAL end libgomp tree barrier */
+  /* APPLE LOCAL begin libgomp tasks */
+  /* Nonzero once every thread of the team has arrived, while deferred
+     tasks still keep the barrier from being released.  */
+  int awaiting_tasks;
+  /* APPLE LOCAL end libgomp tasks */
 } gomp_barrier_t;
 
+/* APPLE LOCAL begin libgomp tasks */
+/* GENERATION steps by BAR_INCR, leaving its low bits for flags.
+   BAR_TASK_PENDING says that a team barrier has deferred tasks that its
+   waiting threads can run, and BAR_SLEEPING that a thread may be asleep
+   in futex_wait on the current value.  */
+#define BAR_TASK_PENDING	1
+#define BAR_SLEEPING		2
+#define BAR_FLAGS		(BAR_TASK_PENDING | BAR_SLEEPING)
+#define BAR_INCR		4
+/* APPLE LOCAL end libgomp tasks */
+
+/* APPLE LOCAL begin libgomp tree barrier */
+extern void gomp_barrier_init_team (gomp_barrier_t *, unsigned);
+extern void gomp_tree_barrier_destroy (gomp_barrier_t *);
+extern bool gomp_tree_barrier_wait_start (gomp_barrier_t *);
+/* APPLE LOCAL end libgomp tree barrier */
+
 static inline void gomp_barrier_init (gomp_barrier_t *bar, unsigned count)
 {
   gomp_mutex_init (&bar->mutex);
   bar->total = count;
   bar->arrived = 0;
   bar->generation = 0;
+  /* APPLE LOCAL begin libgomp tree barrier */
+  bar->nodes = NULL;
+  bar->slots = NULL;
+  bar->tree_alloc = NULL;
+  /* APPLE LOCAL end libgomp tree barrier */
+  /* APPLE LOCAL libgomp tasks */
+  bar->awaiting_tasks = 0;
 }
 
 static inline void gomp_barrier_reinit (gomp_barrier_t *bar, unsigned count)
@@ -61,6 +122,10 @@ static inline void gomp_barrier_destroy (gomp_barrier_t *bar)
 {
   /* Before destroying, make sure all threads have left the barrier.  */
   gomp_mutex_lock (&bar->mutex);
+  /* APPLE LOCAL begin libgomp tree barrier */
+  if (bar->nodes)
+    gomp_tree_barrier_destroy (bar);
+  /* APPLE LOCAL end libgomp tree barrier */
 }
 
 extern void gomp_barrier_wait (gomp_barrier_t *);
@@ -68,8 +133,27 @@ extern void gomp_barrier_wait_end (gomp_barrier_t *, bool);
 
 static inline bool gomp_barrier_wait_start (gomp_barrier_t *bar)
 {
+  /* APPLE LOCAL begin libgomp tree barrier */
+  if (bar->nodes)
+    return gomp_tree_barrier_wait_start (bar);
+  /* APPLE LOCAL end libgomp tree barrier */
   gomp_mutex_lock (&bar->mutex);
   return ++bar->arrived == bar->total;
 }
 
+/* APPLE LOCAL begin libgomp tasks */
+/* The barrier of a team runs the team's deferred tasks while its threads
+   wait, and isn't released until all of them have finished.  */
+
+extern void gomp_team_barrier_wait (gomp_barrier_t *);
+extern void gomp_team_barrier_wait_end (gomp_barrier_t *, bool);
+extern void gomp_team_barrier_set_task_pending (gomp_barrier_t *);
+extern void gomp_team_barrier_tasks_done (gomp_barrier_t *);
+
+static inline bool gomp_team_barrier_wait_start (gomp_barrier_t *bar)
+{
+  return gomp_barrier_wait_start (bar);
+}
+/* APPLE LOCAL end libgomp tasks */
+
 #endif /* GOMP_BARRIER_H */
@@ -30,19 +30,29 @@
    implementation uses atomic instructions and the futex syscall.  */
 
 #include "libgomp.h"
-#include "futex.h"
+/* APPLE LOCAL libgomp spin wait */
+#include "wait.h"
 
 
 void
 gomp_mutex_lock_slow (gomp_mutex_t *mutex)
 {
+  /* APPLE LOCAL libgomp tracing */
+  unsigned long long start = gomp_trace_var ? gomp_trace_time () : 0;
+
   do
     {
       int oldval = __sync_val_compare_and_swap (mutex, 1, 2);
       if (oldval != 0)
-        futex_wait (mutex, 2);
+        /* APPLE LOCAL libgomp spin wait */
+        do_wait (mutex, 2);
     }
   while (!__sync_bool_compare_and_swap (mutex, 0, 2));
+
+  /* APPLE LOCAL begin libgomp tracing */
+  if (__builtin_expect (gomp_trace_var, 0))
+    gomp_trace_record (GOMP_TRACE_LOCK_WAIT, gomp_trace_time () - start, 0);
+  /* APPLE LOCAL end libgomp tracing */
 }
 
 void
@@ -30,7 +30,8 @@
    implementation uses atomic instructions and the futex syscall.  */
 
 #include "libgomp.h"
-#include "futex.h"
+/* APPLE LOCAL libgomp spin wait */
+#include "wait.h"
 
 
 void
@@ -44,7 +45,8 @@ gomp_sem_wait_slow (gomp_sem_t *sem)
 	  if (__sync_bool_compare_and_swap (sem, val, val - 1))
 	    return;
 	}
-      futex_wait (sem, -1);
+      /* APPLE LOCAL libgomp spin wait */
+      do_wait (sem, -1);
     }
 }
 
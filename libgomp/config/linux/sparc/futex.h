@@ -78,3 +78,13 @@ futex_wake (int *addr, int count)
 {
   sys_futex0 (addr, FUTEX_WAKE, count);
 }
+
+/* APPLE LOCAL begin libgomp spin wait */
+/* Tell the processor that this is a spin loop.  */
+
+static inline void
+cpu_relax (void)
+{
+  __asm volatile ("" : : : "memory");
+}
+/* APPLE LOCAL end libgomp spin wait */
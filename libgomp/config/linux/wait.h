@@ -0,0 +1,70 @@
+/* APPLE LOCAL file libgomp spin wait */
+/* Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This file is part of the GNU OpenMP Library (libgomp).
+
+   Libgomp is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation; either version 2.1 of the License, or
+   (at your option) any later version.
+
+   Libgomp is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+   FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+   more details.
+
+   You should have received a copy of the GNU Lesser General Public License 
+   along with libgomp; see the file COPYING.LIB.  If not, write to the
+   Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA.  */
+
+/* As a special exception, if you link this library with other files, some
+   of which are compiled with GCC, to produce an executable, this library
+   does not by itself cause the resulting executable to be covered by the
+   GNU General Public License.  This exception does not however invalidate
+   any other reasons why the executable file might be covered by the GNU
+   General Public License.  */
+
+/* This is a Linux specific implementation of waiting for a futex word
+   to change.  A thread spins for a while before it sleeps in the kernel,
+   since a futex_wait and the matching futex_wake cost far more than the
+   short waits typical of barriers between small parallel regions.  */
+
+#ifndef GOMP_WAIT_H
+#define GOMP_WAIT_H 1
+
+#include "libgomp.h"
+#include "futex.h"
+
+/* Spin while *ADDR is VAL, for at most the spin count.  Return nonzero
+   if *ADDR still holds VAL at the end.  */
+
+static inline int
+do_spin (int *addr, int val)
+{
+  unsigned long long i, count = gomp_spin_count_var;
+
+  /* When there are more threads than processors, the thread we are
+     waiting for may need our processor to make progress.  */
+  if (__builtin_expect (gomp_managed_threads > gomp_available_cpus, 0))
+    count = gomp_throttled_spin_count_var;
+
+  for (i = 0; i < count; i++)
+    if (__builtin_expect (*(volatile int *) addr != val, 0))
+      return 0;
+    else
+      cpu_relax ();
+  return 1;
+}
+
+/* Wait until *ADDR may no longer hold VAL.  Like futex_wait, this can
+   return early, so callers must check again.  */
+
+static inline void
+do_wait (int *addr, int val)
+{
+  if (do_spin (addr, val))
+    futex_wait (addr, val);
+}
+
+#endif /* GOMP_WAIT_H */
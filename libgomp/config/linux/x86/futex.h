@@ -108,3 +108,13 @@ futex_wake (int *addr, int count)
 }
 
 #endif /* __LP64__ */
+
+/* APPLE LOCAL begin libgomp spin wait */
+/* Tell the processor that this is a spin loop.  */
+
+static inline void
+cpu_relax (void)
+{
+  __asm volatile ("rep; nop" : : : "memory");
+}
+/* APPLE LOCAL end libgomp spin wait */
@@ -0,0 +1,48 @@
+/* APPLE LOCAL file libgomp affinity */
+/* Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This file is part of the GNU OpenMP Library (libgomp).
+
+   Libgomp is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation; either version 2.1 of the License, or
+   (at your option) any later version.
+
+   Libgomp is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+   FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+   more details.
+
+   You should have received a copy of the GNU Lesser General Public License 
+   along with libgomp; see the file COPYING.LIB.  If not, write to the
+   Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA.  */
+
+/* As a special exception, if you link this library with other files, some
+   of which are compiled with GCC, to produce an executable, this library
+   does not by itself cause the resulting executable to be covered by the
+   GNU General Public License.  This exception does not however invalidate
+   any other reasons why the executable file might be covered by the GNU
+   General Public License.  */
+
+/* This is a generic stub implementation of binding threads to CPUs,
+   for systems that can't.  GOMP_CPU_AFFINITY and OMP_PROC_BIND are
+   accepted and ignored.  */
+
+#include "libgomp.h"
+#include <stdlib.h>
+
+void
+gomp_init_affinity (void)
+{
+  free (gomp_cpu_affinity);
+  gomp_cpu_affinity = NULL;
+  gomp_cpu_affinity_len = 0;
+}
+
+void
+gomp_init_thread_affinity (pthread_attr_t *attr, unsigned id)
+{
+  (void) attr;
+  (void) id;
+}
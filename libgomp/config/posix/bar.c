@@ -46,6 +46,17 @@ gomp_barrier_init (gomp_barrier_t *bar, unsigned count)
   bar->arrived = 0;
 }
 
+/* APPLE LOCAL begin libgomp tree barrier */
+/* A team barrier is never resized, but this implementation has no use
+   for knowing that.  */
+
+void
+gomp_barrier_init_team (gomp_barrier_t *bar, unsigned count)
+{
+  gomp_barrier_init (bar, count);
+}
+/* APPLE LOCAL end libgomp tree barrier */
+
 void
 gomp_barrier_destroy (gomp_barrier_t *bar)
 {
@@ -109,3 +120,45 @@ gomp_barrier_wait (gomp_barrier_t *barrier)
 {
   gomp_barrier_wait_end (barrier, gomp_barrier_wait_start (barrier));
 }
+
+/* APPLE LOCAL begin libgomp tasks */
+bool
+gomp_team_barrier_wait_start (gomp_barrier_t *bar)
+{
+  gomp_barrier_drain_tasks ();
+  return gomp_barrier_wait_start (bar);
+}
+
+void
+gomp_team_barrier_wait_end (gomp_barrier_t *bar, bool last)
+{
+  /* APPLE LOCAL begin libgomp tracing */
+  struct gomp_thread *thr = gomp_thread ();
+  unsigned team_id = thr->ts.team_id;
+  unsigned long region = thr->ts.team->trace_region;
+
+  gomp_trace (GOMP_TRACE_BARRIER_ARRIVE, team_id, region);
+  gomp_barrier_wait_end (bar, last);
+  gomp_trace (GOMP_TRACE_BARRIER_DEPART, team_id, region);
+  /* APPLE LOCAL end libgomp tracing */
+}
+
+void
+gomp_team_barrier_wait (gomp_barrier_t *barrier)
+{
+  gomp_team_barrier_wait_end (barrier, gomp_team_barrier_wait_start (barrier));
+}
+
+/* Nobody waiting at the barrier needs telling about tasks.  */
+
+void
+gomp_team_barrier_set_task_pending (gomp_barrier_t *bar
+				    __attribute__((unused)))
+{
+}
+
+void
+gomp_team_barrier_tasks_done (gomp_barrier_t *bar __attribute__((unused)))
+{
+}
+/* APPLE LOCAL end libgomp tasks */
@@ -48,6 +48,8 @@ typedef struct
 } gomp_barrier_t;
 
 extern void gomp_barrier_init (gomp_barrier_t *, unsigned);
+/* APPLE LOCAL libgomp tree barrier */
+extern void gomp_barrier_init_team (gomp_barrier_t *, unsigned);
 extern void gomp_barrier_reinit (gomp_barrier_t *, unsigned);
 extern void gomp_barrier_destroy (gomp_barrier_t *);
 
@@ -60,4 +62,16 @@ static inline bool gomp_barrier_wait_start (gomp_barrier_t *bar)
   return ++bar->arrived == bar->total;
 }
 
+/* APPLE LOCAL begin libgomp tasks */
+/* The threads of a team finish the team's deferred tasks before they
+   arrive at its barrier, since they can't be woken to help with them
+   afterwards.  */
+
+extern bool gomp_team_barrier_wait_start (gomp_barrier_t *);
+extern void gomp_team_barrier_wait (gomp_barrier_t *);
+extern void gomp_team_barrier_wait_end (gomp_barrier_t *, bool);
+extern void gomp_team_barrier_set_task_pending (gomp_barrier_t *);
+extern void gomp_team_barrier_tasks_done (gomp_barrier_t *);
+/* APPLE LOCAL end libgomp tasks */
+
 #endif /* GOMP_BARRIER_H */
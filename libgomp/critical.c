@@ -31,7 +31,8 @@
 #include <stdlib.h>
 
 
-static gomp_mutex_t default_lock;
+/* APPLE LOCAL libgomp striped atomic locks */
+static gomp_mutex_t default_lock __attribute__ ((aligned (GOMP_CACHE_LINE)));
 
 void
 GOMP_critical_start (void)
@@ -122,26 +123,76 @@ GOMP_critical_name_end (void **pptr)
    spec.  Which makes sense, since that's how several other compilers 
    handle this situation as well.  */
 
-static gomp_mutex_t atomic_lock;
+/* APPLE LOCAL begin libgomp striped atomic locks */
+/* There is one such mutex per stripe of the address space, each on a
+   cache line of its own, so that atomic updates of unrelated data don't
+   contend.  The stripe is picked by the cache line the data is in.  */
+
+#define GOMP_ATOMIC_LOCKS	64
+
+static struct
+{
+  gomp_mutex_t lock;
+} __attribute__ ((aligned (GOMP_CACHE_LINE)))
+  atomic_locks[GOMP_ATOMIC_LOCKS];
+
+static inline gomp_mutex_t *
+atomic_lock_for (void *addr)
+{
+  uintptr_t line = (uintptr_t) addr / GOMP_CACHE_LINE;
+
+  /* Neighbouring lines, and lines a page apart, get different locks.  */
+  line ^= line >> 6;
+  line ^= line >> 12;
+  return &atomic_locks[line % GOMP_ATOMIC_LOCKS].lock;
+}
+
+void
+GOMP_atomic_addr_start (void *addr)
+{
+  gomp_mutex_lock (atomic_lock_for (addr));
+}
+
+void
+GOMP_atomic_addr_end (void *addr)
+{
+  gomp_mutex_unlock (atomic_lock_for (addr));
+}
+
+/* These are what code built before GOMP_atomic_addr_start existed calls.
+   Not knowing the address, they take every lock, always in the same
+   order.  */
 
 void
 GOMP_atomic_start (void)
 {
-  gomp_mutex_lock (&atomic_lock);
+  int i;
+
+  for (i = 0; i < GOMP_ATOMIC_LOCKS; i++)
+    gomp_mutex_lock (&atomic_locks[i].lock);
 }
 
 void
 GOMP_atomic_end (void)
 {
-  gomp_mutex_unlock (&atomic_lock);
+  int i;
+
+  for (i = GOMP_ATOMIC_LOCKS - 1; i >= 0; i--)
+    gomp_mutex_unlock (&atomic_locks[i].lock);
 }
+/* APPLE LOCAL end libgomp striped atomic locks */
 
 #if !GOMP_MUTEX_INIT_0
 static void __attribute__((constructor))
 initialize_critical (void)
 {
+  /* APPLE LOCAL libgomp striped atomic locks */
+  int i;
+
   gomp_mutex_init (&default_lock);
-  gomp_mutex_init (&atomic_lock);
+  /* APPLE LOCAL libgomp striped atomic locks */
+  for (i = 0; i < GOMP_ATOMIC_LOCKS; i++)
+    gomp_mutex_init (&atomic_locks[i].lock);
 #ifndef HAVE_SYNC_BUILTINS
   gomp_mutex_init (&create_lock_lock);
 #endif
@@ -42,6 +42,22 @@ bool gomp_dyn_var = false;
 bool gomp_nest_var = false;
 enum gomp_schedule_type gomp_run_sched_var = GFS_DYNAMIC;
 unsigned long gomp_run_sched_chunk = 1;
+/* APPLE LOCAL begin libgomp spin wait */
+unsigned long long gomp_spin_count_var = 300000;
+unsigned long long gomp_throttled_spin_count_var = 100;
+unsigned long gomp_available_cpus = 1;
+/* APPLE LOCAL end libgomp spin wait */
+/* APPLE LOCAL libgomp tree barrier */
+unsigned long gomp_tree_barrier_threads = 16;
+/* APPLE LOCAL begin libgomp affinity */
+unsigned short *gomp_cpu_affinity;
+size_t gomp_cpu_affinity_len;
+/* APPLE LOCAL end libgomp affinity */
+/* APPLE LOCAL begin libgomp tracing */
+const char *gomp_trace_file;
+unsigned long gomp_trace_size = 65536;
+bool gomp_trace_var;
+/* APPLE LOCAL end libgomp tracing */
 
 /* Parse the OMP_SCHEDULE environment variable.  */
 
@@ -145,6 +161,172 @@ parse_unsigned_long (const char *name, unsigned long *pvalue)
   return false;
 }
 
+/* APPLE LOCAL begin libgomp spin wait */
+/* Parse a spin count from environment variable NAME.  The value is a
+   non-negative integer, or INFINITE to spin without limit.  Return true
+   if one was present and it was successfully parsed.  */
+
+static bool
+parse_spincount (const char *name, unsigned long long *pvalue)
+{
+  char *env, *end;
+  unsigned long long value;
+
+  env = getenv (name);
+  if (env == NULL)
+    return false;
+
+  while (isspace ((unsigned char) *env))
+    ++env;
+  if (strncasecmp (env, "infinite", 8) == 0
+      || strncasecmp (env, "infinity", 8) == 0)
+    {
+      value = ~0ULL;
+      end = env + 8;
+    }
+  else
+    {
+      if (!isdigit ((unsigned char) *env))
+	goto invalid;
+
+      errno = 0;
+      value = strtoull (env, &end, 10);
+      if (errno)
+	goto invalid;
+    }
+
+  while (isspace ((unsigned char) *end))
+    ++end;
+  if (*end != '\0')
+    goto invalid;
+
+  *pvalue = value;
+  return true;
+
+ invalid:
+  gomp_error ("Invalid value for environment variable %s", name);
+  return false;
+}
+
+/* Parse the OMP_WAIT_POLICY environment variable.  Return 1 for ACTIVE,
+   0 for PASSIVE and -1 if it is not set.  */
+
+static int
+parse_wait_policy (void)
+{
+  const char *env;
+  int ret = -1;
+
+  env = getenv ("OMP_WAIT_POLICY");
+  if (env == NULL)
+    return -1;
+
+  while (isspace ((unsigned char) *env))
+    ++env;
+  if (strncasecmp (env, "active", 6) == 0)
+    {
+      ret = 1;
+      env += 6;
+    }
+  else if (strncasecmp (env, "passive", 7) == 0)
+    {
+      ret = 0;
+      env += 7;
+    }
+  else
+    env = "X";
+  while (isspace ((unsigned char) *env))
+    ++env;
+  if (*env == '\0')
+    return ret;
+
+  gomp_error ("Invalid value for environment variable OMP_WAIT_POLICY");
+  return -1;
+}
+/* APPLE LOCAL end libgomp spin wait */
+
+/* APPLE LOCAL begin libgomp affinity */
+/* Parse the GOMP_CPU_AFFINITY environment variable, a list of CPU numbers
+   and ranges such as "0 3 4-7 8-15:2", separated by spaces or commas.
+   Return true if it was present and successfully parsed.  */
+
+static bool
+parse_affinity (void)
+{
+  char *env, *end;
+  unsigned long cpu_beg, cpu_end, cpu_stride;
+  unsigned short *cpus = NULL;
+  size_t allocated = 0, used = 0, needed;
+
+  env = getenv ("GOMP_CPU_AFFINITY");
+  if (env == NULL)
+    return false;
+
+  for (;;)
+    {
+      while (isspace ((unsigned char) *env) || *env == ',')
+	++env;
+      if (*env == '\0')
+	break;
+
+      if (!isdigit ((unsigned char) *env))
+	goto invalid;
+      errno = 0;
+      cpu_beg = strtoul (env, &end, 10);
+      if (errno || cpu_beg >= 65536)
+	goto invalid;
+      cpu_end = cpu_beg;
+      cpu_stride = 1;
+      env = end;
+
+      if (*env == '-')
+	{
+	  if (!isdigit ((unsigned char) *++env))
+	    goto invalid;
+	  errno = 0;
+	  cpu_end = strtoul (env, &end, 10);
+	  if (errno || cpu_end >= 65536 || cpu_end < cpu_beg)
+	    goto invalid;
+	  env = end;
+
+	  if (*env == ':')
+	    {
+	      if (!isdigit ((unsigned char) *++env))
+		goto invalid;
+	      errno = 0;
+	      cpu_stride = strtoul (env, &end, 10);
+	      if (errno || cpu_stride == 0 || cpu_stride >= 65536)
+		goto invalid;
+	      env = end;
+	    }
+	}
+      if (*env != '\0' && *env != ',' && !isspace ((unsigned char) *env))
+	goto invalid;
+
+      needed = (cpu_end - cpu_beg) / cpu_stride + 1;
+      if (used + needed > allocated)
+	{
+	  allocated = 2 * (used + needed);
+	  cpus = gomp_realloc (cpus, allocated * sizeof (cpus[0]));
+	}
+      for (; needed > 0; needed--, cpu_beg += cpu_stride)
+	cpus[used++] = cpu_beg;
+    }
+
+  if (used == 0)
+    goto invalid;
+
+  gomp_cpu_affinity = cpus;
+  gomp_cpu_affinity_len = used;
+  return true;
+
+ invalid:
+  gomp_error ("Invalid value for environment variable GOMP_CPU_AFFINITY");
+  free (cpus);
+  return false;
+}
+/* APPLE LOCAL end libgomp affinity */
+
 /* Parse a boolean value for environment variable NAME and store the 
    result in VALUE.  */
 
@@ -181,6 +363,10 @@ static void __attribute__((constructor))
 initialize_env (void)
 {
   unsigned long stacksize;
+  /* APPLE LOCAL libgomp spin wait */
+  int wait_policy;
+  /* APPLE LOCAL libgomp affinity */
+  bool proc_bind;
 
   /* Do a compile time check that mkomp_h.pl did good job.  */
   omp_check_defines ();
@@ -188,8 +374,51 @@ initialize_env (void)
   parse_schedule ();
   parse_boolean ("OMP_DYNAMIC", &gomp_dyn_var);
   parse_boolean ("OMP_NESTED", &gomp_nest_var);
-  if (!parse_unsigned_long ("OMP_NUM_THREADS", &gomp_nthreads_var))
-    gomp_init_num_threads ();
+  /* APPLE LOCAL begin libgomp spin wait */
+  gomp_init_num_threads ();
+  gomp_available_cpus = gomp_nthreads_var;
+  parse_unsigned_long ("OMP_NUM_THREADS", &gomp_nthreads_var);
+
+  /* By default spin for roughly as long as sleeping and being woken
+     would take, a few milliseconds on current processors.  Waiting
+     actively spins for minutes, and waiting passively not at all.  */
+  wait_policy = parse_wait_policy ();
+  if (!parse_spincount ("GOMP_SPINCOUNT", &gomp_spin_count_var))
+    {
+      if (wait_policy > 0)
+	gomp_spin_count_var = 30000000000ULL;
+      else if (wait_policy == 0)
+	gomp_spin_count_var = 0;
+    }
+  if (wait_policy > 0)
+    gomp_throttled_spin_count_var = 1000;
+  if (gomp_throttled_spin_count_var > gomp_spin_count_var)
+    gomp_throttled_spin_count_var = gomp_spin_count_var;
+  /* APPLE LOCAL end libgomp spin wait */
+  /* APPLE LOCAL libgomp tree barrier */
+  parse_unsigned_long ("GOMP_TREE_BARRIER", &gomp_tree_barrier_threads);
+  /* APPLE LOCAL begin libgomp affinity */
+  /* A CPU list binds threads unless OMP_PROC_BIND says otherwise, and
+     OMP_PROC_BIND alone binds them to the CPUs the process may use.  */
+  proc_bind = parse_affinity ();
+  parse_boolean ("OMP_PROC_BIND", &proc_bind);
+  if (proc_bind)
+    gomp_init_affinity ();
+  else
+    {
+      free (gomp_cpu_affinity);
+      gomp_cpu_affinity = NULL;
+      gomp_cpu_affinity_len = 0;
+    }
+  /* APPLE LOCAL end libgomp affinity */
+  /* APPLE LOCAL begin libgomp tracing */
+  gomp_trace_file = getenv ("GOMP_TRACE");
+  if (gomp_trace_file != NULL && *gomp_trace_file != '\0')
+    {
+      parse_unsigned_long ("GOMP_TRACE_SIZE", &gomp_trace_size);
+      gomp_init_trace ();
+    }
+  /* APPLE LOCAL end libgomp tracing */
 
   /* Not strictly environment related, but ordering constructors is tricky.  */
   pthread_attr_init (&gomp_thread_attr);
@@ -30,6 +30,8 @@
 
 #include "libgomp.h"
 #include <stdlib.h>
+/* APPLE LOCAL libgomp lock-free dispatch */
+#include <limits.h>
 
 
 /* This function implements the STATIC scheduling method.  The caller should
@@ -171,11 +173,41 @@ gomp_iter_dynamic_next_locked (long *pstart, long *pend)
   ws->next = end;
   *pstart = start;
   *pend = end;
+  /* APPLE LOCAL libgomp tracing */
+  gomp_trace (GOMP_TRACE_CHUNK, start, end);
   return true;
 }
 
 
 #ifdef HAVE_SYNC_BUILTINS
+/* APPLE LOCAL begin libgomp lock-free dispatch */
+/* Set WS->mode for a DYNAMIC schedule shared by NTHREADS threads.  Every
+   thread may carry ws->next one chunk past the end before it sees that
+   the loop is done, so a fetch-and-add is only used when that many chunks
+   past ws->end still fit in a long.  */
+
+void
+gomp_iter_dynamic_init (struct gomp_work_share *ws, unsigned nthreads)
+{
+  unsigned long chunk_size = ws->chunk_size;
+  unsigned long incr = ws->incr > 0 ? ws->incr : -(unsigned long) ws->incr;
+  unsigned long span;
+
+  ws->mode = 0;
+  if (ws->chunk_size <= 0 || incr > LONG_MAX / chunk_size)
+    return;
+  span = chunk_size * incr;
+  if (span > LONG_MAX / ((unsigned long) nthreads + 1))
+    return;
+  span *= (unsigned long) nthreads + 1;
+
+  if (ws->incr > 0)
+    ws->mode = ws->end <= LONG_MAX - (long) span;
+  else
+    ws->mode = ws->end >= LONG_MIN + (long) span;
+}
+/* APPLE LOCAL end libgomp lock-free dispatch */
+
 /* Similar, but doesn't require the lock held, and uses compare-and-swap
    instead.  Note that the only memory value that changes is ws->next.  */
 
@@ -186,11 +218,40 @@ gomp_iter_dynamic_next (long *pstart, long *pend)
   struct gomp_work_share *ws = thr->ts.work_share;
   long start, end, nend, chunk, incr;
 
-  start = ws->next;
   end = ws->end;
   incr = ws->incr;
   chunk = ws->chunk_size * incr;
 
+  /* APPLE LOCAL begin libgomp lock-free dispatch */
+  /* Claim a chunk without retrying, and clip it to the end.  */
+  if (__builtin_expect (ws->mode, 1))
+    {
+      start = __sync_fetch_and_add (&ws->next, chunk);
+      if (incr > 0)
+	{
+	  if (start >= end)
+	    return false;
+	  nend = start + chunk;
+	  if (nend > end)
+	    nend = end;
+	}
+      else
+	{
+	  if (start <= end)
+	    return false;
+	  nend = start + chunk;
+	  if (nend < end)
+	    nend = end;
+	}
+      *pstart = start;
+      *pend = nend;
+      /* APPLE LOCAL libgomp tracing */
+      gomp_trace (GOMP_TRACE_CHUNK, start, nend);
+      return true;
+    }
+
+  start = ws->next;
+  /* APPLE LOCAL end libgomp lock-free dispatch */
   while (1)
     {
       long left = end - start;
@@ -220,6 +281,8 @@ gomp_iter_dynamic_next (long *pstart, long *pend)
 
   *pstart = start;
   *pend = nend;
+  /* APPLE LOCAL libgomp tracing */
+  gomp_trace (GOMP_TRACE_CHUNK, start, nend);
   return true;
 }
 #endif /* HAVE_SYNC_BUILTINS */
@@ -256,6 +319,8 @@ gomp_iter_guided_next_locked (long *pstart, long *pend)
   ws->next = end;
   *pstart = start;
   *pend = end;
+  /* APPLE LOCAL libgomp tracing */
+  gomp_trace (GOMP_TRACE_CHUNK, start, end);
   return true;
 }
 
@@ -305,6 +370,8 @@ gomp_iter_guided_next (long *pstart, long *pend)
 
   *pstart = start;
   *pend = nend;
+  /* APPLE LOCAL libgomp tracing */
+  gomp_trace (GOMP_TRACE_CHUNK, start, nend);
   return true;
 }
 #endif /* HAVE_SYNC_BUILTINS */
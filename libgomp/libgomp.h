@@ -52,6 +52,12 @@
 #include "bar.h"
 
 
+/* APPLE LOCAL begin libgomp work share recycling */
+/* The cache line size assumed when laying out structures that several
+   threads write to at once.  */
+#define GOMP_CACHE_LINE		64
+/* APPLE LOCAL end libgomp work share recycling */
+
 /* This structure contains the data to control one work-sharing construct,
    either a LOOP (FOR/DO) or a SECTIONS.  */
 
@@ -81,8 +87,24 @@ struct gomp_work_share
      is always 1.  */
   long incr;
 
-  /* This lock protects the update of the following members.  */
-  gomp_mutex_t lock;
+  /* APPLE LOCAL begin libgomp lock-free dispatch */
+  /* Nonzero if a DYNAMIC schedule can hand out chunks with a plain
+     fetch-and-add on NEXT, which may then run past END.  */
+  int mode;
+  /* APPLE LOCAL end libgomp lock-free dispatch */
+
+  /* APPLE LOCAL begin libgomp work share recycling */
+  /* This is the block this structure was allocated at the start of.  */
+  void *alloc;
+
+  /* This links the spare work shares of a team.  */
+  struct gomp_work_share *next_free;
+
+  /* This lock protects the update of the following members.  It starts
+     a cache line of its own, so that threads taking iterations don't
+     keep pulling the read-mostly members above from each other.  */
+  gomp_mutex_t lock __attribute__ ((aligned (GOMP_CACHE_LINE)));
+  /* APPLE LOCAL end libgomp work share recycling */
 
   union {
     /* This is the next iteration value to be allocated.  In the case of
@@ -93,12 +115,6 @@ struct gomp_work_share
     void *copyprivate;
   };
 
-  /* This is the count of the number of threads that have exited the work
-     share construct.  If the construct was marked nowait, they have moved on
-     to other work; otherwise they're blocked on a barrier.  The last member
-     of the team to exit the work share construct must deallocate it.  */
-  unsigned threads_completed;
-
   /* This is the index into the circular queue ordered_team_ids of the 
      current thread that's allowed into the ordered reason.  */
   unsigned ordered_cur;
@@ -113,6 +129,16 @@ struct gomp_work_share
      to take the section next.  */
   unsigned ordered_owner;
 
+  /* APPLE LOCAL begin libgomp work share recycling */
+  /* This is the count of the number of threads that have exited the work
+     share construct.  If the construct was marked nowait, they have moved on
+     to other work; otherwise they're blocked on a barrier.  The last member
+     of the team to exit the work share construct must deallocate it.
+     Every thread of the team writes it once at the end of the construct,
+     so it is kept off the cache line of LOCK and NEXT.  */
+  unsigned threads_completed __attribute__ ((aligned (GOMP_CACHE_LINE)));
+  /* APPLE LOCAL end libgomp work share recycling */
+
   /* This is a circular queue that details which threads will be allowed
      into the ordered region and in which order.  When a thread allocates
      iterations on which it is going to work, it also registers itself at
@@ -122,6 +148,65 @@ struct gomp_work_share
   unsigned ordered_team_ids[];
 };
 
+/* APPLE LOCAL begin libgomp tasks */
+/* This structure describes a task: the implicit task of a thread in a
+   team, or an explicit task created by a TASK construct.  */
+
+struct gomp_task
+{
+  /* This is the task that created this one, or NULL for an implicit
+     task.  */
+  struct gomp_task *parent;
+
+  /* This is the function to run for a deferred explicit task, and its
+     argument, a copy of the data block given to GOMP_task.  */
+  void (*fn) (void *);
+  void *fn_data;
+
+  /* This is one for the task itself until it has finished, plus one for
+     each of its children that hasn't been freed.  An explicit task is
+     freed when it drops to zero, which keeps the parent chain of any
+     unfinished task intact.  */
+  unsigned long refs;
+
+  /* This is the number of children that haven't finished, which
+     TASKWAIT waits for.  */
+  unsigned long children;
+};
+
+/* This is a work-stealing deque of deferred tasks.  The owning thread
+   pushes and pops tasks at the bottom; the other threads of the team
+   steal the oldest tasks from the top.  */
+
+struct gomp_task_deque
+{
+  /* This lock protects the following members.  It is only contended
+     when another thread steals from this deque.  */
+  gomp_mutex_t lock;
+
+  /* This is a circular buffer of SIZE entries, a power of two.  The
+     tasks are those from TOP up to but not including BOTTOM.  */
+  struct gomp_task **tasks;
+  unsigned long top;
+  unsigned long bottom;
+  unsigned long size;
+};
+/* APPLE LOCAL end libgomp tasks */
+
+/* APPLE LOCAL begin libgomp tree reductions */
+/* This is the slot of one thread of a team in a reduction.  A thread
+   publishes the block holding its partial results in DATA and posts
+   READY, and waits on CONSUMED until the thread it hands them to has
+   merged them.  Each slot has a cache line of its own.  */
+
+struct gomp_reduction_slot
+{
+  void *data;
+  gomp_sem_t ready;
+  gomp_sem_t consumed;
+} __attribute__ ((aligned (GOMP_CACHE_LINE)));
+/* APPLE LOCAL end libgomp tree reductions */
+
 /* This structure contains all of the thread-local data associated with 
    a thread team.  This is the data that must be saved when a thread
    encounters a nested PARALLEL construct.  */
@@ -131,6 +216,12 @@ struct gomp_team_state
   /* This is the team of which the thread is currently a member.  */
   struct gomp_team *team;
 
+  /* APPLE LOCAL begin libgomp tasks */
+  /* This is the task the thread is currently running, or NULL if it
+     isn't a member of a team.  */
+  struct gomp_task *task;
+  /* APPLE LOCAL end libgomp tasks */
+
   /* This is the work share construct which this thread is currently
      processing.  Recall that with NOWAIT, not all threads may be 
      processing the same construct.  This value is NULL when there
@@ -181,6 +272,15 @@ struct gomp_team
   unsigned oldest_live_gen;
   unsigned num_live_gen;
 
+  /* APPLE LOCAL begin libgomp work share recycling */
+  /* This is a list of finished work shares, linked through next_free,
+     kept to be reused by later constructs of the team.  It holds at most
+     as many as the work_shares array, and is also protected by
+     work_share_lock.  */
+  struct gomp_work_share *work_share_list;
+  unsigned work_share_list_len;
+  /* APPLE LOCAL end libgomp work share recycling */
+
   /* This is the number of threads in the current team.  */
   unsigned nthreads;
 
@@ -196,6 +296,33 @@ struct gomp_team
      parallels, as the master is a member of two teams.  */
   gomp_sem_t master_release;
 
+  /* APPLE LOCAL begin libgomp tasks */
+  /* This is the number of explicit tasks that have been deferred and
+     haven't finished yet, and the number of those that are still
+     waiting in a deque.  The team barrier can't complete while
+     TASK_COUNT is nonzero.  */
+  unsigned long task_count;
+  unsigned long task_queued;
+
+  /* These are the implicit task and the deque of deferred tasks of each
+     thread of the team, indexed by team_id.  */
+  struct gomp_task *implicit_tasks;
+  struct gomp_task_deque *task_deques;
+  /* APPLE LOCAL end libgomp tasks */
+
+  /* APPLE LOCAL begin libgomp tree reductions */
+  /* These are the reduction slots of the threads of the team, indexed
+     by team_id, and the block they were allocated in.  */
+  struct gomp_reduction_slot *reduction_slots;
+  void *reduction_alloc;
+  /* APPLE LOCAL end libgomp tree reductions */
+
+  /* APPLE LOCAL begin libgomp tracing */
+  /* The number of the team's parallel region in the trace, or zero if
+     events are not being recorded.  */
+  unsigned long trace_region;
+  /* APPLE LOCAL end libgomp tracing */
+
   /* This array contains pointers to the release semaphore of the threads
      in the team.  */
   gomp_sem_t *ordered_release[];
@@ -216,6 +343,24 @@ struct gomp_thread
 
   /* This semaphore is used for ordered loops.  */
   gomp_sem_t release;
+
+  /* APPLE LOCAL begin libgomp nested pool */
+  /* This semaphore releases a thread waiting in the pool of threads for
+     nested teams.  */
+  gomp_sem_t pool_release;
+  /* APPLE LOCAL end libgomp nested pool */
+
+  /* APPLE LOCAL begin libgomp tree reductions */
+  /* This is the number of levels of the reduction tree the thread has
+     merged its children at in the current reduction.  */
+  unsigned reduction_level;
+  /* APPLE LOCAL end libgomp tree reductions */
+
+  /* APPLE LOCAL begin libgomp tracing */
+  /* This is where the thread records events when tracing, allocated
+     on its first event.  */
+  struct gomp_trace_buffer *trace;
+  /* APPLE LOCAL end libgomp tracing */
 };
 
 /* ... and here is that TLS data.  */
@@ -243,6 +388,41 @@ extern bool gomp_nest_var;
 extern enum gomp_schedule_type gomp_run_sched_var;
 extern unsigned long gomp_run_sched_chunk;
 
+/* APPLE LOCAL begin libgomp spin wait */
+/* How many times a thread checks for the event it is waiting for before
+   it goes to sleep, normally and when there are more threads than
+   processors.  These are set by GOMP_SPINCOUNT and OMP_WAIT_POLICY.  */
+extern unsigned long long gomp_spin_count_var;
+extern unsigned long long gomp_throttled_spin_count_var;
+
+/* The number of processors online, and the number of threads libgomp
+   has started plus the initial thread.  */
+extern unsigned long gomp_available_cpus;
+extern unsigned long gomp_managed_threads;
+/* APPLE LOCAL end libgomp spin wait */
+
+/* APPLE LOCAL begin libgomp tree barrier */
+/* Teams of at least this many threads use a combining tree barrier,
+   where the target has one.  This is set by GOMP_TREE_BARRIER.  */
+extern unsigned long gomp_tree_barrier_threads;
+/* APPLE LOCAL end libgomp tree barrier */
+
+/* APPLE LOCAL begin libgomp affinity */
+/* The CPUs that team members are bound to, from GOMP_CPU_AFFINITY or
+   OMP_PROC_BIND, or NULL if threads aren't bound.  */
+extern unsigned short *gomp_cpu_affinity;
+extern size_t gomp_cpu_affinity_len;
+/* APPLE LOCAL end libgomp affinity */
+
+/* APPLE LOCAL begin libgomp tracing */
+/* The file GOMP_TRACE names, to which events are written at exit, and
+   how many of the latest events GOMP_TRACE_SIZE says each thread
+   keeps.  Events are only recorded if gomp_trace_var is set.  */
+extern const char *gomp_trace_file;
+extern unsigned long gomp_trace_size;
+extern bool gomp_trace_var;
+/* APPLE LOCAL end libgomp tracing */
+
 /* The attributes to be used during thread creation.  */
 extern pthread_attr_t gomp_thread_attr;
 
@@ -272,6 +452,8 @@ extern bool gomp_iter_dynamic_next_locked (long *, long *);
 extern bool gomp_iter_guided_next_locked (long *, long *);
 
 #ifdef HAVE_SYNC_BUILTINS
+/* APPLE LOCAL libgomp lock-free dispatch */
+extern void gomp_iter_dynamic_init (struct gomp_work_share *, unsigned);
 extern bool gomp_iter_dynamic_next (long *, long *);
 extern bool gomp_iter_guided_next (long *, long *);
 #endif
@@ -294,6 +476,67 @@ extern unsigned gomp_resolve_num_threads (unsigned);
 extern void gomp_init_num_threads (void);
 extern unsigned gomp_dynamic_max_threads (void);
 
+/* APPLE LOCAL begin libgomp affinity */
+/* affinity.c (in config/) */
+
+extern void gomp_init_affinity (void);
+extern void gomp_init_thread_affinity (pthread_attr_t *, unsigned);
+/* APPLE LOCAL end libgomp affinity */
+
+/* APPLE LOCAL begin libgomp tree reductions */
+/* reduction.c */
+
+extern void gomp_init_reductions (struct gomp_team *);
+extern void gomp_free_reductions (struct gomp_team *);
+/* APPLE LOCAL end libgomp tree reductions */
+
+/* APPLE LOCAL begin libgomp tracing */
+/* trace.c */
+
+enum gomp_trace_kind
+{
+  /* The master starts and ends parallel region B, of A threads.
+     Regions are numbered from 1 in the order they start.  */
+  GOMP_TRACE_REGION_START,
+  GOMP_TRACE_REGION_END,
+  /* Thread A of the team of region B arrives at and leaves a team
+     barrier.  */
+  GOMP_TRACE_BARRIER_ARRIVE,
+  GOMP_TRACE_BARRIER_DEPART,
+  /* A thread arrives at and leaves the dock, where idle threads wait
+     for a team.  */
+  GOMP_TRACE_DOCK_ARRIVE,
+  GOMP_TRACE_DOCK_DEPART,
+  /* A thread takes iterations A to B of a dynamic or guided loop, or
+     sections A to B.  */
+  GOMP_TRACE_CHUNK,
+  /* A thread has waited A nanoseconds for a contended lock.  */
+  GOMP_TRACE_LOCK_WAIT
+};
+
+extern void gomp_init_trace (void);
+extern unsigned long long gomp_trace_time (void);
+extern unsigned long gomp_trace_new_region (void);
+extern void gomp_trace_record (enum gomp_trace_kind, long, long);
+
+static inline void
+gomp_trace (enum gomp_trace_kind kind, long a, long b)
+{
+  if (__builtin_expect (gomp_trace_var, 0))
+    gomp_trace_record (kind, a, b);
+}
+/* APPLE LOCAL end libgomp tracing */
+
+/* APPLE LOCAL begin libgomp tasks */
+/* task.c */
+
+extern void gomp_init_task (struct gomp_task *, struct gomp_task *);
+extern void gomp_init_task_deques (struct gomp_team *);
+extern void gomp_free_task_deques (struct gomp_team *);
+extern bool gomp_barrier_handle_tasks (void);
+extern void gomp_barrier_drain_tasks (void);
+/* APPLE LOCAL end libgomp tasks */
+
 /* team.c */
 
 extern void gomp_team_start (void (*) (void *), void *, unsigned,
@@ -306,6 +549,8 @@ extern struct gomp_work_share * gomp_new_work_share (bool, unsigned);
 extern bool gomp_work_share_start (bool);
 extern void gomp_work_share_end (void);
 extern void gomp_work_share_end_nowait (void);
+/* APPLE LOCAL libgomp work share recycling */
+extern void gomp_free_work_share_list (struct gomp_team *);
 
 #ifdef HAVE_ATTRIBUTE_VISIBILITY
 # pragma GCC visibility pop
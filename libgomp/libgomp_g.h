@@ -45,6 +45,10 @@ extern void GOMP_critical_name_start (void **);
 extern void GOMP_critical_name_end (void **);
 extern void GOMP_atomic_start (void);
 extern void GOMP_atomic_end (void);
+/* APPLE LOCAL begin libgomp striped atomic locks */
+extern void GOMP_atomic_addr_start (void *);
+extern void GOMP_atomic_addr_end (void *);
+/* APPLE LOCAL end libgomp striped atomic locks */
 
 /* loop.c */
 
@@ -108,4 +112,21 @@ extern bool GOMP_single_start (void);
 extern void *GOMP_single_copy_start (void);
 extern void GOMP_single_copy_end (void *);
 
+/* APPLE LOCAL begin libgomp tasks */
+/* task.c */
+
+#define GOMP_TASK_FLAG_UNTIED	1
+
+extern void GOMP_task (void (*) (void *), void *, void (*) (void *, void *),
+		       long, long, bool, unsigned);
+extern void GOMP_taskwait (void);
+/* APPLE LOCAL end libgomp tasks */
+
+/* APPLE LOCAL begin libgomp tree reductions */
+/* reduction.c */
+
+extern void *GOMP_reduction_next (void *);
+extern bool GOMP_reduction_end (void);
+/* APPLE LOCAL end libgomp tree reductions */
+
 #endif /* LIBGOMP_G_H */
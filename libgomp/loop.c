@@ -84,8 +84,16 @@ gomp_loop_dynamic_start (long start, long end, long incr, long chunk_size,
   bool ret;
 
   if (gomp_work_share_start (false))
-    gomp_loop_init (thr->ts.work_share, start, end, incr,
-		    GFS_DYNAMIC, chunk_size);
+    {
+      gomp_loop_init (thr->ts.work_share, start, end, incr,
+		      GFS_DYNAMIC, chunk_size);
+      /* APPLE LOCAL begin libgomp lock-free dispatch */
+#ifdef HAVE_SYNC_BUILTINS
+      gomp_iter_dynamic_init (thr->ts.work_share,
+			      thr->ts.team ? thr->ts.team->nthreads : 1);
+#endif
+      /* APPLE LOCAL end libgomp lock-free dispatch */
+    }
 
 #ifdef HAVE_SYNC_BUILTINS
   gomp_mutex_unlock (&thr->ts.work_share->lock);
@@ -380,6 +388,12 @@ gomp_parallel_loop_start (void (*fn) (void *), void *data,
   num_threads = gomp_resolve_num_threads (num_threads);
   ws = gomp_new_work_share (false, num_threads);
   gomp_loop_init (ws, start, end, incr, sched, chunk_size);
+  /* APPLE LOCAL begin libgomp lock-free dispatch */
+#ifdef HAVE_SYNC_BUILTINS
+  if (sched == GFS_DYNAMIC)
+    gomp_iter_dynamic_init (ws, num_threads);
+#endif
+  /* APPLE LOCAL end libgomp lock-free dispatch */
   gomp_team_start (fn, data, num_threads, ws);
 }
 
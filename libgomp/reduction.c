@@ -0,0 +1,160 @@
+/* APPLE LOCAL file libgomp tree reductions */
+/* Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This file is part of the GNU OpenMP Library (libgomp).
+
+   Libgomp is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation; either version 2.1 of the License, or
+   (at your option) any later version.
+
+   Libgomp is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+   FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+   more details.
+
+   You should have received a copy of the GNU Lesser General Public License 
+   along with libgomp; see the file COPYING.LIB.  If not, write to the
+   Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA.  */
+
+/* As a special exception, if you link this library with other files, some
+   of which are compiled with GCC, to produce an executable, this library
+   does not by itself cause the resulting executable to be covered by the
+   GNU General Public License.  This exception does not however invalidate
+   any other reasons why the executable file might be covered by the GNU
+   General Public License.  */
+
+/* This file handles the REDUCTION clause.  Each thread of the team
+   gathers its partial results in a block of its own, and the blocks are
+   combined pairwise in a binary tree: at level L, a thread whose team_id
+   has its low L bits clear merges the block of the thread L above it,
+   if there is one, unless bit L of its own team_id is set, in which case
+   it hands its block on instead.  Thread 0 ends up with the total, and
+   alone merges it into the shared variables.  The compiler generates
+
+     copy the private results into BLOCK;
+     while ((p = GOMP_reduction_next (&BLOCK)) != NULL)
+       merge *P into BLOCK;
+     if (GOMP_reduction_end ())
+       merge BLOCK into the shared variables;  */
+
+#include "libgomp.h"
+#include <stdlib.h>
+
+
+/* Allocate the reduction slots of TEAM.  */
+
+void
+gomp_init_reductions (struct gomp_team *team)
+{
+  char *p;
+  unsigned i;
+
+  if (team->nthreads == 1)
+    {
+      team->reduction_slots = NULL;
+      team->reduction_alloc = NULL;
+      return;
+    }
+
+  team->reduction_alloc
+    = gomp_malloc (GOMP_CACHE_LINE - 1
+		   + team->nthreads * sizeof (struct gomp_reduction_slot));
+  p = (char *) (((uintptr_t) team->reduction_alloc + GOMP_CACHE_LINE - 1)
+		& -(uintptr_t) GOMP_CACHE_LINE);
+  team->reduction_slots = (struct gomp_reduction_slot *) p;
+  for (i = 0; i < team->nthreads; i++)
+    {
+      team->reduction_slots[i].data = NULL;
+      gomp_sem_init (&team->reduction_slots[i].ready, 0);
+      gomp_sem_init (&team->reduction_slots[i].consumed, 0);
+    }
+}
+
+void
+gomp_free_reductions (struct gomp_team *team)
+{
+  unsigned i;
+
+  if (team->reduction_slots == NULL)
+    return;
+
+  for (i = 0; i < team->nthreads; i++)
+    {
+      gomp_sem_destroy (&team->reduction_slots[i].ready);
+      gomp_sem_destroy (&team->reduction_slots[i].consumed);
+    }
+  free (team->reduction_alloc);
+}
+
+
+/* Called repeatedly by each thread of the team with DATA, the block of
+   its partial results.  Return the block of the next thread whose
+   results are to be merged into DATA, once that thread has merged all of
+   its own, or NULL if there are no more.  The block returned by one call
+   is let go by the next.  */
+
+void *
+GOMP_reduction_next (void *data)
+{
+  struct gomp_thread *thr = gomp_thread ();
+  struct gomp_team *team = thr->ts.team;
+  struct gomp_reduction_slot *slots;
+  unsigned id, level, child;
+
+  if (team == NULL || team->nthreads == 1)
+    return NULL;
+
+  slots = team->reduction_slots;
+  id = thr->ts.team_id;
+  level = thr->reduction_level;
+
+  /* The thread merged at the previous call can go on.  */
+  if (level > 0)
+    gomp_sem_post (&slots[id + (1u << (level - 1))].consumed);
+
+  for (;; level++)
+    {
+      unsigned bit = 1u << level;
+
+      if (id & bit)
+	{
+	  slots[id].data = data;
+	  gomp_sem_post (&slots[id].ready);
+	  return NULL;
+	}
+
+      if (bit >= team->nthreads)
+	return NULL;
+
+      child = id + bit;
+      if (child < team->nthreads)
+	{
+	  gomp_sem_wait (&slots[child].ready);
+	  thr->reduction_level = level + 1;
+	  return slots[child].data;
+	}
+    }
+}
+
+
+/* Called by each thread of the team once GOMP_reduction_next has returned
+   NULL.  Return true for the one thread that is to merge the total into
+   the shared variables.  The others wait until their blocks have been
+   merged, since the blocks go when they return.  */
+
+bool
+GOMP_reduction_end (void)
+{
+  struct gomp_thread *thr = gomp_thread ();
+  struct gomp_team *team = thr->ts.team;
+
+  thr->reduction_level = 0;
+
+  if (team == NULL || team->nthreads == 1 || thr->ts.team_id == 0)
+    return true;
+
+  gomp_sem_wait (&team->reduction_slots[thr->ts.team_id].consumed);
+  return false;
+}
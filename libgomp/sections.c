@@ -58,15 +58,31 @@ GOMP_sections_start (unsigned count)
   struct gomp_thread *thr = gomp_thread ();
   long s, e, ret;
 
+  /* APPLE LOCAL begin libgomp lock-free dispatch */
   if (gomp_work_share_start (false))
-    gomp_sections_init (thr->ts.work_share, count);
-
+    {
+      gomp_sections_init (thr->ts.work_share, count);
+#ifdef HAVE_SYNC_BUILTINS
+      gomp_iter_dynamic_init (thr->ts.work_share,
+			      thr->ts.team ? thr->ts.team->nthreads : 1);
+#endif
+    }
+
+#ifdef HAVE_SYNC_BUILTINS
+  gomp_mutex_unlock (&thr->ts.work_share->lock);
+  if (gomp_iter_dynamic_next (&s, &e))
+    ret = s;
+  else
+    ret = 0;
+#else
   if (gomp_iter_dynamic_next_locked (&s, &e))
     ret = s;
   else
     ret = 0;
 
   gomp_mutex_unlock (&thr->ts.work_share->lock);
+#endif
+  /* APPLE LOCAL end libgomp lock-free dispatch */
 
   return ret;
 }
@@ -83,15 +99,25 @@ GOMP_sections_start (unsigned count)
 unsigned
 GOMP_sections_next (void)
 {
-  struct gomp_thread *thr = gomp_thread ();
   long s, e, ret;
 
+  /* APPLE LOCAL begin libgomp lock-free dispatch */
+#ifdef HAVE_SYNC_BUILTINS
+  if (gomp_iter_dynamic_next (&s, &e))
+    ret = s;
+  else
+    ret = 0;
+#else
+  struct gomp_thread *thr = gomp_thread ();
+
   gomp_mutex_lock (&thr->ts.work_share->lock);
   if (gomp_iter_dynamic_next_locked (&s, &e))
     ret = s;
   else
     ret = 0;
   gomp_mutex_unlock (&thr->ts.work_share->lock);
+#endif
+  /* APPLE LOCAL end libgomp lock-free dispatch */
 
   return ret;
 }
@@ -111,6 +137,11 @@ GOMP_parallel_sections_start (void (*fn) (void *), void *data,
 
   ws = gomp_new_work_share (false, num_threads);
   gomp_sections_init (ws, count);
+  /* APPLE LOCAL begin libgomp lock-free dispatch */
+#ifdef HAVE_SYNC_BUILTINS
+  gomp_iter_dynamic_init (ws, num_threads);
+#endif
+  /* APPLE LOCAL end libgomp lock-free dispatch */
   gomp_team_start (fn, data, num_threads, ws);
 }
 
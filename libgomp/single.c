@@ -63,7 +63,8 @@ GOMP_single_copy_start (void)
     ret = NULL;
   else
     {
-      gomp_barrier_wait (&thr->ts.team->barrier);
+      /* APPLE LOCAL libgomp tasks */
+      gomp_team_barrier_wait (&thr->ts.team->barrier);
 
       ret = thr->ts.work_share->copyprivate;
       gomp_work_share_end_nowait ();
@@ -84,7 +85,8 @@ GOMP_single_copy_end (void *data)
   if (team != NULL)
     {
       thr->ts.work_share->copyprivate = data;
-      gomp_barrier_wait (&team->barrier);
+      /* APPLE LOCAL libgomp tasks */
+      gomp_team_barrier_wait (&team->barrier);
     }
 
   gomp_work_share_end_nowait ();
@@ -0,0 +1,409 @@
+/* APPLE LOCAL file libgomp tasks */
+/* Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This file is part of the GNU OpenMP Library (libgomp).
+
+   Libgomp is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation; either version 2.1 of the License, or
+   (at your option) any later version.
+
+   Libgomp is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+   FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+   more details.
+
+   You should have received a copy of the GNU Lesser General Public License 
+   along with libgomp; see the file COPYING.LIB.  If not, write to the
+   Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA.  */
+
+/* As a special exception, if you link this library with other files, some
+   of which are compiled with GCC, to produce an executable, this library
+   does not by itself cause the resulting executable to be covered by the
+   GNU General Public License.  This exception does not however invalidate
+   any other reasons why the executable file might be covered by the GNU
+   General Public License.  */
+
+/* This file handles the TASK and TASKWAIT constructs.  A deferred task
+   goes to the bottom of the deque of the thread that created it.  That
+   thread takes its newest tasks back from the bottom when it waits for
+   them, and the other threads of the team steal the oldest ones from the
+   top when they have nothing else to do, which is while they wait at the
+   team barrier.  */
+
+#include "libgomp.h"
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+
+/* When this many deferred tasks per thread are waiting to run, new tasks
+   are run at once instead, so that deep recursions don't queue ever more
+   tasks.  */
+#define GOMP_TASK_QUEUED_MAX 64
+
+/* This is the initial size of a task deque.  */
+#define GOMP_TASK_DEQUE_SIZE 32
+
+#ifdef HAVE_SYNC_BUILTINS
+static inline unsigned long
+task_add (unsigned long *p, long n)
+{
+  return __sync_add_and_fetch (p, n);
+}
+#else
+static gomp_mutex_t gomp_task_lock;
+
+static inline unsigned long
+task_add (unsigned long *p, long n)
+{
+  unsigned long ret;
+
+  gomp_mutex_lock (&gomp_task_lock);
+  ret = *p += n;
+  gomp_mutex_unlock (&gomp_task_lock);
+  return ret;
+}
+
+static void __attribute__((constructor))
+initialize_task (void)
+{
+  gomp_mutex_init (&gomp_task_lock);
+}
+#endif
+
+static inline unsigned long
+task_read (unsigned long *p)
+{
+  return *(volatile unsigned long *) p;
+}
+
+/* Initialize TASK as a child of PARENT that hasn't started yet.  */
+
+void
+gomp_init_task (struct gomp_task *task, struct gomp_task *parent)
+{
+  task->parent = parent;
+  task->fn = NULL;
+  task->fn_data = NULL;
+  task->refs = 1;
+  task->children = 0;
+}
+
+/* Set up the implicit tasks and the task deques of TEAM.  */
+
+void
+gomp_init_task_deques (struct gomp_team *team)
+{
+  unsigned i;
+
+  team->task_count = 0;
+  team->task_queued = 0;
+  team->implicit_tasks
+    = gomp_malloc (team->nthreads * sizeof (team->implicit_tasks[0]));
+  team->task_deques
+    = gomp_malloc (team->nthreads * sizeof (team->task_deques[0]));
+  for (i = 0; i < team->nthreads; i++)
+    {
+      gomp_init_task (&team->implicit_tasks[i], NULL);
+      gomp_mutex_init (&team->task_deques[i].lock);
+      team->task_deques[i].tasks = NULL;
+      team->task_deques[i].top = 0;
+      team->task_deques[i].bottom = 0;
+      team->task_deques[i].size = 0;
+    }
+}
+
+void
+gomp_free_task_deques (struct gomp_team *team)
+{
+  unsigned i;
+
+  for (i = 0; i < team->nthreads; i++)
+    {
+      gomp_mutex_destroy (&team->task_deques[i].lock);
+      free (team->task_deques[i].tasks);
+    }
+  free (team->task_deques);
+  free (team->implicit_tasks);
+}
+
+/* Push TASK onto the bottom of DQ, growing it if it is full.  */
+
+static void
+gomp_task_push (struct gomp_task_deque *dq, struct gomp_task *task)
+{
+  gomp_mutex_lock (&dq->lock);
+  if (dq->bottom - dq->top == dq->size)
+    {
+      unsigned long i, size = dq->size ? 2 * dq->size : GOMP_TASK_DEQUE_SIZE;
+      struct gomp_task **tasks = gomp_malloc (size * sizeof (tasks[0]));
+
+      for (i = dq->top; i != dq->bottom; i++)
+	tasks[i & (size - 1)] = dq->tasks[i & (dq->size - 1)];
+      free (dq->tasks);
+      dq->tasks = tasks;
+      dq->size = size;
+    }
+  dq->tasks[dq->bottom++ & (dq->size - 1)] = task;
+  gomp_mutex_unlock (&dq->lock);
+}
+
+/* Return true if TASK was created, directly or not, by ANCESTOR.  Every
+   unfinished task holds a reference to its parent, so the chain can be
+   followed safely.  */
+
+static bool
+gomp_task_descendant_p (struct gomp_task *task, struct gomp_task *ancestor)
+{
+  for (task = task->parent; task != NULL; task = task->parent)
+    if (task == ancestor)
+      return true;
+  return false;
+}
+
+/* Take the newest task from the bottom of DQ, if there is one and it
+   descends from ANCESTOR, or ANCESTOR is NULL.  */
+
+static struct gomp_task *
+gomp_task_pop (struct gomp_task_deque *dq, struct gomp_task *ancestor)
+{
+  struct gomp_task *task = NULL;
+
+  if (task_read (&dq->bottom) == task_read (&dq->top))
+    return NULL;
+
+  gomp_mutex_lock (&dq->lock);
+  if (dq->bottom != dq->top)
+    {
+      struct gomp_task *newest = dq->tasks[(dq->bottom - 1) & (dq->size - 1)];
+
+      if (ancestor == NULL || gomp_task_descendant_p (newest, ancestor))
+	{
+	  dq->bottom--;
+	  task = newest;
+	}
+    }
+  gomp_mutex_unlock (&dq->lock);
+  return task;
+}
+
+/* Take the oldest task from the top of DQ, if there is one.  */
+
+static struct gomp_task *
+gomp_task_steal (struct gomp_task_deque *dq)
+{
+  struct gomp_task *task = NULL;
+
+  if (task_read (&dq->bottom) == task_read (&dq->top))
+    return NULL;
+
+  gomp_mutex_lock (&dq->lock);
+  if (dq->bottom != dq->top)
+    task = dq->tasks[dq->top++ & (dq->size - 1)];
+  gomp_mutex_unlock (&dq->lock);
+  return task;
+}
+
+/* Drop a reference to TASK, freeing it and dropping the reference it
+   held to its parent if that was the last one.  */
+
+static void
+gomp_task_unref (struct gomp_task *task)
+{
+  while (task != NULL && task_add (&task->refs, -1) == 0)
+    {
+      struct gomp_task *parent = task->parent;
+
+      free (task);
+      task = parent;
+    }
+}
+
+/* Run the deferred TASK of TEAM on the current thread THR.  */
+
+static void
+gomp_task_run (struct gomp_thread *thr, struct gomp_team *team,
+	       struct gomp_task *task)
+{
+  struct gomp_task *prev = thr->ts.task;
+
+  thr->ts.task = task;
+  task->fn (task->fn_data);
+  thr->ts.task = prev;
+
+  task_add (&task->parent->children, -1);
+  gomp_task_unref (task);
+
+  /* Once this drops to zero the team may be released from its barrier
+     and freed, so this must be the last use of the task structures.  */
+  if (task_add (&team->task_count, -1) == 0)
+    gomp_team_barrier_tasks_done (&team->barrier);
+}
+
+/* Spin, giving up the processor now and then, while waiting for tasks
+   running on other threads.  */
+
+static inline void
+gomp_task_relax (unsigned *spins)
+{
+  if ((++*spins & 63) == 0)
+    sched_yield ();
+}
+
+/* Wait until *COUNT, one of TASK's counts, drops to UNTIL, running the
+   descendants of TASK that are still in this thread's deque meanwhile.
+   The other tasks it waits for have been stolen and are running.  */
+
+static void
+gomp_task_wait (struct gomp_thread *thr, struct gomp_task *task,
+		unsigned long *count, unsigned long until)
+{
+  struct gomp_team *team = thr->ts.team;
+  unsigned spins = 0;
+
+  while (task_read (count) != until)
+    {
+      struct gomp_task *child = NULL;
+
+      if (team != NULL)
+	child = gomp_task_pop (&team->task_deques[thr->ts.team_id], task);
+      if (child != NULL)
+	{
+	  task_add (&team->task_queued, -1);
+	  gomp_task_run (thr, team, child);
+	  spins = 0;
+	}
+      else
+	gomp_task_relax (&spins);
+    }
+}
+
+/* Run the deferred tasks of the current thread's team, its own newest
+   first and then those of the other threads, until there are none left
+   to take.  Return true if any were run.  This is called while waiting
+   at the team barrier.  */
+
+bool
+gomp_barrier_handle_tasks (void)
+{
+  struct gomp_thread *thr = gomp_thread ();
+  struct gomp_team *team = thr->ts.team;
+  unsigned i, n = team->nthreads, id = thr->ts.team_id;
+  bool ran = false;
+
+  while (task_read (&team->task_queued) != 0)
+    {
+      struct gomp_task *task;
+
+      task = gomp_task_pop (&team->task_deques[id], NULL);
+      for (i = 1; task == NULL && i < n; i++)
+	task = gomp_task_steal (&team->task_deques[(id + i) % n]);
+      if (task == NULL)
+	break;
+
+      task_add (&team->task_queued, -1);
+      gomp_task_run (thr, team, task);
+      ran = true;
+    }
+
+  return ran;
+}
+
+/* Run or wait for the deferred tasks of the current thread's team until
+   all of them have finished.  This is for team barriers that can't let
+   threads help with the tasks once they have arrived.  */
+
+void
+gomp_barrier_drain_tasks (void)
+{
+  struct gomp_team *team = gomp_thread ()->ts.team;
+  unsigned spins = 0;
+
+  while (task_read (&team->task_count) != 0)
+    if (gomp_barrier_handle_tasks ())
+      spins = 0;
+    else
+      gomp_task_relax (&spins);
+}
+
+/* Called when encountering a TASK construct.  FN is the task body, to be
+   called with a copy of the ARG_SIZE bytes at DATA, aligned to ARG_ALIGN.
+   The copy is made with CPYFN if it isn't NULL, and with memcpy
+   otherwise.  If IF_CLAUSE is false the task is run at once, as it is if
+   there is no team to share it with.  FLAGS holds GOMP_TASK_FLAG_UNTIED,
+   which makes no difference here since a task always finishes on the
+   thread that started it.  */
+
+void
+GOMP_task (void (*fn) (void *), void *data, void (*cpyfn) (void *, void *),
+	   long arg_size, long arg_align, bool if_clause,
+	   unsigned flags __attribute__((unused)))
+{
+  struct gomp_thread *thr = gomp_thread ();
+  struct gomp_team *team = thr->ts.team;
+  struct gomp_task *task, *parent = thr->ts.task;
+  char *arg;
+
+  if (!if_clause
+      || team == NULL
+      || team->nthreads == 1
+      || (task_read (&team->task_queued)
+	  > GOMP_TASK_QUEUED_MAX * (unsigned long) team->nthreads))
+    {
+      struct gomp_task undeferred;
+
+      gomp_init_task (&undeferred, parent);
+      thr->ts.task = &undeferred;
+      if (cpyfn != NULL)
+	{
+	  char buf[arg_size + arg_align - 1];
+
+	  arg = (char *) (((uintptr_t) buf + arg_align - 1)
+			  & ~(uintptr_t) (arg_align - 1));
+	  cpyfn (arg, data);
+	  fn (arg);
+	}
+      else
+	fn (data);
+
+      /* Its deferred children point to this task, so it must outlive
+	 them.  */
+      gomp_task_wait (thr, &undeferred, &undeferred.refs, 1);
+      thr->ts.task = parent;
+      return;
+    }
+
+  task = gomp_malloc (sizeof (*task) + arg_size + arg_align - 1);
+  arg = (char *) (((uintptr_t) (task + 1) + arg_align - 1)
+		  & ~(uintptr_t) (arg_align - 1));
+  if (cpyfn != NULL)
+    cpyfn (arg, data);
+  else
+    memcpy (arg, data, arg_size);
+  gomp_init_task (task, parent);
+  task->fn = fn;
+  task->fn_data = arg;
+
+  task_add (&parent->refs, 1);
+  task_add (&parent->children, 1);
+  task_add (&team->task_count, 1);
+  task_add (&team->task_queued, 1);
+  gomp_task_push (&team->task_deques[thr->ts.team_id], task);
+
+  /* Let threads waiting at the team barrier help.  */
+  gomp_team_barrier_set_task_pending (&team->barrier);
+}
+
+/* Called when encountering a TASKWAIT construct.  Wait for the children
+   of the current task to finish.  */
+
+void
+GOMP_taskwait (void)
+{
+  struct gomp_thread *thr = gomp_thread ();
+  struct gomp_task *task = thr->ts.task;
+
+  if (task != NULL)
+    gomp_task_wait (thr, task, &task->children, 0);
+}
@@ -44,6 +44,50 @@ pthread_attr_t gomp_thread_attr;
 /* This barrier holds and releases threads waiting in gomp_threads.  */
 static gomp_barrier_t gomp_threads_dock;
 
+/* APPLE LOCAL begin libgomp work share recycling */
+/* This is the team of the last non-nested PARALLEL construct with more
+   than one thread, kept to be reused by the next one of the same size.
+   Its threads may still be leaving its barrier when the construct ends,
+   so it can only be freed or reused once they have all reached
+   gomp_threads_dock again.  */
+static struct gomp_team *gomp_last_team;
+/* APPLE LOCAL end libgomp work share recycling */
+
+/* APPLE LOCAL begin libgomp nested pool */
+/* Threads that have finished their part in a nested team wait here, each
+   on its pool_release semaphore, to be picked for the next one.  Unlike
+   gomp_threads, this is shared by every thread that starts a nested
+   team, so it has a lock.  */
+static struct gomp_thread **gomp_nested_pool;
+static unsigned gomp_nested_pool_size;
+static unsigned gomp_nested_pool_len;
+static gomp_mutex_t gomp_nested_pool_lock;
+/* APPLE LOCAL end libgomp nested pool */
+
+/* APPLE LOCAL begin libgomp spin wait */
+/* The number of threads libgomp has started and that have not yet
+   exited, plus the initial thread.  */
+unsigned long gomp_managed_threads = 1;
+
+#ifndef HAVE_SYNC_BUILTINS
+static gomp_mutex_t gomp_managed_threads_lock;
+#endif
+
+/* Add N, which may be negative, to gomp_managed_threads.  */
+
+static inline void
+gomp_managed_threads_add (long n)
+{
+#ifdef HAVE_SYNC_BUILTINS
+  __sync_fetch_and_add (&gomp_managed_threads, n);
+#else
+  gomp_mutex_lock (&gomp_managed_threads_lock);
+  gomp_managed_threads += n;
+  gomp_mutex_unlock (&gomp_managed_threads_lock);
+#endif
+}
+/* APPLE LOCAL end libgomp spin wait */
+
 /* This is the libgomp per-thread data structure.  */
 #ifdef HAVE_TLS
 __thread struct gomp_thread gomp_tls_data;
@@ -79,6 +123,8 @@ gomp_thread_start (void *xdata)
 #else
   struct gomp_thread local_thr;
   thr = &local_thr;
+  /* APPLE LOCAL libgomp tree reductions */
+  memset (thr, 0, sizeof (*thr));
   pthread_setspecific (gomp_tls_key, thr);
 #endif
   gomp_sem_init (&thr->release, 0);
@@ -92,34 +138,67 @@ gomp_thread_start (void *xdata)
 
   if (data->nested)
     {
-      gomp_barrier_wait (&thr->ts.team->barrier);
-      local_fn (local_data);
-      gomp_barrier_wait (&thr->ts.team->barrier);
+      /* APPLE LOCAL begin libgomp nested pool */
+      gomp_sem_init (&thr->pool_release, 0);
+      do
+	{
+	  gomp_barrier_wait (&thr->ts.team->barrier);
+	  local_fn (local_data);
+	  /* APPLE LOCAL libgomp tasks */
+	  gomp_team_barrier_wait (&thr->ts.team->barrier);
+
+	  /* The team is done with this thread once it has left the
+	     barrier, so it can join the pool.  Whoever picks it sets up
+	     its team state before posting pool_release.  */
+	  thr->fn = NULL;
+	  thr->data = NULL;
+	  gomp_mutex_lock (&gomp_nested_pool_lock);
+	  if (gomp_nested_pool_len == gomp_nested_pool_size)
+	    {
+	      gomp_nested_pool_size = 2 * gomp_nested_pool_size + 4;
+	      gomp_nested_pool
+		= gomp_realloc (gomp_nested_pool,
+				gomp_nested_pool_size
+				* sizeof (struct gomp_thread *));
+	    }
+	  gomp_nested_pool[gomp_nested_pool_len++] = thr;
+	  gomp_mutex_unlock (&gomp_nested_pool_lock);
+
+	  gomp_sem_wait (&thr->pool_release);
+	  local_fn = thr->fn;
+	  local_data = thr->data;
+	}
+      while (local_fn);
+      /* APPLE LOCAL end libgomp nested pool */
     }
   else
     {
       gomp_threads[thr->ts.team_id] = thr;
 
       gomp_barrier_wait (&gomp_threads_dock);
+      /* APPLE LOCAL libgomp tracing */
+      gomp_trace (GOMP_TRACE_DOCK_DEPART, 0, 0);
       do
 	{
-	  struct gomp_team *team;
-
 	  local_fn (local_data);
 
-	  /* Clear out the team and function data.  This is a debugging
-	     signal that we're in fact back in the dock.  */
-	  team = thr->ts.team;
+	  /* APPLE LOCAL begin libgomp tasks */
+	  /* Clear out the function data.  This is a debugging signal
+	     that we're in fact back in the dock, and tells the threads
+	     left out of the next team to exit.  */
 	  thr->fn = NULL;
 	  thr->data = NULL;
-	  thr->ts.team = NULL;
-	  thr->ts.work_share = NULL;
-	  thr->ts.team_id = 0;
-	  thr->ts.work_share_generation = 0;
-	  thr->ts.static_trip = 0;
 
-	  gomp_barrier_wait (&team->barrier);
+	  /* The team barrier runs the team's remaining tasks, so the team
+	     state is left alone.  The master replaces it before releasing
+	     the dock, possibly before this thread gets there.  */
+	  gomp_team_barrier_wait (&thr->ts.team->barrier);
+	  /* APPLE LOCAL end libgomp tasks */
+	  /* APPLE LOCAL libgomp tracing */
+	  gomp_trace (GOMP_TRACE_DOCK_ARRIVE, 0, 0);
 	  gomp_barrier_wait (&gomp_threads_dock);
+	  /* APPLE LOCAL libgomp tracing */
+	  gomp_trace (GOMP_TRACE_DOCK_DEPART, 0, 0);
 
 	  local_fn = thr->fn;
 	  local_data = thr->data;
@@ -127,6 +206,8 @@ gomp_thread_start (void *xdata)
       while (local_fn);
     }
 
+  /* APPLE LOCAL libgomp spin wait */
+  gomp_managed_threads_add (-1);
   return NULL;
 }
 
@@ -134,10 +215,29 @@ gomp_thread_start (void *xdata)
 /* Create a new team data structure.  */
 
 static struct gomp_team *
-new_team (unsigned nthreads, struct gomp_work_share *work_share)
+/* APPLE LOCAL libgomp work share recycling */
+new_team (unsigned nthreads, struct gomp_work_share *work_share, bool nested)
 {
   struct gomp_team *team;
   size_t size;
+  /* APPLE LOCAL libgomp work share recycling */
+  unsigned i;
+
+  /* APPLE LOCAL begin libgomp work share recycling */
+  /* The last team's barrier, task deques and spare work shares are all
+     still good for a team of the same size.  */
+  team = gomp_last_team;
+  if (!nested && team != NULL && team->nthreads == nthreads)
+    {
+      gomp_last_team = NULL;
+      team->oldest_live_gen = work_share == NULL;
+      team->num_live_gen = work_share != NULL;
+      team->work_shares[0] = work_share;
+      for (i = 0; i < nthreads; i++)
+	gomp_init_task (&team->implicit_tasks[i], NULL);
+      return team;
+    }
+  /* APPLE LOCAL end libgomp work share recycling */
 
   size = sizeof (*team) + nthreads * sizeof (team->ordered_release[0]);
   team = gomp_malloc (size);
@@ -148,13 +248,23 @@ new_team (unsigned nthreads, struct gomp_work_share *work_share)
   team->oldest_live_gen = work_share == NULL;
   team->num_live_gen = work_share != NULL;
   team->work_shares[0] = work_share;
+  /* APPLE LOCAL begin libgomp work share recycling */
+  team->work_share_list = NULL;
+  team->work_share_list_len = 0;
+  /* APPLE LOCAL end libgomp work share recycling */
 
   team->nthreads = nthreads;
-  gomp_barrier_init (&team->barrier, nthreads);
+  /* APPLE LOCAL libgomp tree barrier */
+  gomp_barrier_init_team (&team->barrier, nthreads);
 
   gomp_sem_init (&team->master_release, 0);
   team->ordered_release[0] = &team->master_release;
 
+  /* APPLE LOCAL libgomp tasks */
+  gomp_init_task_deques (team);
+  /* APPLE LOCAL libgomp tree reductions */
+  gomp_init_reductions (team);
+
   return team;
 }
 
@@ -165,9 +275,15 @@ static void
 free_team (struct gomp_team *team)
 {
   free (team->work_shares);
+  /* APPLE LOCAL libgomp work share recycling */
+  gomp_free_work_share_list (team);
   gomp_mutex_destroy (&team->work_share_lock);
   gomp_barrier_destroy (&team->barrier);
   gomp_sem_destroy (&team->master_release);
+  /* APPLE LOCAL libgomp tasks */
+  gomp_free_task_deques (team);
+  /* APPLE LOCAL libgomp tree reductions */
+  gomp_free_reductions (team);
   free (team);
 }
 
@@ -183,11 +299,19 @@ gomp_team_start (void (*fn) (void *), void *data, unsigned nthreads,
   struct gomp_team *team;
   bool nested;
   unsigned i, n, old_threads_used = 0;
+  /* APPLE LOCAL begin libgomp affinity */
+  pthread_attr_t thread_attr, *attr;
+  /* APPLE LOCAL end libgomp affinity */
 
   thr = gomp_thread ();
   nested = thr->ts.team != NULL;
 
-  team = new_team (nthreads, work_share);
+  /* APPLE LOCAL libgomp work share recycling */
+  team = new_team (nthreads, work_share, nested);
+  /* APPLE LOCAL begin libgomp tracing */
+  team->trace_region = gomp_trace_var ? gomp_trace_new_region () : 0;
+  gomp_trace (GOMP_TRACE_REGION_START, nthreads, team->trace_region);
+  /* APPLE LOCAL end libgomp tracing */
 
   /* Always save the previous state, even if this isn't a nested team.
      In particular, we should save any work share state from an outer
@@ -199,17 +323,23 @@ gomp_team_start (void (*fn) (void *), void *data, unsigned nthreads,
   thr->ts.team_id = 0;
   thr->ts.work_share_generation = 0;
   thr->ts.static_trip = 0;
+  /* APPLE LOCAL libgomp tasks */
+  thr->ts.task = &team->implicit_tasks[0];
 
   if (nthreads == 1)
     return;
 
   i = 1;
 
-  /* We only allow the reuse of idle threads for non-nested PARALLEL
-     regions.  This appears to be implied by the semantics of
-     threadprivate variables, but perhaps that's reading too much into
-     things.  Certainly it does prevent any locking problems, since
-     only the initial program thread will modify gomp_threads.  */
+  /* APPLE LOCAL begin libgomp nested pool */
+  /* A non-nested PARALLEL region reuses the idle threads docked in
+     gomp_threads.  Only the initial program thread modifies
+     gomp_threads, so that needs no locking.  A nested region instead
+     takes threads left over from earlier nested teams out of
+     gomp_nested_pool, under gomp_nested_pool_lock, since any thread
+     of an outer team may start one.  Either way, whatever threads the
+     region still lacks are created below.  */
+  /* APPLE LOCAL end libgomp nested pool */
   if (!nested)
     {
       old_threads_used = gomp_threads_used;
@@ -244,6 +374,8 @@ gomp_team_start (void (*fn) (void *), void *data, unsigned nthreads,
 	  nthr->ts.team_id = i;
 	  nthr->ts.work_share_generation = 0;
 	  nthr->ts.static_trip = 0;
+	  /* APPLE LOCAL libgomp tasks */
+	  nthr->ts.task = &team->implicit_tasks[i];
 	  nthr->fn = fn;
 	  nthr->data = data;
 	  team->ordered_release[i] = &nthr->release;
@@ -264,10 +396,58 @@ gomp_team_start (void (*fn) (void *), void *data, unsigned nthreads,
 			    * sizeof (struct gomp_thread_data *));
 	}
     }
+  /* APPLE LOCAL begin libgomp nested pool */
+  else
+    {
+      /* A nested team takes what threads it can from the pool, and
+	 only creates the rest.  */
+      gomp_mutex_lock (&gomp_nested_pool_lock);
+      for (; i < nthreads && gomp_nested_pool_len > 0; ++i)
+	{
+	  nthr = gomp_nested_pool[--gomp_nested_pool_len];
+	  nthr->ts.team = team;
+	  nthr->ts.work_share = work_share;
+	  nthr->ts.team_id = i;
+	  nthr->ts.work_share_generation = 0;
+	  nthr->ts.static_trip = 0;
+	  nthr->ts.task = &team->implicit_tasks[i];
+	  nthr->fn = fn;
+	  nthr->data = data;
+	  team->ordered_release[i] = &nthr->release;
+	  gomp_sem_post (&nthr->pool_release);
+	}
+      gomp_mutex_unlock (&gomp_nested_pool_lock);
+
+      if (i == nthreads)
+	goto do_release;
+    }
+  /* APPLE LOCAL end libgomp nested pool */
 
   start_data = gomp_alloca (sizeof (struct gomp_thread_start_data)
 			    * (nthreads-i));
 
+  /* APPLE LOCAL begin libgomp spin wait */
+  /* Count the new threads before they start, so that they see the
+     right number when deciding how long to spin.  */
+  gomp_managed_threads_add (nthreads - i);
+  /* APPLE LOCAL end libgomp spin wait */
+
+  /* APPLE LOCAL begin libgomp affinity */
+  /* Each thread is bound to its CPU before it starts, so that its stack
+     and anything else it touches first are allocated near that CPU.  */
+  attr = &gomp_thread_attr;
+  if (gomp_cpu_affinity != NULL)
+    {
+      size_t stacksize;
+
+      pthread_attr_init (&thread_attr);
+      pthread_attr_setdetachstate (&thread_attr, PTHREAD_CREATE_DETACHED);
+      if (!pthread_attr_getstacksize (&gomp_thread_attr, &stacksize))
+	pthread_attr_setstacksize (&thread_attr, stacksize);
+      attr = &thread_attr;
+    }
+  /* APPLE LOCAL end libgomp affinity */
+
   /* Launch new threads.  */
   for (; i < nthreads; ++i, ++start_data)
     {
@@ -279,16 +459,27 @@ gomp_team_start (void (*fn) (void *), void *data, unsigned nthreads,
       start_data->ts.team_id = i;
       start_data->ts.work_share_generation = 0;
       start_data->ts.static_trip = 0;
+      /* APPLE LOCAL libgomp tasks */
+      start_data->ts.task = &team->implicit_tasks[i];
       start_data->fn = fn;
       start_data->fn_data = data;
       start_data->nested = nested;
 
-      err = pthread_create (&pt, &gomp_thread_attr,
-			    gomp_thread_start, start_data);
+      /* APPLE LOCAL begin libgomp affinity */
+      if (gomp_cpu_affinity != NULL)
+	gomp_init_thread_affinity (attr, nested ? -1U : i);
+
+      err = pthread_create (&pt, attr, gomp_thread_start, start_data);
+      /* APPLE LOCAL end libgomp affinity */
       if (err != 0)
 	gomp_fatal ("Thread creation failed: %s", strerror (err));
     }
 
+  /* APPLE LOCAL begin libgomp affinity */
+  if (attr == &thread_attr)
+    pthread_attr_destroy (&thread_attr);
+  /* APPLE LOCAL end libgomp affinity */
+
  do_release:
   gomp_barrier_wait (nested ? &team->barrier : &gomp_threads_dock);
 
@@ -310,11 +501,27 @@ gomp_team_end (void)
   struct gomp_thread *thr = gomp_thread ();
   struct gomp_team *team = thr->ts.team;
 
-  gomp_barrier_wait (&team->barrier);
+  /* APPLE LOCAL libgomp tasks */
+  gomp_team_barrier_wait (&team->barrier);
+  /* APPLE LOCAL libgomp tracing */
+  gomp_trace (GOMP_TRACE_REGION_END, team->nthreads, team->trace_region);
 
   thr->ts = team->prev_ts;
 
-  free_team (team);
+  /* APPLE LOCAL begin libgomp work share recycling */
+  /* Keep a non-nested team for the next PARALLEL construct.  The threads
+     of the team kept before have all been through gomp_threads_dock
+     since it ended, so it can go now.  A team of one has no other
+     threads to wait for, and isn't worth displacing it for.  */
+  if (thr->ts.team != NULL || team->nthreads == 1)
+    free_team (team);
+  else
+    {
+      if (gomp_last_team != NULL)
+	free_team (gomp_last_team);
+      gomp_last_team = team;
+    }
+  /* APPLE LOCAL end libgomp work share recycling */
 }
 
 
@@ -338,4 +545,11 @@ initialize_team (void)
   thr = &initial_thread_tls_data;
 #endif
   gomp_sem_init (&thr->release, 0);
+  /* APPLE LOCAL begin libgomp spin wait */
+#ifndef HAVE_SYNC_BUILTINS
+  gomp_mutex_init (&gomp_managed_threads_lock);
+#endif
+  /* APPLE LOCAL end libgomp spin wait */
+  /* APPLE LOCAL libgomp nested pool */
+  gomp_mutex_init (&gomp_nested_pool_lock);
 }
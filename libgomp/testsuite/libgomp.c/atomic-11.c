@@ -0,0 +1,39 @@
+/* APPLE LOCAL file libgomp striped atomic locks */
+/* Check atomic updates that need a lock: a histogram of long double
+   bins, whose updates are spread over several locks, next to updates of
+   a single shared variable.  */
+
+/* { dg-do run } */
+/* { dg-options "-O2 -fopenmp" } */
+
+#include <omp.h>
+#include <stdlib.h>
+
+#define NBINS 37
+#define N 20000
+
+long double bins[NBINS];
+long double total;
+
+int
+main (void)
+{
+  long double sum = 0;
+  int i;
+
+  omp_set_dynamic (0);
+#pragma omp parallel for num_threads (4)
+  for (i = 0; i < N; i++)
+    {
+#pragma omp atomic
+      bins[(i * 7) % NBINS] += 0.5L;
+#pragma omp atomic
+      total += 1;
+    }
+
+  for (i = 0; i < NBINS; i++)
+    sum += bins[i];
+  if (sum != N / 2 || total != N)
+    abort ();
+  return 0;
+}
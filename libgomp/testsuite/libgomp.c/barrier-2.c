@@ -0,0 +1,58 @@
+/* APPLE LOCAL file libgomp tree barrier */
+/* Check barriers in teams large enough to use a tree barrier.  Each
+   thread bumps a counter of its own before every barrier, and after it
+   checks that every other thread has bumped its counter too.  */
+
+/* { dg-do run } */
+/* { dg-options "-O2 -fopenmp" } */
+
+#include <omp.h>
+#include <stdlib.h>
+
+#define ROUNDS 200
+#define MAX_THREADS 64
+
+static volatile int counts[MAX_THREADS];
+
+static void
+check_barriers (int nthreads)
+{
+  int i, bad = 0;
+
+  for (i = 0; i < MAX_THREADS; i++)
+    counts[i] = 0;
+
+  #pragma omp parallel num_threads (nthreads) private (i)
+    {
+      int me = omp_get_thread_num (), n = omp_get_num_threads (), j;
+
+      for (i = 0; i < ROUNDS; i++)
+	{
+	  counts[me] = i + 1;
+	  #pragma omp barrier
+	  for (j = 0; j < n; j++)
+	    if (counts[j] != i + 1)
+	      bad = 1;
+	  /* Nobody may start the next round before everyone has checked
+	     this one.  */
+	  #pragma omp barrier
+	}
+    }
+
+  if (bad)
+    abort ();
+}
+
+int
+main (void)
+{
+  int n;
+
+  /* Go past the size at which teams switch to a tree barrier, through
+     sizes that leave the tree's nodes partly filled.  */
+  omp_set_dynamic (0);
+  for (n = 1; n <= MAX_THREADS; n = n < 8 ? n + 1 : n * 2 - 3)
+    check_barriers (n);
+
+  return 0;
+}
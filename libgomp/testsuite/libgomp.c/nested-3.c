@@ -0,0 +1,49 @@
+/* APPLE LOCAL file libgomp nested pool */
+/* Check nested teams of varying sizes run one after another, so that
+   they are made up of threads used by the nested teams before.  */
+
+/* { dg-do run } */
+/* { dg-options "-O2 -fopenmp" } */
+
+#include <omp.h>
+#include <stdlib.h>
+
+int
+main (void)
+{
+  int round;
+
+  omp_set_nested (1);
+  omp_set_dynamic (0);
+  for (round = 0; round < 50; round++)
+#pragma omp parallel num_threads (3)
+    {
+      int n = 1 + (round + omp_get_thread_num ()) % 4, i, last = -1;
+      int seen = 0, sum = 0;
+
+#pragma omp parallel num_threads (n) reduction (+:seen)
+      {
+	if (omp_get_num_threads () != n)
+	  abort ();
+	seen = 1 << omp_get_thread_num ();
+      }
+      if (seen != (1 << n) - 1)
+	abort ();
+
+#pragma omp parallel for num_threads (n) ordered schedule (dynamic) \
+		     reduction (+:sum)
+      for (i = 0; i < 20; i++)
+	{
+	  sum += i;
+#pragma omp ordered
+	  {
+	    if (last != i - 1)
+	      abort ();
+	    last = i;
+	  }
+	}
+      if (sum != 190 || last != 19)
+	abort ();
+    }
+  return 0;
+}
@@ -0,0 +1,59 @@
+/* APPLE LOCAL file libgomp work share recycling */
+/* Check back-to-back nowait loops, which keep many work shares live at
+   once, followed by ordered loops reusing them, in teams of changing
+   sizes.  */
+
+/* { dg-do run } */
+/* { dg-options "-O2 -fopenmp" } */
+
+#include <omp.h>
+#include <stdlib.h>
+
+#define N 100
+
+int
+main (void)
+{
+  int sizes[] = { 4, 4, 1, 4, 3, 3, 8, 2, 4 };
+  int i, j, k, r, last, bad = 0;
+  long sum = 0;
+
+  omp_set_dynamic (0);
+  for (r = 0; r < sizeof (sizes) / sizeof (sizes[0]); r++)
+    {
+      #pragma omp parallel num_threads (sizes[r]) private (j, k) \
+		 reduction (+:sum, bad)
+	{
+	  for (j = 0; j < 50; j++)
+	    {
+	      for (k = 0; k < 5; k++)
+		{
+		  #pragma omp for schedule (dynamic, 3) nowait
+		    for (i = 0; i < N; i++)
+		      sum += i;
+		}
+
+	      if (j % 10 == 0)
+		{
+		  #pragma omp single
+		    last = -1;
+		  #pragma omp for ordered schedule (static, 2)
+		    for (i = 0; i < N; i++)
+		      {
+			#pragma omp ordered
+			  {
+			    if (last != i - 1)
+			      bad++;
+			    last = i;
+			  }
+		      }
+		}
+	    }
+	}
+    }
+
+  if (bad || sum != 9L * 50 * 5 * (N * (N - 1) / 2))
+    abort ();
+
+  return 0;
+}
@@ -0,0 +1,52 @@
+/* APPLE LOCAL file libgomp tree reductions */
+/* Check reductions combined in a tree by the runtime: several
+   variables at once, and types that cannot be updated atomically,
+   over a range of team sizes.  */
+
+/* { dg-do run } */
+/* { dg-options "-O2 -fopenmp" } */
+
+#include <omp.h>
+#include <stdlib.h>
+
+int
+main (void)
+{
+  int i, n;
+
+  omp_set_dynamic (0);
+  for (n = 1; n <= 19; n++)
+    {
+      int s = 0, p = 1, b = 0, nthreads = n;
+      long double ld = 0;
+      _Complex double cd = 0;
+
+#pragma omp parallel for num_threads (n) reduction (+:s, ld) \
+		     reduction (-:cd) reduction (*:p) reduction (|:b)
+      for (i = 0; i < 1000; i++)
+	{
+	  s += i;
+	  ld += i / 4.0L;
+	  cd -= 1.0 + i * 1.0i;
+	  if (i % 100 == 0)
+	    p *= 2;
+	  b |= 1 << (i % 20);
+	}
+
+      if (s != 499500 || ld != 124875.0L || p != 1024 || b != 0xfffff)
+	abort ();
+      if (__real__ cd != -1000.0 || __imag__ cd != -499500.0)
+	abort ();
+
+#pragma omp parallel num_threads (n) reduction (+:ld) reduction (&&:s)
+      {
+	ld += omp_get_thread_num ();
+	s = s && omp_get_num_threads () == nthreads;
+      }
+
+      if (ld != 124875.0L + (n - 1) * n / 2 || !s)
+	abort ();
+    }
+
+  return 0;
+}
@@ -0,0 +1,70 @@
+/* APPLE LOCAL file libgomp tasks */
+/* Check explicit tasks: a recursive Fibonacci, a single thread that
+   spawns a task per array element, and tasks run undeferred by if (0).  */
+
+/* { dg-do run } */
+/* { dg-options "-O2 -fopenmp" } */
+
+#include <omp.h>
+#include <stdlib.h>
+
+#define N 1000
+
+static int
+fib (int n)
+{
+  int a, b;
+
+  if (n < 2)
+    return n;
+
+  #pragma omp task shared (a) if (n > 10)
+    a = fib (n - 1);
+  #pragma omp task shared (b) if (n > 10)
+    b = fib (n - 2);
+  #pragma omp taskwait
+
+  return a + b;
+}
+
+int
+main (void)
+{
+  int a[N], i, r = 0, seen = 0;
+
+  #pragma omp parallel
+    #pragma omp single
+      r = fib (25);
+
+  if (r != 75025)
+    abort ();
+
+  for (i = 0; i < N; i++)
+    a[i] = 0;
+
+  #pragma omp parallel private (i)
+    {
+      #pragma omp single
+	for (i = 0; i < N; i++)
+	  #pragma omp task firstprivate (i)
+	    a[i] = i + 1;
+      /* The barrier at the end of the single waits for the tasks.  */
+      #pragma omp atomic
+	seen += 1;
+    }
+
+  for (i = 0; i < N; i++)
+    if (a[i] != i + 1)
+      abort ();
+
+  #pragma omp parallel
+    {
+      int x = omp_get_thread_num ();
+
+      #pragma omp task if (0) firstprivate (x)
+	if (x != omp_get_thread_num ())
+	  abort ();
+    }
+
+  return seen == 0;
+}
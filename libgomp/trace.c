@@ -0,0 +1,185 @@
+/* APPLE LOCAL file libgomp tracing */
+/* Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This file is part of the GNU OpenMP Library (libgomp).
+
+   Libgomp is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation; either version 2.1 of the License, or
+   (at your option) any later version.
+
+   Libgomp is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+   FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+   more details.
+
+   You should have received a copy of the GNU Lesser General Public License 
+   along with libgomp; see the file COPYING.LIB.  If not, write to the
+   Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA.  */
+
+/* As a special exception, if you link this library with other files, some
+   of which are compiled with GCC, to produce an executable, this library
+   does not by itself cause the resulting executable to be covered by the
+   GNU General Public License.  This exception does not however invalidate
+   any other reasons why the executable file might be covered by the GNU
+   General Public License.  */
+
+/* This file records runtime events for GOMP_TRACE.  Each thread keeps
+   its latest events in a ring buffer of its own, so recording one takes
+   no lock, and the buffers are written out as text at exit.
+   contrib/gomp_trace_summary sums them up.  */
+
+#include "libgomp.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+
+struct gomp_trace_event
+{
+  unsigned long long time;
+  long a, b;
+  enum gomp_trace_kind kind;
+};
+
+struct gomp_trace_buffer
+{
+  /* The next buffer in trace_buffers.  */
+  struct gomp_trace_buffer *next;
+  /* The number of the thread in the trace.  */
+  unsigned thread;
+  /* How many events have been recorded, counting those overwritten
+     since.  */
+  unsigned long long count;
+  struct gomp_trace_event events[];
+};
+
+static const char *const trace_kind_names[] =
+{
+  "region_start", "region_end", "barrier_arrive", "barrier_depart",
+  "dock_arrive", "dock_depart", "chunk", "lock_wait"
+};
+
+/* All the buffers, and the number of them.  Their lock is not a
+   gomp_mutex_t, as waiting for one of those is itself recorded.  */
+static struct gomp_trace_buffer *trace_buffers;
+static unsigned trace_threads;
+static pthread_mutex_t trace_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static double trace_start;
+
+/* The number of parallel regions started so far.  */
+static unsigned long trace_regions;
+
+
+/* Return the number of nanoseconds since tracing started.  */
+
+unsigned long long
+gomp_trace_time (void)
+{
+  return (omp_get_wtime () - trace_start) * 1e9;
+}
+
+/* Return a number for a new parallel region, for its events to carry.
+   Teams of nested regions may start at the same time, so this is
+   atomic.  */
+
+unsigned long
+gomp_trace_new_region (void)
+{
+  return __sync_add_and_fetch (&trace_regions, 1);
+}
+
+static struct gomp_trace_buffer *
+new_trace_buffer (void)
+{
+  struct gomp_trace_buffer *buf;
+
+  buf = gomp_malloc (sizeof (*buf)
+		     + gomp_trace_size * sizeof (struct gomp_trace_event));
+  buf->count = 0;
+
+  pthread_mutex_lock (&trace_lock);
+  buf->thread = trace_threads++;
+  buf->next = trace_buffers;
+  trace_buffers = buf;
+  pthread_mutex_unlock (&trace_lock);
+
+  return buf;
+}
+
+/* Record an event of KIND with arguments A and B for the current
+   thread, overwriting its oldest event if its buffer is full.  */
+
+void
+gomp_trace_record (enum gomp_trace_kind kind, long a, long b)
+{
+  struct gomp_thread *thr = gomp_thread ();
+  struct gomp_trace_buffer *buf = thr->trace;
+  struct gomp_trace_event *ev;
+
+  if (buf == NULL)
+    buf = thr->trace = new_trace_buffer ();
+
+  ev = &buf->events[buf->count++ % gomp_trace_size];
+  ev->time = gomp_trace_time ();
+  ev->kind = kind;
+  ev->a = a;
+  ev->b = b;
+}
+
+/* Write the events of every thread to gomp_trace_file, one per line,
+   oldest first.  Threads may still be waiting in the dock, but none are
+   recording events by now.  */
+
+static void
+write_trace (void)
+{
+  struct gomp_trace_buffer *buf;
+  unsigned long long i;
+  FILE *f;
+
+  gomp_trace_var = false;
+
+  f = fopen (gomp_trace_file, "w");
+  if (f == NULL)
+    {
+      gomp_error ("Cannot open trace file %s", gomp_trace_file);
+      return;
+    }
+
+  fprintf (f, "# libgomp trace of process %ld, %u threads\n",
+	   (long) getpid (), trace_threads);
+  fprintf (f, "# thread time-ns event a b\n");
+  for (buf = trace_buffers; buf != NULL; buf = buf->next)
+    {
+      i = 0;
+      if (buf->count > gomp_trace_size)
+	{
+	  i = buf->count - gomp_trace_size;
+	  fprintf (f, "# thread %u lost %llu events\n", buf->thread, i);
+	}
+      for (; i < buf->count; i++)
+	{
+	  struct gomp_trace_event *ev = &buf->events[i % gomp_trace_size];
+
+	  fprintf (f, "%u %llu %s %ld %ld\n", buf->thread, ev->time,
+		   trace_kind_names[ev->kind], ev->a, ev->b);
+	}
+    }
+
+  if (fclose (f) != 0)
+    gomp_error ("Cannot write trace file %s", gomp_trace_file);
+}
+
+/* Start tracing, for gomp_trace_file.  */
+
+void
+gomp_init_trace (void)
+{
+  trace_start = omp_get_wtime ();
+  if (atexit (write_trace) != 0)
+    return;
+  gomp_trace_var = true;
+}
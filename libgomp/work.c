@@ -33,21 +33,46 @@
 #include <string.h>
 
 
-/* Create a new work share structure.  */
+/* APPLE LOCAL begin libgomp work share recycling */
+/* Reset WS for a new construct of a team of NTHREADS threads.  */
+
+static void
+init_work_share (struct gomp_work_share *ws, bool ordered, unsigned nthreads)
+{
+  ws->sched = 0;
+  ws->chunk_size = 0;
+  ws->end = 0;
+  ws->incr = 0;
+  ws->mode = 0;
+  ws->next = 0;
+  ws->threads_completed = 0;
+  ws->ordered_cur = 0;
+  ws->ordered_num_used = 0;
+  ws->ordered_owner = -1;
+  if (ordered)
+    memset (ws->ordered_team_ids, 0,
+	    nthreads * sizeof (ws->ordered_team_ids[0]));
+}
+
+/* Create a new work share structure.  There is always room for the
+   ordered queue, so that the structure can be reused for any later
+   construct of the team.  */
 
 struct gomp_work_share *
 gomp_new_work_share (bool ordered, unsigned nthreads)
 {
   struct gomp_work_share *ws;
   size_t size;
-
-  size = sizeof (*ws);
-  if (ordered)
-    size += nthreads * sizeof (ws->ordered_team_ids[0]);
-
-  ws = gomp_malloc_cleared (size);
+  void *alloc;
+
+  size = sizeof (*ws) + nthreads * sizeof (ws->ordered_team_ids[0]);
+  alloc = gomp_malloc (size + GOMP_CACHE_LINE - 1);
+  ws = (struct gomp_work_share *) (((uintptr_t) alloc + GOMP_CACHE_LINE - 1)
+				   & -(uintptr_t) GOMP_CACHE_LINE);
+  ws->alloc = alloc;
+  ws->next_free = NULL;
   gomp_mutex_init (&ws->lock);
-  ws->ordered_owner = -1;
+  init_work_share (ws, ordered, nthreads);
 
   return ws;
 }
@@ -59,8 +84,64 @@ static void
 free_work_share (struct gomp_work_share *ws)
 {
   gomp_mutex_destroy (&ws->lock);
-  free (ws);
+  free (ws->alloc);
+}
+
+
+/* Return a work share for the next construct of TEAM, reusing a spare
+   one if there is one.  The caller holds the work_share_lock.  */
+
+static struct gomp_work_share *
+alloc_work_share (struct gomp_team *team, bool ordered)
+{
+  struct gomp_work_share *ws = team->work_share_list;
+
+  if (ws == NULL)
+    return gomp_new_work_share (ordered, team->nthreads);
+
+  team->work_share_list = ws->next_free;
+  team->work_share_list_len--;
+  init_work_share (ws, ordered, team->nthreads);
+  return ws;
+}
+
+
+/* Give WS back to TEAM once every thread is done with it.  The team keeps
+   no more spare work shares than it has had live at once.  The caller
+   holds the work_share_lock, or knows that no other thread of the team
+   can be looking for a work share.  */
+
+static void
+release_work_share (struct gomp_team *team, struct gomp_work_share *ws)
+{
+  if (team->work_share_list_len > team->generation_mask)
+    {
+      free_work_share (ws);
+      return;
+    }
+
+  ws->next_free = team->work_share_list;
+  team->work_share_list = ws;
+  team->work_share_list_len++;
+}
+
+
+/* Free the spare work shares of TEAM.  */
+
+void
+gomp_free_work_share_list (struct gomp_team *team)
+{
+  struct gomp_work_share *ws, *next;
+
+  for (ws = team->work_share_list; ws != NULL; ws = next)
+    {
+      next = ws->next_free;
+      free_work_share (ws);
+    }
+  team->work_share_list = NULL;
+  team->work_share_list_len = 0;
 }
+/* APPLE LOCAL end libgomp work share recycling */
 
 
 /* The current thread is ready to begin the next work sharing construct.
@@ -109,25 +190,28 @@ gomp_work_share_start (bool ordered)
   /* Resize the work shares queue if we've run out of space.  */
   if (team->num_live_gen++ == team->generation_mask)
     {
-      team->work_shares = gomp_realloc (team->work_shares,
-					2 * team->num_live_gen
-					* sizeof (*team->work_shares));
-
-      /* Unless oldest_live_gen is zero, the sequence of live elements
-	 wraps around the end of the array.  If we do nothing, we break
-	 lookup of the existing elements.  Fix that by unwrapping the
-	 data from the front to the end.  */
-      if (team->oldest_live_gen > 0)
-	memcpy (team->work_shares + team->num_live_gen,
-		team->work_shares,
-		(team->oldest_live_gen & team->generation_mask)
-		* sizeof (*team->work_shares));
-
-      team->generation_mask = team->generation_mask * 2 + 1;
+      /* APPLE LOCAL begin libgomp work share recycling */
+      struct gomp_work_share **old_shares = team->work_shares;
+      unsigned old_mask = team->generation_mask, gen;
+
+      team->generation_mask = old_mask * 2 + 1;
+      team->work_shares = gomp_malloc ((team->generation_mask + 1)
+				       * sizeof (*team->work_shares));
+
+      /* Each live element moves to the slot its generation indexes with
+	 the wider mask.  Merely unwrapping the front of the array to its
+	 end would only be right if the generations that wrapped all
+	 had the new mask bit set.  */
+      for (gen = team->oldest_live_gen; gen != ws_gen; gen++)
+	team->work_shares[gen & team->generation_mask]
+	  = old_shares[gen & old_mask];
+      free (old_shares);
+      /* APPLE LOCAL end libgomp work share recycling */
     }
 
   ws_index = ws_gen & team->generation_mask;
-  ws = gomp_new_work_share (ordered, team->nthreads);
+  /* APPLE LOCAL libgomp work share recycling */
+  ws = alloc_work_share (team, ordered);
   thr->ts.work_share = ws;
   thr->ts.static_trip = 0;
   team->work_shares[ws_index] = ws;
@@ -159,7 +243,8 @@ gomp_work_share_end (void)
       return;
     }
 
-  last = gomp_barrier_wait_start (&team->barrier);
+  /* APPLE LOCAL libgomp tasks */
+  last = gomp_team_barrier_wait_start (&team->barrier);
 
   if (last)
     {
@@ -170,10 +255,12 @@ gomp_work_share_end (void)
       team->oldest_live_gen++;
       team->num_live_gen = 0;
 
-      free_work_share (ws);
+      /* APPLE LOCAL libgomp work share recycling */
+      release_work_share (team, ws);
     }
 
-  gomp_barrier_wait_end (&team->barrier, last);
+  /* APPLE LOCAL libgomp tasks */
+  gomp_team_barrier_wait_end (&team->barrier, last);
 }
 
 
@@ -216,8 +303,10 @@ gomp_work_share_end_nowait (void)
       team->oldest_live_gen++;
       team->num_live_gen--;
 
-      gomp_mutex_unlock (&team->work_share_lock);
+      /* APPLE LOCAL begin libgomp work share recycling */
+      release_work_share (team, ws);
 
-      free_work_share (ws);
+      gomp_mutex_unlock (&team->work_share_lock);
+      /* APPLE LOCAL end libgomp work share recycling */
     }
 }
@@ -32,6 +32,14 @@ Boston, MA 02110-1301, USA.  */
    expanded by creation of new hash table and transferring elements from
    the old table to the new table. */
 
+/* APPLE LOCAL begin htab cached hashes */
+/* A table can also keep the hash of each entry in a second array, next
+   to the entries themselves; see htab_cache_hashes.  Such a table is a
+   power of two in size and is probed linearly from a multiplicatively
+   mixed hash.  A probe then compares the cached hash before calling
+   eq_f, and expanding the table never calls hash_f.  */
+/* APPLE LOCAL end htab cached hashes */
+
 #ifdef HAVE_CONFIG_H
 #include "config.h"
 #endif
@@ -72,6 +80,16 @@ static hashval_t hash_pointer (const void *);
 static int eq_pointer (const void *, const void *);
 static int htab_expand (htab_t);
 static PTR *find_empty_slot_for_expand (htab_t, hashval_t);
+/* APPLE LOCAL begin htab cached hashes */
+static PTR htab_alloc_array (htab_t, size_t, size_t);
+static void htab_free_array (htab_t, PTR);
+static unsigned int htab_ceil_log2 (size_t);
+static int htab_resize_cached (htab_t, unsigned int, int);
+static int htab_expand_cached (htab_t);
+static PTR htab_find_cached (htab_t, const PTR, hashval_t);
+static PTR *htab_find_slot_cached (htab_t, const PTR, hashval_t,
+				   enum insert_option);
+/* APPLE LOCAL end htab cached hashes */
 
 /* At some point, we could make these be NULL, and modify the
    hash-table routines to handle NULL specially; that would avoid
@@ -395,6 +413,11 @@ htab_delete (htab_t htab)
       if (entries[i] != HTAB_EMPTY_ENTRY && entries[i] != HTAB_DELETED_ENTRY)
 	(*htab->del_f) (entries[i]);
 
+  /* APPLE LOCAL begin htab cached hashes */
+  if (htab->hashes)
+    htab_free_array (htab, htab->hashes);
+  /* APPLE LOCAL end htab cached hashes */
+
   if (htab->free_f != NULL)
     {
       (*htab->free_f) (entries);
@@ -421,6 +444,32 @@ htab_empty (htab_t htab)
       if (entries[i] != HTAB_EMPTY_ENTRY && entries[i] != HTAB_DELETED_ENTRY)
 	(*htab->del_f) (entries[i]);
 
+  /* APPLE LOCAL begin htab cached hashes */
+  if (htab->hashes)
+    {
+      /* Likewise, but keep to a power of two.  */
+      if (size > 1024*1024 / sizeof (PTR))
+	{
+	  unsigned int log2 = htab_ceil_log2 (1024 / sizeof (PTR));
+
+	  htab_free_array (htab, htab->entries);
+	  htab_free_array (htab, htab->hashes);
+	  htab->entries = (PTR *) htab_alloc_array (htab, (size_t) 1 << log2,
+						    sizeof (PTR));
+	  htab->hashes = (hashval_t *) htab_alloc_array (htab,
+							 (size_t) 1 << log2,
+							 sizeof (hashval_t));
+	  htab->size = (size_t) 1 << log2;
+	  htab->size_log2 = log2;
+	}
+      else
+	memset (entries, 0, size * sizeof (PTR));
+      htab->n_deleted = 0;
+      htab->n_elements = 0;
+      return;
+    }
+  /* APPLE LOCAL end htab cached hashes */
+
   /* Instead of clearing megabyte, downsize the table.  */
   if (size > 1024*1024 / sizeof (PTR))
     {
@@ -498,6 +547,11 @@ htab_expand (htab_t htab)
   size_t nsize, osize, elts;
   unsigned int oindex, nindex;
 
+  /* APPLE LOCAL begin htab cached hashes */
+  if (htab->hashes)
+    return htab_expand_cached (htab);
+  /* APPLE LOCAL end htab cached hashes */
+
   oentries = htab->entries;
   oindex = htab->size_prime_index;
   osize = htab->size;
@@ -553,6 +607,361 @@ htab_expand (htab_t htab)
   return 1;
 }
 
+/* APPLE LOCAL begin relocatable PCH */
+/* Put every element of HTAB back where its hash, computed afresh, says
+   it belongs, and drop the deleted entries.  This is for when the
+   hashes have changed, as those of pointers do when the elements are
+   moved together with the table.  A table that doesn't cache hashes
+   keeps its array of entries, which may not have been allocated by its
+   alloc_f.  Return zero if memory allocation fails, leaving HTAB as it
+   was.  */
+
+int
+htab_rehash (htab_t htab)
+{
+  PTR *entries = htab->entries;
+  size_t size = htab_size (htab);
+  size_t elts = htab_elements (htab);
+  PTR *live;
+  size_t i, n;
+
+  if (htab->hashes)
+    return htab_resize_cached (htab, htab->size_log2, 1);
+
+  live = (PTR *) malloc (elts * sizeof (PTR) + 1);
+  if (live == NULL)
+    return 0;
+
+  for (i = n = 0; i < size; i++)
+    if (entries[i] != HTAB_EMPTY_ENTRY && entries[i] != HTAB_DELETED_ENTRY)
+      live[n++] = entries[i];
+
+  memset (entries, 0, size * sizeof (PTR));
+  htab->n_elements = n;
+  htab->n_deleted = 0;
+  for (i = 0; i < n; i++)
+    *find_empty_slot_for_expand (htab, (*htab->hash_f) (live[i])) = live[i];
+
+  free (live);
+  return 1;
+}
+/* APPLE LOCAL end relocatable PCH */
+
+/* APPLE LOCAL begin htab cached hashes */
+/* Allocate and free an array of N elements of SIZE bytes the way HTAB
+   allocates and frees its entries.  */
+
+static PTR
+htab_alloc_array (htab_t htab, size_t n, size_t size)
+{
+  if (htab->alloc_with_arg_f != NULL)
+    return (*htab->alloc_with_arg_f) (htab->alloc_arg, n, size);
+  return (*htab->alloc_f) (n, size);
+}
+
+static void
+htab_free_array (htab_t htab, PTR p)
+{
+  if (htab->free_f != NULL)
+    (*htab->free_f) (p);
+  else if (htab->free_with_arg_f != NULL)
+    (*htab->free_with_arg_f) (htab->alloc_arg, p);
+}
+
+/* The smallest table with cached hashes has 1 << HTAB_MIN_LOG2 slots.  */
+
+#define HTAB_MIN_LOG2 3
+
+/* Return the log2 of the smallest power of two that is at least N, and
+   at least 1 << HTAB_MIN_LOG2.  */
+
+static unsigned int
+htab_ceil_log2 (size_t n)
+{
+  unsigned int log2 = HTAB_MIN_LOG2;
+
+  while (((size_t) 1 << log2) < n)
+    if (++log2 >= sizeof (hashval_t) * CHAR_BIT)
+      {
+	fprintf (stderr, "Cannot make a hash table of %lu entries\n",
+		 (unsigned long) n);
+	abort ();
+      }
+  return log2;
+}
+
+/* Return the first slot to probe for HASH in HTAB, which caches
+   hashes.  Fibonacci hashing takes the top bits of the product, so
+   that every bit of HASH counts even when its low bits are poor, as
+   with pointers.  */
+
+static inline hashval_t
+htab_index_cached (hashval_t hash, htab_t htab)
+{
+  return ((hashval_t) (hash * (hashval_t) 0x9e3779b9U)
+	  >> (sizeof (hashval_t) * CHAR_BIT - htab->size_log2));
+}
+
+/* Move the entries of HTAB to new arrays of 1 << LOG2 slots, and
+   start caching hashes if it didn't.  Rehash every entry if REHASH,
+   otherwise use the cached hashes.  Return zero if memory allocation
+   fails, leaving HTAB as it was.  */
+
+static int
+htab_resize_cached (htab_t htab, unsigned int log2, int rehash)
+{
+  PTR *oentries = htab->entries;
+  hashval_t *ohashes = htab->hashes;
+  size_t osize = htab->size;
+  size_t nsize = (size_t) 1 << log2;
+  size_t mask = nsize - 1;
+  PTR *nentries;
+  hashval_t *nhashes;
+  size_t i;
+
+  nentries = (PTR *) htab_alloc_array (htab, nsize, sizeof (PTR));
+  if (nentries == NULL)
+    return 0;
+  nhashes = (hashval_t *) htab_alloc_array (htab, nsize, sizeof (hashval_t));
+  if (nhashes == NULL)
+    {
+      htab_free_array (htab, nentries);
+      return 0;
+    }
+
+  htab->entries = nentries;
+  htab->hashes = nhashes;
+  htab->size = nsize;
+  htab->size_log2 = log2;
+  htab->n_elements -= htab->n_deleted;
+  htab->n_deleted = 0;
+
+  for (i = 0; i < osize; i++)
+    {
+      PTR x = oentries[i];
+      hashval_t hash, index;
+
+      if (x == HTAB_EMPTY_ENTRY || x == HTAB_DELETED_ENTRY)
+	continue;
+      hash = rehash ? (*htab->hash_f) (x) : ohashes[i];
+      index = htab_index_cached (hash, htab);
+      while (nentries[index] != HTAB_EMPTY_ENTRY)
+	index = (index + 1) & mask;
+      nentries[index] = x;
+      nhashes[index] = hash;
+    }
+
+  htab_free_array (htab, oentries);
+  if (ohashes)
+    htab_free_array (htab, ohashes);
+  return 1;
+}
+
+/* Like htab_expand, for a table that caches hashes.  */
+
+static int
+htab_expand_cached (htab_t htab)
+{
+  size_t elts = htab_elements (htab);
+  size_t osize = htab_size (htab);
+  unsigned int log2 = htab->size_log2;
+
+  if (elts * 2 > osize || (elts * 8 < osize && osize > 32))
+    log2 = htab_ceil_log2 (elts * 2);
+  return htab_resize_cached (htab, log2, 0);
+}
+
+/* Make HTAB keep the hash of each entry next to it, with a table a
+   power of two in size, without changing how it is used.  It pays
+   when eq_f or hash_f are costly, or when most probes miss.
+
+   The hashes are not visible to the garbage collector, so this is
+   only for tables that are not allocated in its memory.  Return zero
+   if memory allocation fails, leaving HTAB as it was.  */
+
+int
+htab_cache_hashes (htab_t htab)
+{
+  size_t size;
+
+  if (htab->hashes)
+    return 1;
+
+  /* A table that was never used can keep its entries, and use as many
+     of them as make a power of two.  */
+  size = htab_size (htab);
+  if (htab->n_elements == 0 && size >= (1 << HTAB_MIN_LOG2))
+    {
+      unsigned int log2 = HTAB_MIN_LOG2;
+      hashval_t *hashes;
+
+      while (((size_t) 2 << log2) <= size)
+	log2++;
+      hashes = (hashval_t *) htab_alloc_array (htab, (size_t) 1 << log2,
+					       sizeof (hashval_t));
+      if (hashes == NULL)
+	return 0;
+      htab->hashes = hashes;
+      htab->size = (size_t) 1 << log2;
+      htab->size_log2 = log2;
+      return 1;
+    }
+
+  /* Otherwise keep room for as many entries as were asked for when HTAB
+     was created, or twice as many as it has now.  */
+  if (size < htab_elements (htab) * 2)
+    size = htab_elements (htab) * 2;
+  return htab_resize_cached (htab, htab_ceil_log2 (size), 1);
+}
+
+/* Like htab_find_with_hash, for a table that caches hashes.  */
+
+static PTR
+htab_find_cached (htab_t htab, const PTR element, hashval_t hash)
+{
+  PTR *entries = htab->entries;
+  hashval_t *hashes = htab->hashes;
+  hashval_t mask = htab_size (htab) - 1;
+  hashval_t index = htab_index_cached (hash, htab);
+  PTR entry;
+
+  htab->searches++;
+  for (;;)
+    {
+      entry = entries[index];
+      if (entry == HTAB_EMPTY_ENTRY)
+	return entry;
+      if (hashes[index] == hash
+	  && entry != HTAB_DELETED_ENTRY
+	  && (*htab->eq_f) (entry, element))
+	return entry;
+      htab->collisions++;
+      index = (index + 1) & mask;
+    }
+}
+
+/* Like htab_find_slot_with_hash, for a table that caches hashes.  */
+
+static PTR *
+htab_find_slot_cached (htab_t htab, const PTR element, hashval_t hash,
+		       enum insert_option insert)
+{
+  PTR *first_deleted_slot = NULL;
+  PTR *entries;
+  hashval_t *hashes;
+  hashval_t mask, index;
+  PTR entry;
+
+  if (insert == INSERT && htab_size (htab) * 3 <= htab->n_elements * 4)
+    {
+      if (htab_expand_cached (htab) == 0)
+	return NULL;
+    }
+
+  entries = htab->entries;
+  hashes = htab->hashes;
+  mask = htab_size (htab) - 1;
+  index = htab_index_cached (hash, htab);
+
+  htab->searches++;
+  for (;;)
+    {
+      entry = entries[index];
+      if (entry == HTAB_EMPTY_ENTRY)
+	break;
+      if (entry == HTAB_DELETED_ENTRY)
+	{
+	  if (!first_deleted_slot)
+	    first_deleted_slot = &entries[index];
+	}
+      else if (hashes[index] == hash && (*htab->eq_f) (entry, element))
+	return &entries[index];
+      htab->collisions++;
+      index = (index + 1) & mask;
+    }
+
+  if (insert == NO_INSERT)
+    return NULL;
+
+  if (first_deleted_slot)
+    {
+      htab->n_deleted--;
+      *first_deleted_slot = HTAB_EMPTY_ENTRY;
+      hashes[first_deleted_slot - entries] = hash;
+      return first_deleted_slot;
+    }
+
+  htab->n_elements++;
+  hashes[index] = hash;
+  return &entries[index];
+}
+
+/* Insert the N ELEMENTS into HTAB, except those equal to an element
+   already there, as htab_find_slot would.  The table is grown once
+   for all of them first.  For a table that caches hashes, the hashes
+   of a batch of elements are computed, and their slots fetched, before
+   any of them is inserted.  Return zero if memory allocation fails.  */
+
+#define HTAB_BULK_BATCH 16
+
+int
+htab_insert_bulk (htab_t htab, PTR *elements, size_t n)
+{
+  hashval_t hashes[HTAB_BULK_BATCH];
+  size_t i, j, m;
+
+  if (!htab->hashes)
+    {
+      for (i = 0; i < n; i++)
+	{
+	  PTR *slot = htab_find_slot (htab, elements[i], INSERT);
+
+	  if (slot == NULL)
+	    return 0;
+	  if (*slot == HTAB_EMPTY_ENTRY)
+	    *slot = elements[i];
+	}
+      return 1;
+    }
+
+  /* Grow the table so that it stays under the load at which
+     htab_find_slot_cached would expand it.  */
+  if ((htab->n_elements + n) * 4 >= htab_size (htab) * 3
+      && !htab_resize_cached (htab,
+			      htab_ceil_log2 ((htab_elements (htab) + n) * 2),
+			      0))
+    return 0;
+
+  for (i = 0; i < n; i += m)
+    {
+      m = n - i < HTAB_BULK_BATCH ? n - i : HTAB_BULK_BATCH;
+      for (j = 0; j < m; j++)
+	{
+	  hashes[j] = (*htab->hash_f) (elements[i + j]);
+#if GCC_VERSION >= 3001
+	  {
+	    hashval_t index = htab_index_cached (hashes[j], htab);
+
+	    __builtin_prefetch (&htab->entries[index]);
+	    __builtin_prefetch (&htab->hashes[index]);
+	  }
+#endif
+	}
+      for (j = 0; j < m; j++)
+	{
+	  PTR *slot = htab_find_slot_cached (htab, elements[i + j], hashes[j],
+					     INSERT);
+
+	  if (slot == NULL)
+	    return 0;
+	  if (*slot == HTAB_EMPTY_ENTRY)
+	    *slot = elements[i + j];
+	}
+    }
+  return 1;
+}
+/* APPLE LOCAL end htab cached hashes */
+
 /* This function searches for a hash table entry equal to the given
    element.  It cannot be used to insert or delete an element.  */
 
@@ -563,6 +972,11 @@ htab_find_with_hash (htab_t htab, const PTR element, hashval_t hash)
   size_t size;
   PTR entry;
 
+  /* APPLE LOCAL begin htab cached hashes */
+  if (htab->hashes)
+    return htab_find_cached (htab, element, hash);
+  /* APPLE LOCAL end htab cached hashes */
+
   htab->searches++;
   size = htab_size (htab);
   index = htab_mod (hash, htab);
@@ -613,6 +1027,11 @@ htab_find_slot_with_hash (htab_t htab, const PTR element,
   size_t size;
   PTR entry;
 
+  /* APPLE LOCAL begin htab cached hashes */
+  if (htab->hashes)
+    return htab_find_slot_cached (htab, element, hash, insert);
+  /* APPLE LOCAL end htab cached hashes */
+
   size = htab_size (htab);
   if (insert == INSERT && size * 3 <= htab->n_elements * 4)
     {
@@ -0,0 +1,465 @@
+/* APPLE LOCAL file htab cached hashes */
+/* Hash table test and benchmark program.
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This file is part of the libiberty library, which is part of GCC.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   In addition to the permissions in the GNU General Public License, the
+   Free Software Foundation gives you unlimited permission to link the
+   compiled version of this file into combinations with other programs,
+   and to distribute those combinations without any restriction coming
+   from the use of this file.  (The General Public License restrictions
+   do apply in other respects; for example, they cover modification of
+   the file, and distribution when not linked into a combined
+   executable.)
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/* Without arguments, this checks that tables with and without cached
+   hashes behave the same as a plain array under a random sequence of
+   insertions, lookups and removals, and after htab_rehash.  With -b,
+   it also times both kinds of table on workloads like those of the
+   compiler:
+
+     strings    an identifier table, looked up mostly with names
+		already in it;
+     pointers   a map keyed by the address of a node, with lookups
+		that hit and miss, and removals;
+     small      many small tables, such as a pass builds for each
+		function;
+     bulk       one large table filled at once.  */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include "libiberty.h"
+#include "hashtab.h"
+#include <stdio.h>
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+
+#ifndef EXIT_SUCCESS
+#define EXIT_SUCCESS 0
+#endif
+
+#ifndef EXIT_FAILURE
+#define EXIT_FAILURE 1
+#endif
+
+/* A table element.  */
+
+struct elt
+{
+  const char *name;
+  int key;
+};
+
+static struct elt *elts;
+static int n_elts;
+static int failures;
+
+/* A small, fixed random number generator, so that every run sees the
+   same workload.  */
+
+static unsigned long rand_state = 1;
+
+static unsigned long
+next_rand (void)
+{
+  rand_state = rand_state * 1103515245 + 12345;
+  return (rand_state >> 16) & 0x7fff;
+}
+
+static unsigned long
+big_rand (void)
+{
+  return (next_rand () << 15) ^ next_rand ();
+}
+
+static hashval_t
+hash_key (const void *p)
+{
+  return ((const struct elt *) p)->key;
+}
+
+/* A poor hash, to make sure that chains of collisions work.  */
+
+static hashval_t
+hash_key_poor (const void *p)
+{
+  return ((const struct elt *) p)->key & ~0xff;
+}
+
+static int
+eq_key (const void *p1, const void *p2)
+{
+  return ((const struct elt *) p1)->key == ((const struct elt *) p2)->key;
+}
+
+static hashval_t
+hash_name (const void *p)
+{
+  return htab_hash_string (((const struct elt *) p)->name);
+}
+
+static int
+eq_name (const void *p1, const void *p2)
+{
+  return !strcmp (((const struct elt *) p1)->name,
+		  ((const struct elt *) p2)->name);
+}
+
+static void
+fail (const char *what, int i)
+{
+  fprintf (stderr, "FAIL: %s at step %d\n", what, i);
+  failures++;
+}
+
+/* Make N elements, with keys 0 to N-1 and names made from them.  */
+
+static void
+make_elts (int n)
+{
+  int i;
+
+  elts = XNEWVEC (struct elt, n);
+  for (i = 0; i < n; i++)
+    {
+      char buf[32];
+
+      sprintf (buf, "%s_%x_%d", i % 3 ? "tree" : "rtx", i * 7919, i % 97);
+      elts[i].name = xstrdup (buf);
+      elts[i].key = i;
+    }
+  n_elts = n;
+}
+
+static int
+count_elt (void **slot ATTRIBUTE_UNUSED, void *data)
+{
+  (*(int *) data)++;
+  return 1;
+}
+
+/* Check HTAB against the presence flags in IN, N of which are set.  */
+
+static void
+check_table (htab_t htab, const char *in, int n, int step)
+{
+  int i, count = 0;
+
+  if ((int) htab_elements (htab) != n)
+    fail ("htab_elements", step);
+  htab_traverse_noresize (htab, count_elt, &count);
+  if (count != n)
+    fail ("htab_traverse_noresize", step);
+  for (i = 0; i < n_elts; i++)
+    if ((htab_find (htab, &elts[i]) != NULL) != in[i])
+      fail ("htab_find", step);
+}
+
+/* Run a random sequence of operations on a table hashed by HASH_F,
+   caching hashes if CACHED.  */
+
+static void
+run_test (htab_hash hash_f, int cached)
+{
+  char *in = XCNEWVEC (char, n_elts);
+  htab_t htab = htab_create (7, hash_f, eq_key, NULL);
+  int i, n = 0;
+
+  if (cached && !htab_cache_hashes (htab))
+    fail ("htab_cache_hashes", 0);
+
+  rand_state = 1;
+  for (i = 0; i < 40000; i++)
+    {
+      int k = big_rand () % n_elts;
+      struct elt *e = &elts[k];
+      void **slot;
+
+      switch (next_rand () % 8)
+	{
+	case 0: case 1: case 2:
+	  slot = htab_find_slot (htab, e, INSERT);
+	  if ((*slot != NULL) != in[k])
+	    fail ("htab_find_slot INSERT", i);
+	  if (!*slot)
+	    n++;
+	  *slot = e;
+	  in[k] = 1;
+	  break;
+
+	case 3:
+	  if ((htab_find (htab, e) != NULL) != in[k])
+	    fail ("htab_find", i);
+	  break;
+
+	case 4:
+	  /* htab_remove_elt wants the element to be there.  */
+	  if (in[k])
+	    {
+	      htab_remove_elt (htab, e);
+	      n--;
+	      in[k] = 0;
+	    }
+	  break;
+
+	case 5:
+	  slot = htab_find_slot (htab, e, NO_INSERT);
+	  if ((slot != NULL) != in[k])
+	    fail ("htab_find_slot NO_INSERT", i);
+	  else if (slot)
+	    {
+	      htab_clear_slot (htab, slot);
+	      n--;
+	      in[k] = 0;
+	    }
+	  break;
+
+	case 6:
+	  {
+	    void *batch[10];
+	    int j;
+
+	    for (j = 0; j < 10; j++)
+	      {
+		k = big_rand () % n_elts;
+		batch[j] = &elts[k];
+		n += !in[k];
+		in[k] = 1;
+	      }
+	    if (!htab_insert_bulk (htab, batch, 10))
+	      fail ("htab_insert_bulk", i);
+	  }
+	  break;
+
+	case 7:
+	  if (next_rand () % 1000 == 0)
+	    {
+	      htab_empty (htab);
+	      memset (in, 0, n_elts);
+	      n = 0;
+	    }
+	  break;
+	}
+
+      if (i % 5000 == 0)
+	check_table (htab, in, n, i);
+    }
+  check_table (htab, in, n, i);
+
+  htab_delete (htab);
+  free (in);
+}
+
+/* Fill a table with every other element, remove some, change all the
+   keys, as moving a table keyed by addresses would, and check that the
+   table is right after htab_rehash.  Cache hashes if CACHED.  */
+
+static void
+run_rehash_test (int cached)
+{
+  char *in = XCNEWVEC (char, n_elts);
+  htab_t htab = htab_create (7, hash_key, eq_key, NULL);
+  int i, n = 0;
+
+  if (cached && !htab_cache_hashes (htab))
+    fail ("htab_cache_hashes", 0);
+
+  for (i = 0; i < n_elts; i += 2)
+    {
+      *htab_find_slot (htab, &elts[i], INSERT) = &elts[i];
+      in[i] = 1;
+      n++;
+    }
+  for (i = 0; i < n_elts; i += 6)
+    {
+      htab_remove_elt (htab, &elts[i]);
+      in[i] = 0;
+      n--;
+    }
+
+  for (i = 0; i < n_elts; i++)
+    elts[i].key += 0x10000000;
+  if (!htab_rehash (htab))
+    fail ("htab_rehash", 0);
+  check_table (htab, in, n, 0);
+  for (i = 0; i < n_elts; i++)
+    elts[i].key -= 0x10000000;
+
+  htab_delete (htab);
+  free (in);
+}
+
+/* The benchmarks.  Each makes and deletes its own tables, caching
+   hashes in them if CACHED.  */
+
+static htab_t
+bench_create (size_t size, htab_hash hash_f, htab_eq eq_f, int cached)
+{
+  htab_t htab = htab_create (size, hash_f, eq_f, NULL);
+
+  if (cached)
+    htab_cache_hashes (htab);
+  return htab;
+}
+
+static int
+bench_strings (int cached)
+{
+  htab_t htab = bench_create (31, hash_name, eq_name, cached);
+  int i, hits = 0;
+
+  rand_state = 7;
+  for (i = 0; i < 3000000; i++)
+    {
+      /* Most names are common; a few are seen once or twice.  */
+      int k = next_rand () % 16 ? big_rand () % 4096 : big_rand () % n_elts;
+      void **slot = htab_find_slot (htab, &elts[k], INSERT);
+
+      if (*slot)
+	hits++;
+      else
+	*slot = &elts[k];
+    }
+  htab_delete (htab);
+  return hits;
+}
+
+static int
+bench_pointers (int cached)
+{
+  htab_t htab = bench_create (31, htab_hash_pointer, htab_eq_pointer, cached);
+  int i, round, hits = 0;
+
+  rand_state = 11;
+  for (round = 0; round < 4; round++)
+    {
+      for (i = 0; i < n_elts / 2; i++)
+	{
+	  struct elt *e = &elts[big_rand () % n_elts];
+
+	  *htab_find_slot (htab, e, INSERT) = e;
+	}
+      for (i = 0; i < 1000000; i++)
+	hits += htab_find (htab, &elts[big_rand () % n_elts]) != NULL;
+      for (i = 0; i < n_elts / 4; i++)
+	{
+	  struct elt *e = &elts[big_rand () % n_elts];
+
+	  if (htab_find (htab, e))
+	    htab_remove_elt (htab, e);
+	}
+    }
+  htab_delete (htab);
+  return hits;
+}
+
+static int
+bench_small (int cached)
+{
+  int i, t, hits = 0;
+
+  rand_state = 13;
+  for (t = 0; t < 20000; t++)
+    {
+      htab_t htab = bench_create (10, hash_key, eq_key, cached);
+      int base = big_rand () % (n_elts - 64);
+
+      for (i = 0; i < 40; i++)
+	{
+	  struct elt *e = &elts[base + next_rand () % 64];
+
+	  *htab_find_slot (htab, e, INSERT) = e;
+	}
+      for (i = 0; i < 200; i++)
+	hits += htab_find (htab, &elts[base + next_rand () % 64]) != NULL;
+      htab_delete (htab);
+    }
+  return hits;
+}
+
+static int
+bench_bulk (int cached)
+{
+  void **batch = XNEWVEC (void *, n_elts);
+  int i, round, count = 0;
+
+  for (i = 0; i < n_elts; i++)
+    batch[i] = &elts[i];
+  for (round = 0; round < 5; round++)
+    {
+      htab_t htab = bench_create (31, hash_name, eq_name, cached);
+
+      htab_insert_bulk (htab, batch, n_elts);
+      count += htab_elements (htab);
+      htab_delete (htab);
+    }
+  free (batch);
+  return count;
+}
+
+static void
+bench (const char *name, int (*fn) (int))
+{
+  long start, classic, cached;
+  int r1, r2;
+
+  start = get_run_time ();
+  r1 = fn (0);
+  classic = get_run_time () - start;
+  start = get_run_time ();
+  r2 = fn (1);
+  cached = get_run_time () - start;
+
+  if (r1 != r2)
+    fail (name, 0);
+  printf ("%-10s  classic %7.3f s  cached %7.3f s  (%.2fx)\n", name,
+	  classic / 1e6, cached / 1e6,
+	  cached ? (double) classic / cached : 0.0);
+}
+
+int
+main (int argc, char **argv)
+{
+  make_elts (200000);
+
+  run_test (hash_key, 0);
+  run_test (hash_key, 1);
+  run_test (hash_key_poor, 0);
+  run_test (hash_key_poor, 1);
+  run_rehash_test (0);
+  run_rehash_test (1);
+
+  if (argc > 1 && !strcmp (argv[1], "-b"))
+    {
+      bench ("strings", bench_strings);
+      bench ("pointers", bench_pointers);
+      bench ("small", bench_small);
+      bench ("bulk", bench_bulk);
+    }
+
+  if (failures)
+    return EXIT_FAILURE;
+  printf ("PASS: test-hashtab\n");
+  return EXIT_SUCCESS;
+}